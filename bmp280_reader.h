@@ -0,0 +1,283 @@
+#pragma once
+/*
+  bmp280_reader.h  —  BMP280 in normal mode, one burst per sample, altitude without pow()
+  --------------------------------------------------------------------------------------
+  - Register-level driver over a TwoWire-like bus: the sensor converts
+    continuously (normal mode) with the oversampling / IIR filter /
+    standby time of a profile, and the reader fetches the six data bytes
+    (0xF7..0xFC, pressure and temperature of the same sample) in one
+    burst instead of one transaction each
+  - periodMs(): worst-case time from one sample to the next (datasheet
+    max conversion time + standby); reading at that period gets a new
+    sample every time, so no burst is spent on data already read. A
+    burst identical to the previous one is counted (stats.unchanged: the
+    same sample, or a steady pressure and temperature)
+  - Bosch's integer compensation (datasheet 3.11.3, 64-bit pressure),
+    the same numbers as the Adafruit library
+  - BaroAltitude: 44330 * (1 - (p / p0)^0.1903) as the library computes
+    it, with (p / p0)^0.1903 a polynomial fitted once (construction, by
+    Chebyshev interpolation) over RATIO_MIN..RATIO_MAX (about -800 m ..
+    6.2 km) and evaluated in float (Horner); powf() outside.
+    tools/baro_bench checks it against pow()
+  - No Arduino dependency: the sketch passes M5Unified's internal bus
+    (M5.In_I2C behind a TwoWire front), tools/baro_bench a simulated
+    sensor
+
+  Usage:
+    Bmp280Reader<TwoWire> barometer;
+    if (!barometer.begin(Wire, 0x76, Bmp280Profile::Precise)) ...no sensor...
+    every barometer.periodMs():
+      if (barometer.read()) alt = barometer.altitudeM(slp_hPa);
+*/
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ---- Registers ----
+static constexpr uint8_t BMP280_REG_CALIB = 0x88;  // 24 bytes, dig_T1 .. dig_P9
+static constexpr uint8_t BMP280_REG_ID = 0xD0;
+static constexpr uint8_t BMP280_REG_CTRL_MEAS = 0xF4;
+static constexpr uint8_t BMP280_REG_CONFIG = 0xF5;
+static constexpr uint8_t BMP280_REG_DATA = 0xF7;  // 6 bytes, press_msb .. temp_xlsb
+static constexpr uint8_t BMP280_CHIP_ID = 0x58;
+static constexpr int32_t BMP280_ADC_SKIPPED = 0x80000;  // data registers before the first conversion
+
+// ---- Profiles (datasheet 3.8, "use case" settings) ----
+enum class Bmp280Profile : uint8_t {
+  Precise,  // x16 pressure, x2 temperature, IIR 16, 0.5 ms standby: ~23 Hz ("indoor navigation")
+  Dynamic,  // x4 / x1, IIR 16, 0.5 ms standby: ~72 Hz, noisier ("handheld device dynamic")
+  LowPower  // x16 / x2, IIR 4, 62.5 ms standby: ~9 Hz ("handheld device low-power")
+};
+
+struct Bmp280Setup {
+  uint8_t osrs_t, osrs_p;  // oversampling: 1..5 = x1 .. x16
+  uint8_t filter;          // IIR coefficient: 0 off, 1..4 = 2 .. 16
+  uint8_t t_sb;            // standby: 0 = 0.5 ms, 1 = 62.5 ms, ... 7 = 4 s
+};
+
+inline Bmp280Setup bmp280Setup(Bmp280Profile p) {
+  switch (p) {
+    case Bmp280Profile::Dynamic: return { 1, 3, 4, 0 };
+    case Bmp280Profile::LowPower: return { 2, 5, 2, 1 };
+    default: return { 2, 5, 4, 0 };
+  }
+}
+
+inline const char *bmp280ProfileName(Bmp280Profile p) {
+  switch (p) {
+    case Bmp280Profile::Dynamic: return "dynamic";
+    case Bmp280Profile::LowPower: return "low power";
+    default: return "precise";
+  }
+}
+
+// Worst-case sample period: max conversion time (datasheet 3.8.1:
+// 1.25 + 2.3 * T + 2.3 * P + 0.575 ms) plus standby, rounded up
+inline uint32_t bmp280PeriodMs(Bmp280Profile p) {
+  static const uint32_t standby_us[8] = { 500, 62500, 125000, 250000, 500000, 1000000, 2000000, 4000000 };
+  const Bmp280Setup s = bmp280Setup(p);
+  const uint32_t t = 1u << (s.osrs_t - 1), pr = 1u << (s.osrs_p - 1);
+  const uint32_t us = 1250 + 2300 * t + 2300 * pr + 575 + standby_us[s.t_sb & 7];
+  return (us + 999) / 1000;
+}
+
+// ---- Compensation (datasheet 3.11.3) ----
+struct Bmp280Calib {
+  uint16_t T1;
+  int16_t T2, T3;
+  uint16_t P1;
+  int16_t P2, P3, P4, P5, P6, P7, P8, P9;
+};
+
+// From the 24 calibration bytes (little-endian); false if blank
+inline bool bmp280ParseCalib(const uint8_t *b, Bmp280Calib &c) {
+  uint16_t w[12];
+  for (int i = 0; i < 12; ++i) w[i] = (uint16_t)(b[2 * i] | (b[2 * i + 1] << 8));
+  c.T1 = w[0];
+  c.T2 = (int16_t)w[1];
+  c.T3 = (int16_t)w[2];
+  c.P1 = w[3];
+  c.P2 = (int16_t)w[4];
+  c.P3 = (int16_t)w[5];
+  c.P4 = (int16_t)w[6];
+  c.P5 = (int16_t)w[7];
+  c.P6 = (int16_t)w[8];
+  c.P7 = (int16_t)w[9];
+  c.P8 = (int16_t)w[10];
+  c.P9 = (int16_t)w[11];
+  return c.T1 != 0 && c.P1 != 0;
+}
+
+// t_fine (temperature in 1/5120 °C) from the raw temperature
+inline int32_t bmp280TFine(const Bmp280Calib &c, int32_t adcT) {
+  const int32_t v1 = ((((adcT >> 3) - ((int32_t)c.T1 << 1))) * (int32_t)c.T2) >> 11;
+  const int32_t d = (adcT >> 4) - (int32_t)c.T1;
+  const int32_t v2 = (((d * d) >> 12) * (int32_t)c.T3) >> 14;
+  return v1 + v2;
+}
+
+// Pressure in Pa * 256 (Q24.8) from the raw pressure and t_fine; 0 if invalid
+inline uint32_t bmp280PressureQ8(const Bmp280Calib &c, int32_t adcP, int32_t tFine) {
+  int64_t v1 = (int64_t)tFine - 128000;
+  int64_t v2 = v1 * v1 * (int64_t)c.P6;
+  v2 += (v1 * (int64_t)c.P5) * ((int64_t)1 << 17);
+  v2 += (int64_t)c.P4 * ((int64_t)1 << 35);
+  v1 = ((v1 * v1 * (int64_t)c.P3) >> 8) + ((v1 * (int64_t)c.P2) * ((int64_t)1 << 12));
+  v1 = ((((int64_t)1 << 47) + v1) * (int64_t)c.P1) >> 33;
+  if (v1 == 0) return 0;
+  int64_t p = 1048576 - adcP;
+  p = ((p * ((int64_t)1 << 31) - v2) * 3125) / v1;
+  v1 = ((int64_t)c.P9 * (p >> 13) * (p >> 13)) >> 25;
+  v2 = ((int64_t)c.P8 * p) >> 19;
+  p = ((p + v1 + v2) >> 8) + ((int64_t)c.P7 << 4);
+  return (uint32_t)p;
+}
+
+// ---- Pressure → altitude ----
+class BaroAltitude {
+public:
+  static constexpr float RATIO_MIN = 0.45f;  // p / p0 covered by the series
+  static constexpr float RATIO_MAX = 1.10f;
+  static const int TERMS = 10;               // max error < 1 cm (tools/baro_bench)
+
+  // Chebyshev interpolation of r^0.1903 at TERMS nodes, turned into
+  // powers of x (r mapped to -1..1); double, once
+  BaroAltitude() {
+    const double pi = 3.14159265358979323846;
+    double f[TERMS];
+    for (int k = 0; k < TERMS; ++k) {
+      const double x = cos(pi * (k + 0.5) / TERMS);
+      f[k] = pow(0.5 * (RATIO_MAX - RATIO_MIN) * x + 0.5 * (RATIO_MAX + RATIO_MIN), 0.1903);
+    }
+    double a[TERMS] = {}, t0[TERMS] = {}, t1[TERMS] = {}, t2[TERMS];
+    t0[0] = 1.0;  // T0
+    t1[1] = 1.0;  // T1
+    for (int j = 0; j < TERMS; ++j) {
+      double c = 0.0;
+      for (int k = 0; k < TERMS; ++k) c += f[k] * cos(pi * j * (k + 0.5) / TERMS);
+      c *= (j ? 2.0 : 1.0) / TERMS;
+      const double *t = j == 0 ? t0 : t1;
+      for (int i = 0; i < TERMS; ++i) a[i] += c * t[i];
+      if (j >= 1) {  // T(j+1) = 2x T(j) - T(j-1)
+        for (int i = 0; i < TERMS; ++i) t2[i] = (i ? 2.0 * t1[i - 1] : 0.0) - t0[i];
+        memcpy(t0, t1, sizeof(t0));
+        memcpy(t1, t2, sizeof(t1));
+      }
+    }
+    for (int i = 0; i < TERMS; ++i) c_[i] = (float)a[i];
+  }
+
+  // Metres above the sea-level pressure slp_hPa (the library's formula)
+  float metres(float p_pa, float slp_hPa) const {
+    const float r = p_pa / (slp_hPa * 100.0f);
+    if (!(r >= RATIO_MIN && r <= RATIO_MAX)) return 44330.0f * (1.0f - powf(r, 0.1903f));
+    const float x = (2.0f * r - (RATIO_MAX + RATIO_MIN)) * (1.0f / (RATIO_MAX - RATIO_MIN));
+    float y = c_[TERMS - 1];
+    for (int i = TERMS - 2; i >= 0; --i) y = y * x + c_[i];
+    return 44330.0f * (1.0f - y);
+  }
+
+private:
+  float c_[TERMS];  // of x^0 .. x^(TERMS - 1)
+};
+
+// ---- Driver ----
+template <class Wire>
+class Bmp280Reader {
+public:
+  struct Stats {
+    uint32_t reads;      // bursts that gave a sample
+    uint32_t unchanged;  // of those, identical to the previous burst
+    uint32_t errors;     // bus errors
+  };
+
+  Bmp280Reader() { stats = Stats(); }
+
+  // Checks the chip ID, reads the calibration and starts normal mode with
+  // profile p; false if there is no BMP280 at addr
+  bool begin(Wire &wire, uint8_t addr, Bmp280Profile p) {
+    wire_ = &wire;
+    addr_ = addr;
+    uint8_t id = 0, cal[24];
+    if (!readRegs(BMP280_REG_ID, &id, 1) || id != BMP280_CHIP_ID) return false;
+    if (!readRegs(BMP280_REG_CALIB, cal, sizeof(cal)) || !bmp280ParseCalib(cal, calib_)) return false;
+    return setProfile(p);
+  }
+
+  // Config is only written reliably in sleep mode (datasheet 5.4.6):
+  // sleep, config, then ctrl_meas with normal mode
+  bool setProfile(Bmp280Profile p) {
+    const Bmp280Setup s = bmp280Setup(p);
+    profile_ = p;
+    return writeReg(BMP280_REG_CTRL_MEAS, 0x00) &&
+           writeReg(BMP280_REG_CONFIG, (uint8_t)((s.t_sb << 5) | (s.filter << 2))) &&
+           writeReg(BMP280_REG_CTRL_MEAS, (uint8_t)((s.osrs_t << 5) | (s.osrs_p << 2) | 0x03));
+  }
+
+  Bmp280Profile profile() const { return profile_; }
+  uint32_t periodMs() const { return bmp280PeriodMs(profile_); }
+
+  // The latest sample: one burst and the compensation. False on a bus
+  // error or before the first conversion
+  bool read() {
+    uint8_t d[6];
+    if (!readRegs(BMP280_REG_DATA, d, sizeof(d))) {
+      ++stats.errors;
+      return false;
+    }
+    const int32_t adcP = ((int32_t)d[0] << 12) | ((int32_t)d[1] << 4) | (d[2] >> 4);
+    const int32_t adcT = ((int32_t)d[3] << 12) | ((int32_t)d[4] << 4) | (d[5] >> 4);
+    if (adcP == BMP280_ADC_SKIPPED || adcT == BMP280_ADC_SKIPPED) return false;
+    const int32_t tFine = bmp280TFine(calib_, adcT);
+    const uint32_t q8 = bmp280PressureQ8(calib_, adcP, tFine);
+    if (!q8) {
+      ++stats.errors;
+      return false;
+    }
+    if (adcP == adcP_ && adcT == adcT_) ++stats.unchanged;
+    ++stats.reads;
+    adcP_ = adcP;
+    adcT_ = adcT;
+    pressure_pa_ = q8 / 256.0f;
+    temperature_c_ = ((tFine * 5 + 128) >> 8) / 100.0f;
+    return true;
+  }
+
+  float pressurePa() const { return pressure_pa_; }
+  float temperatureC() const { return temperature_c_; }
+  float altitudeM(float slp_hPa) const { return altitude_.metres(pressure_pa_, slp_hPa); }
+
+  // Raw values of the last sample and the calibration (for logging)
+  int32_t rawPressure() const { return adcP_; }
+  int32_t rawTemperature() const { return adcT_; }
+  const Bmp280Calib &calib() const { return calib_; }
+
+  Stats stats;
+
+private:
+  bool readRegs(uint8_t reg, uint8_t *buf, size_t n) {
+    wire_->beginTransmission(addr_);
+    wire_->write(reg);
+    if (wire_->endTransmission(false) != 0) return false;  // repeated start
+    if (wire_->requestFrom(addr_, (uint8_t)n) != n) return false;
+    for (size_t i = 0; i < n; ++i) buf[i] = (uint8_t)wire_->read();
+    return true;
+  }
+
+  bool writeReg(uint8_t reg, uint8_t v) {
+    wire_->beginTransmission(addr_);
+    wire_->write(reg);
+    wire_->write(v);
+    return wire_->endTransmission() == 0;
+  }
+
+  Wire *wire_ = nullptr;
+  uint8_t addr_ = 0;
+  Bmp280Profile profile_ = Bmp280Profile::Precise;
+  Bmp280Calib calib_ = {};
+  BaroAltitude altitude_;
+  int32_t adcP_ = 0, adcT_ = 0;
+  float pressure_pa_ = NAN, temperature_c_ = NAN;
+};
@@ -0,0 +1,129 @@
+#pragma once
+/*
+  double_float.h  —  Compensated float-float ("double-float") arithmetic
+  ----------------------------------------------------------------------
+  - A value is the unevaluated sum hi + lo of two floats (|lo| ≤ ulp(hi)/2)
+  - ~48-bit significand using only single-precision FPU instructions
+  - Error-free transforms: TwoSum (Knuth), TwoProd (FMA, or Dekker split)
+
+  Why: the ESP32-S3 FPU only handles float; double runs in software. The
+  SR (~1e-12) and GR (~1e-13) terms need more than float's 24 bits, but
+  not the full 53 of double.
+
+  Notes:
+   - Do NOT build with -ffast-math / -fassociative-math: the compensation
+     terms are algebraically zero and would be optimized away.
+   - DF_USE_FMA (default 1) uses fmaf() for TwoProd (MADD.S on ESP32-S3);
+     set it to 0 on targets without a fused multiply-add.
+   - Relative error of + - * is ~2^-47; / and sqrt ~2^-46.
+*/
+
+#include <math.h>
+
+#ifndef DF_USE_FMA
+#define DF_USE_FMA 1
+#endif
+
+struct DoubleFloat {
+  float hi, lo;
+
+  DoubleFloat() : hi(0.0f), lo(0.0f) {}
+  constexpr DoubleFloat(float h, float l = 0.0f) : hi(h), lo(l) {}
+
+  inline double toDouble() const { return (double)hi + (double)lo; }
+  inline float toFloat() const { return hi + lo; }
+};
+
+// Exact split of a double (compile-time constants, or once per fix)
+static constexpr DoubleFloat dfFromDouble(double d) {
+  return DoubleFloat((float)d, (float)(d - (double)(float)d));
+}
+
+// ---- Error-free transforms ----
+// s + e == a + b exactly
+static inline DoubleFloat dfTwoSum(float a, float b) {
+  const float s = a + b;
+  const float bb = s - a;
+  const float e = (a - (s - bb)) + (b - bb);
+  return DoubleFloat(s, e);
+}
+
+// Same, requires |a| >= |b|
+static inline DoubleFloat dfQuickTwoSum(float a, float b) {
+  const float s = a + b;
+  const float e = b - (s - a);
+  return DoubleFloat(s, e);
+}
+
+// p + e == a * b exactly
+static inline DoubleFloat dfTwoProd(float a, float b) {
+  const float p = a * b;
+#if DF_USE_FMA
+  const float e = fmaf(a, b, -p);
+#else
+  // Dekker split (2^12 + 1)
+  const float ca = 4097.0f * a, cb = 4097.0f * b;
+  const float ah = ca - (ca - a), al = a - ah;
+  const float bh = cb - (cb - b), bl = b - bh;
+  const float e = ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+#endif
+  return DoubleFloat(p, e);
+}
+
+// ---- Arithmetic ----
+static inline DoubleFloat operator+(DoubleFloat a, DoubleFloat b) {
+  const DoubleFloat s = dfTwoSum(a.hi, b.hi);
+  const DoubleFloat t = dfTwoSum(a.lo, b.lo);
+  const DoubleFloat u = dfQuickTwoSum(s.hi, s.lo + t.hi);
+  return dfQuickTwoSum(u.hi, u.lo + t.lo);
+}
+
+static inline DoubleFloat operator+(DoubleFloat a, float b) {
+  const DoubleFloat s = dfTwoSum(a.hi, b);
+  return dfQuickTwoSum(s.hi, s.lo + a.lo);
+}
+
+static inline DoubleFloat operator-(DoubleFloat a) {
+  return DoubleFloat(-a.hi, -a.lo);
+}
+
+static inline DoubleFloat operator-(DoubleFloat a, DoubleFloat b) {
+  return a + (-b);
+}
+
+static inline DoubleFloat operator-(DoubleFloat a, float b) {
+  return a + (-b);
+}
+
+static inline DoubleFloat operator*(DoubleFloat a, DoubleFloat b) {
+  const DoubleFloat p = dfTwoProd(a.hi, b.hi);
+  return dfQuickTwoSum(p.hi, p.lo + (a.hi * b.lo + a.lo * b.hi));
+}
+
+static inline DoubleFloat operator*(DoubleFloat a, float b) {
+  const DoubleFloat p = dfTwoProd(a.hi, b);
+  return dfQuickTwoSum(p.hi, p.lo + a.lo * b);
+}
+
+static inline DoubleFloat operator/(DoubleFloat a, DoubleFloat b) {
+  // Long division: q1 from hi parts, one correction from the remainder
+  const float q1 = a.hi / b.hi;
+  const DoubleFloat r = a - b * q1;
+  const float q2 = r.hi / b.hi;
+  const DoubleFloat r2 = r - b * q2;
+  const float q3 = r2.hi / b.hi;
+  return dfQuickTwoSum(q1, q2) + q3;
+}
+
+static inline DoubleFloat dfSqrt(DoubleFloat a) {
+  if (a.hi <= 0.0f) return DoubleFloat(sqrtf(a.hi));
+  // One Newton step from the float root: x + (a - x²) / 2x
+  const float x = sqrtf(a.hi);
+  const DoubleFloat d = a - dfTwoProd(x, x);
+  return dfQuickTwoSum(x, d.hi / (2.0f * x));
+}
+
+static inline DoubleFloat dfSqr(DoubleFloat a) {
+  const DoubleFloat p = dfTwoProd(a.hi, a.hi);
+  return dfQuickTwoSum(p.hi, p.lo + 2.0f * a.hi * a.lo);
+}
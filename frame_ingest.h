@@ -0,0 +1,67 @@
+#pragma once
+/*
+  frame_ingest.h  —  Framed byte stream from a UART task to the consumer
+  ---------------------------------------------------------------------
+  - FrameIngest<Framer, N>: the producer (UART task) runs the framer on
+    raw bytes and queues only complete, valid frames in an SPSC ring, so
+    a full ring drops whole frames (and counts them) instead of cutting
+    one in half for the parser
+  - Framer interface (NmeaFramer, UbxDecoder):
+      FrameStatus push(uint8_t)          one byte in
+      const uint8_t *frame(); size_t length();   valid after Complete
+      uint32_t stray();                  bytes outside any frame
+  - Portable: the same code runs in the ESP32 ingest task (gnss_ingest.h)
+    and in tools/ingest_bench on a host
+
+  Counters (written by the producer, readable from any core):
+    frames     complete frames queued for the parser
+    dropped    frames lost because the ring was full
+    bad_sum    checksum mismatch or malformed frame
+    overlong   frame longer than the framer accepts (discarded)
+    stray      bytes outside any frame
+*/
+
+#include "spsc_ring.h"
+
+enum class FrameStatus : uint8_t { None, Complete, BadChecksum, Overlong };
+
+struct IngestStats {
+  std::atomic<uint32_t> bytes, frames, dropped, bad_sum, overlong, stray;
+
+  IngestStats() : bytes(0), frames(0), dropped(0), bad_sum(0), overlong(0), stray(0) {}
+};
+
+template <class Framer, size_t N>
+class FrameIngest {
+public:
+  IngestStats stats;
+
+  // Producer side: raw UART bytes in, complete frames into the ring
+  void produce(const uint8_t *p, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      switch (framer_.push(p[i])) {
+        case FrameStatus::Complete:
+          if (ring_.tryWrite(framer_.frame(), framer_.length())) {
+            stats.frames.fetch_add(1, std::memory_order_relaxed);
+          } else {
+            stats.dropped.fetch_add(1, std::memory_order_relaxed);
+          }
+          break;
+        case FrameStatus::BadChecksum: stats.bad_sum.fetch_add(1, std::memory_order_relaxed); break;
+        case FrameStatus::Overlong: stats.overlong.fetch_add(1, std::memory_order_relaxed); break;
+        default: break;
+      }
+    }
+    stats.bytes.fetch_add((uint32_t)n, std::memory_order_relaxed);
+    stats.stray.store(framer_.stray(), std::memory_order_relaxed);
+  }
+
+  // Consumer side: bytes of whole frames, in order
+  size_t consume(uint8_t *p, size_t max) { return ring_.read(p, max); }
+
+  size_t pending() const { return ring_.available(); }
+
+private:
+  Framer framer_;
+  SpscRing<N> ring_;
+};
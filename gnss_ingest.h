@@ -0,0 +1,90 @@
+#pragma once
+/*
+  gnss_ingest.h  —  Dedicated UART ingest task for the GNSS receiver
+  -----------------------------------------------------------------
+  - A FreeRTOS task drains GNSSSerial as soon as bytes arrive, frames them
+    (NMEA sentences or UBX frames) and queues whole frames in a lock-free
+    ring (frame_ingest.h), so a slow HUD frame no longer lets the UART
+    buffer overflow
+  - The physics task takes whole frames from the ring and feeds the parser
+  - UART driver errors (FIFO / buffer overflow) are counted too
+  - Optionally wakes a task (the physics task) with a task notification
+    whenever a whole frame was queued, so it can sleep until its next
+    deadline
+  - Optionally runs the receiver configuration (ubx_config.h) in the same
+    task whenever one was started: at boot (setup() goes on drawing the
+    HUD meanwhile) or a profile switch later. The configurator then reads
+    the UART and passes the bytes on, so frames in between still reach
+    the ring
+
+  Usage:
+    NmeaIngest<GNSS_INGEST_RING> gnssIngest;           // or UbxIngest<...>
+    GNSSSerial.setRxBufferSize(GNSS_UART_RX_BUFFER);  // before begin()
+    GNSSSerial.begin(...);
+    gnssConfig.begin(GNSSSerial, 460800);  ubxQueueProfile(gnssConfig, ...);
+    gnssConfig.start();
+    startGnssIngest(GNSSSerial, gnssIngest, clockTask, &gnssConfig);
+    while ((n = gnssIngest.consume(buf, sizeof(buf))) > 0) ...
+*/
+
+#include "Arduino.h"
+#include "nmea_framer.h"
+#include "ubx_decoder.h"
+#include "ubx_config.h"
+#include <type_traits>
+
+// 8 KB ring ≈ 180 ms of 460800 baud; UART driver buffer in front of it
+static constexpr size_t GNSS_INGEST_RING = 8192;
+static constexpr size_t GNSS_UART_RX_BUFFER = 2048;
+
+std::atomic<uint32_t> gnssUartErrors(0);
+
+template <class Ingest>
+struct GnssIngestTaskArgs {
+  HardwareSerial *ser;
+  Ingest *ingest;
+  TaskHandle_t notify;
+  UbxConfigurator<HardwareSerial> *config;
+};
+
+template <class Ingest>
+static void gnssIngestTask(void *arg) {
+  const GnssIngestTaskArgs<Ingest> a = *static_cast<GnssIngestTaskArgs<Ingest> *>(arg);
+  const auto produce = [&a](const uint8_t *p, size_t n) {
+    const uint32_t frames = a.ingest->stats.frames.load(std::memory_order_relaxed);
+    a.ingest->produce(p, n);
+    if (a.notify && a.ingest->stats.frames.load(std::memory_order_relaxed) != frames) xTaskNotifyGive(a.notify);
+  };
+  uint8_t buf[256];
+  for (;;) {
+    if (a.config && a.config->state() == UbxConfigState::Running) {
+      a.config->poll(millis(), produce);
+      vTaskDelay(1);
+      continue;
+    }
+    const int avail = a.ser->available();
+    if (avail > 0) {
+      produce(buf, a.ser->read(buf, avail < (int)sizeof(buf) ? (size_t)avail : sizeof(buf)));
+    } else {
+      vTaskDelay(1);  // 1 tick; ~46 bytes arrive per ms at 460800 baud
+    }
+  }
+}
+
+// Starts the ingest task (core 0, with the physics task; the HUD runs on core 1);
+// notify (if any) gets a task notification per batch of queued frames;
+// config (if any) is polled whenever it has been started
+template <class Ingest>
+inline void startGnssIngest(HardwareSerial &ser, Ingest &ingest, TaskHandle_t notify = nullptr,
+                            UbxConfigurator<HardwareSerial> *config = nullptr,
+                            UBaseType_t priority = 5, BaseType_t core = 0) {
+  static GnssIngestTaskArgs<Ingest> args;
+  args.ser = &ser;
+  args.ingest = &ingest;
+  args.notify = notify;
+  args.config = config;
+  ser.onReceiveError([](hardwareSerial_error_t) {
+    gnssUartErrors.fetch_add(1, std::memory_order_relaxed);
+  });
+  xTaskCreatePinnedToCore(gnssIngestTask<Ingest>, "gnss_ingest", 4096, &args, priority, nullptr, core);
+}
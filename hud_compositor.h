@@ -0,0 +1,248 @@
+#pragma once
+/*
+  hud_compositor.h  —  One RGB565 framebuffer for the HUD, flushed by DMA
+  ----------------------------------------------------------------------
+  - Layers are pushed into a 320x240 RGB565 framebuffer (same transparent
+    key as a push to the panel) instead of the panel. The framebuffer
+    under a layer is saved before its push and compared after it, so only
+    rows and columns whose pixels really changed are marked dirty (layers
+    larger than SAVE_PIXELS, i.e. the background, mark their whole area)
+  - flush() sends only the dirty rectangles once per frame: rectangles
+    whose bounding box costs no more than sending them apart (plus one
+    address window) are merged first; every rectangle is one window
+  - Rows are copied from the framebuffer (PSRAM) into two small DMA
+    buffers in internal RAM, alternately: one is filled while the other
+    is on the bus, and the last transfer of a frame runs on while the
+    next frame is drawn. A DMA push starts once the previous transfer
+    has finished, so the buffer filled two chunks ago is always free
+  - All widgets of a frame reach the panel together, not one by one
+  - begin() keeps the panel's write transaction open (the panel is only
+    written through here); end() waits for the DMA and closes it
+  - No memory for the framebuffer, or begin(panel, false): pushes go
+    straight to the layers' parent (the panel) as before and flush() does
+    nothing
+
+  Usage:
+    HudCompositor hudCompositor;
+    hudCompositor.begin(M5.Display);                         // setup()
+    hudCompositor.push(canvas, 5, 30, TFT_TRANSPARENT);      // per widget
+    hudCompositor.flush();                                   // end of loop()
+*/
+
+#include <M5Unified.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(ESP_PLATFORM)
+#include <esp_heap_caps.h>
+#endif
+
+class HudCompositor {
+public:
+  static const int MAX_DIRTY = 16;
+  static const int32_t STAGE_PIXELS = 4096;  // per DMA buffer (8 KB)
+  static const int32_t MERGE_SLACK = 256;    // pixels worth one extra address window
+  static const int32_t SAVE_PIXELS = 16384;  // largest layer diffed against the framebuffer
+
+  struct Rect {
+    int32_t x, y, w, h;
+  };
+
+  struct Stats {
+    uint32_t frames;   // flush() calls
+    uint32_t rects;    // address windows sent
+    uint32_t chunks;   // DMA transfers
+    uint64_t marked;   // pixels marked dirty (before merging)
+    uint64_t pixels;   // pixels sent
+  };
+
+  HudCompositor() { memset(&stats, 0, sizeof(stats)); }
+  ~HudCompositor() { end(); }
+
+  // False if the framebuffer or DMA buffers could not be allocated (pushes
+  // then go straight to the panel)
+  bool begin(M5GFX &panel, bool composite = true) {
+    end();
+    panel_ = &panel;
+    if (!composite) return false;
+
+    frame_.setColorDepth(16);
+    if (!frame_.createSprite(panel.width(), panel.height())) return false;
+    for (int i = 0; i < 2; ++i) {
+#if defined(ESP_PLATFORM)
+      stage_[i] = (uint16_t *)heap_caps_malloc(STAGE_PIXELS * sizeof(uint16_t), MALLOC_CAP_DMA);
+#else
+      stage_[i] = (uint16_t *)malloc(STAGE_PIXELS * sizeof(uint16_t));
+#endif
+    }
+    saved_ = (uint16_t *)malloc(SAVE_PIXELS * sizeof(uint16_t));
+    if (!stage_[0] || !stage_[1] || !saved_) {
+      end();
+      return false;
+    }
+    composite_ = true;
+    panel.startWrite();
+    return true;
+  }
+
+  // Waits for the last transfer and returns the panel to direct pushes
+  void end() {
+    if (composite_) {
+      panel_->waitDMA();
+      panel_->endWrite();
+    }
+    composite_ = false;
+    count_ = 0;
+    for (int i = 0; i < 2; ++i) {
+      free(stage_[i]);
+      stage_[i] = nullptr;
+    }
+    free(saved_);
+    saved_ = nullptr;
+    frame_.deleteSprite();
+  }
+
+  bool compositing() const { return composite_; }
+
+  // ---- Layer pushes ----
+  void push(M5Canvas &layer, int32_t x, int32_t y) {
+    if (!composite_) {
+      layer.pushSprite(x, y);
+      return;
+    }
+    const bool saved = save(x, y, layer.width(), layer.height());
+    layer.pushSprite(&frame_, x, y);
+    if (saved) markChanged();
+    else mark(x, y, layer.width(), layer.height());
+  }
+
+  template <class T> void push(M5Canvas &layer, int32_t x, int32_t y, const T &transp) {
+    if (!composite_) {
+      layer.pushSprite(x, y, transp);
+      return;
+    }
+    const bool saved = save(x, y, layer.width(), layer.height());
+    layer.pushSprite(&frame_, x, y, transp);
+    if (saved) markChanged();
+    else mark(x, y, layer.width(), layer.height());
+  }
+
+  // Marks a framebuffer rectangle for the next flush
+  void mark(int32_t x, int32_t y, int32_t w, int32_t h) {
+    if (!clip(x, y, w, h)) return;
+    stats.marked += (uint64_t)w * h;
+
+    Rect r = { x, y, w, h };
+    for (;;) {
+      int best = -1;
+      for (int i = 0; i < count_; ++i) {
+        if (worthMerging(r, dirty_[i])) {
+          best = i;
+          break;
+        }
+      }
+      // Full: merge with the rectangle that grows the least
+      if (best < 0 && count_ == MAX_DIRTY) {
+        int64_t least = INT64_MAX;
+        for (int i = 0; i < count_; ++i) {
+          const int64_t growth = area(bounds(r, dirty_[i])) - area(dirty_[i]);
+          if (growth < least) {
+            least = growth;
+            best = i;
+          }
+        }
+      }
+      if (best < 0) break;
+      r = bounds(r, dirty_[best]);
+      dirty_[best] = dirty_[--count_];
+    }
+    dirty_[count_++] = r;
+  }
+
+  // Sends the dirty rectangles; returns pixels sent
+  uint32_t flush() {
+    if (!composite_) return 0;
+    const uint16_t *fb = (const uint16_t *)frame_.getBuffer();
+    const int32_t stride = frame_.width();
+    uint32_t sent = 0;
+    for (int i = 0; i < count_; ++i) {
+      const Rect &r = dirty_[i];
+      const int32_t rows = STAGE_PIXELS / r.w;
+      for (int32_t row = 0; row < r.h; row += rows) {
+        const int32_t n = (r.h - row < rows) ? r.h - row : rows;
+        // Raw sprite pixels (already in the panel's byte order)
+        uint16_t *dst = stage_[next_];
+        for (int32_t k = 0; k < n; ++k) {
+          memcpy(dst + k * r.w, fb + (size_t)(r.y + row + k) * stride + r.x, r.w * sizeof(uint16_t));
+        }
+        panel_->pushImageDMA(r.x, r.y + row, r.w, n, (const lgfx::swap565_t *)dst);
+        next_ ^= 1;
+        ++stats.chunks;
+      }
+      sent += (uint32_t)(r.w * r.h);
+    }
+    stats.rects += count_;
+    stats.pixels += sent;
+    ++stats.frames;
+    count_ = 0;
+    return sent;
+  }
+
+  Stats stats;
+
+private:
+  // Copies the framebuffer under a layer (clipped) before its push
+  bool save(int32_t x, int32_t y, int32_t w, int32_t h) {
+    if (!clip(x, y, w, h) || w * h > SAVE_PIXELS) return false;
+    const uint16_t *fb = (const uint16_t *)frame_.getBuffer();
+    for (int32_t k = 0; k < h; ++k) memcpy(saved_ + k * w, fb + (size_t)(y + k) * frame_.width() + x, w * sizeof(uint16_t));
+    save_ = { x, y, w, h };
+    return true;
+  }
+
+  // Marks the changed span of every row under the saved rectangle
+  void markChanged() {
+    const Rect &s = save_;
+    const uint16_t *fb = (const uint16_t *)frame_.getBuffer();
+    for (int32_t k = 0; k < s.h; ++k) {
+      const uint16_t *now = fb + (size_t)(s.y + k) * frame_.width() + s.x, *was = saved_ + k * s.w;
+      int32_t x0 = 0, x1 = s.w;
+      while (x0 < s.w && now[x0] == was[x0]) ++x0;
+      if (x0 == s.w) continue;
+      while (now[x1 - 1] == was[x1 - 1]) --x1;
+      mark(s.x + x0, s.y + k, x1 - x0, 1);
+    }
+  }
+
+  bool clip(int32_t &x, int32_t &y, int32_t &w, int32_t &h) const {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > frame_.width()) w = frame_.width() - x;
+    if (y + h > frame_.height()) h = frame_.height() - y;
+    return w > 0 && h > 0;
+  }
+
+  static int64_t area(const Rect &r) { return (int64_t)r.w * r.h; }
+
+  static Rect bounds(const Rect &a, const Rect &b) {
+    const int32_t x0 = a.x < b.x ? a.x : b.x, y0 = a.y < b.y ? a.y : b.y;
+    const int32_t x1 = (a.x + a.w > b.x + b.w) ? a.x + a.w : b.x + b.w;
+    const int32_t y1 = (a.y + a.h > b.y + b.h) ? a.y + a.h : b.y + b.h;
+    const Rect r = { x0, y0, x1 - x0, y1 - y0 };
+    return r;
+  }
+
+  // One window for both costs no more than two (an overlap is sent twice)
+  static bool worthMerging(const Rect &a, const Rect &b) {
+    return area(bounds(a, b)) <= area(a) + area(b) + MERGE_SLACK;
+  }
+
+  M5GFX *panel_ = nullptr;
+  M5Canvas frame_;
+  uint16_t *stage_[2] = { nullptr, nullptr };
+  uint16_t *saved_ = nullptr;
+  Rect save_;
+  int next_ = 0;
+  bool composite_ = false;
+  Rect dirty_[MAX_DIRTY];
+  int count_ = 0;
+};
@@ -0,0 +1,157 @@
+#pragma once
+/*
+  hud_fonts.h  —  Shared VLW fonts and pre-blended digit atlases for the HUD
+  -------------------------------------------------------------------------
+  - canvas.loadFont(array) builds a new font object and parses the VLW
+    header and every glyph's metrics; unloadFont() throws it away. The
+    widgets did that every frame. hudFont() parses each font array once
+    and every canvas shares the result through setFont()
+  - HudDigitAtlas: the characters of a number (0-9 . - + by default)
+    drawn once into a sprite with the widget's text and background
+    colors, i.e. already anti-aliased and blended exactly as drawString
+    with a background color would. A number is then one clipped sprite
+    copy per character instead of per-pixel alpha blending
+  - Cells are the characters' advance boxes: identical to drawString as
+    long as the glyphs stay inside them (true for the digits of the HUD
+    fonts). Characters outside the set, or baseline datums, fall back to
+    drawString
+
+  Usage:
+    canvas.setFont(hudFont(RobotoBoldCondensed12));  // instead of loadFont()
+    static HudDigitAtlas digits;
+    digits.drawFloat(canvas, RobotoBoldCondensed12, fg888, bg888, value, 1, x, y);
+*/
+
+#include <M5Unified.h>
+#include <string.h>
+#include "hud_format.h"
+
+// ---- Font cache ----
+struct HudFontSlot {
+  const uint8_t *vlw;
+  lgfx::PointerWrapper data;  // the font reads glyph bitmaps through it
+  lgfx::VLWfont font;
+};
+
+// Font for a VLW array, parsed on the first call (never freed)
+inline const lgfx::IFont *hudFont(const uint8_t *vlw) {
+  static const int SLOTS = 12;
+  static HudFontSlot *slots[SLOTS];
+  int i = 0;
+  for (; i < SLOTS && slots[i]; ++i) {
+    if (slots[i]->vlw == vlw) return &slots[i]->font;
+  }
+  if (i == SLOTS) i = SLOTS - 1;  // full: reuse the last slot (parses again)
+  if (!slots[i]) slots[i] = new HudFontSlot;
+  slots[i]->vlw = vlw;
+  slots[i]->data.set(vlw);
+  slots[i]->font.loadFont(&slots[i]->data);
+  return &slots[i]->font;
+}
+
+// ---- Digit atlas ----
+class HudDigitAtlas {
+public:
+  explicit HudDigitAtlas(const char *chars = "0123456789.-+") : chars_(chars) {}
+
+  // s at (x, y) with the canvas's text datum; returns the text width
+  int32_t drawString(M5Canvas &canvas, const uint8_t *vlw, uint32_t fg888, uint32_t bg888,
+                     const char *s, int32_t x, int32_t y) {
+    const textdatum_t datum = canvas.getTextDatum();
+    int32_t w = 0;
+    bool cached = !(datum & 16) && prepare(vlw, fg888, bg888, canvas.getColorDepth() == 16 ? 16 : 24);
+    for (const char *c = s; cached && *c; ++c) {
+      const int k = cell(*c);
+      if (k < 0) cached = false;
+      else w += advance_[k];
+    }
+    if (!cached) {
+      canvas.setFont(hudFont(vlw));
+      canvas.setTextColor(fg888, bg888);
+      return canvas.drawString(s, x, y);
+    }
+
+    if ((datum & 3) == 1) x -= w / 2;
+    else if ((datum & 3) == 2) x -= w;
+    if (datum & 8) y -= height_;
+    else if (datum & 4) y -= height_ / 2;
+
+    for (const char *c = s; *c; ++c) {
+      const int k = cell(*c);
+      canvas.setClipRect(x, y, advance_[k], height_);
+      atlas_.pushSprite(&canvas, x - offset_[k], y);
+      x += advance_[k];
+    }
+    canvas.clearClipRect();
+    return w;
+  }
+
+  int32_t drawFloat(M5Canvas &canvas, const uint8_t *vlw, uint32_t fg888, uint32_t bg888,
+                    float v, uint8_t dp, int32_t x, int32_t y) {
+    char buf[24];
+    hudFormatFixed(buf, sizeof(buf), v, dp > 7 ? 7 : dp);
+    return drawString(canvas, vlw, fg888, bg888, buf, x, y);
+  }
+
+  int32_t drawNumber(M5Canvas &canvas, const uint8_t *vlw, uint32_t fg888, uint32_t bg888,
+                     long v, int32_t x, int32_t y) {
+    char buf[24];
+    hudFormatInt(buf, sizeof(buf), v);
+    return drawString(canvas, vlw, fg888, bg888, buf, x, y);
+  }
+
+private:
+  static const int MAX_CELLS = 24;
+
+  int cell(char c) const {
+    const char *p = strchr(chars_, c);
+    return (c && p && p - chars_ < count_) ? (int)(p - chars_) : -1;
+  }
+
+  // (Re)builds the atlas for this font, color pair and depth; false if no
+  // memory
+  bool prepare(const uint8_t *vlw, uint32_t fg888, uint32_t bg888, uint8_t depth) {
+    if (atlas_.getBuffer() && vlw == vlw_ && fg888 == fg_ && bg888 == bg_ && depth == depth_) return true;
+
+    atlas_.deleteSprite();
+    atlas_.setFont(hudFont(vlw));
+    atlas_.setTextSize(1);
+    atlas_.setTextDatum(top_left);
+    count_ = 0;
+    int32_t w = 0;
+    for (const char *c = chars_; *c && count_ < MAX_CELLS; ++c, ++count_) {
+      const char one[2] = { *c, 0 };
+      offset_[count_] = (int16_t)w;
+      advance_[count_] = (int16_t)atlas_.textWidth(one);
+      w += advance_[count_];
+    }
+    height_ = atlas_.fontHeight();
+
+    // Opaque cells in the canvas's format (RGB565 canvases) or RGB888:
+    // exact blended colors, no alpha on push
+    atlas_.setColorDepth(depth);
+    if (w <= 0 || !atlas_.createSprite(w, height_)) {
+      vlw_ = nullptr;
+      return false;
+    }
+    atlas_.setTextColor(fg888, bg888);
+    for (int k = 0; k < count_; ++k) {
+      const char one[2] = { chars_[k], 0 };
+      atlas_.drawString(one, offset_[k], 0);
+    }
+    vlw_ = vlw;
+    fg_ = fg888;
+    bg_ = bg888;
+    depth_ = depth;
+    return true;
+  }
+
+  M5Canvas atlas_;
+  const char *chars_;
+  const uint8_t *vlw_ = nullptr;
+  uint32_t fg_ = 0, bg_ = 0;
+  uint8_t depth_ = 0;
+  int count_ = 0;
+  int32_t height_ = 0;
+  int16_t offset_[MAX_CELLS], advance_[MAX_CELLS];
+};
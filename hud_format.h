@@ -0,0 +1,108 @@
+#pragma once
+/*
+  hud_format.h  —  Allocation-free number formatting for the HUD
+  -------------------------------------------------------------
+  - Fixed decimals into a caller's stack buffer: one scale-and-round to a
+    64-bit integer, then integer digits only (no printf machinery, no
+    String / heap)
+  - Same text as "%.*f" / "%+.*f" / "%*ld": the product is rounded
+    exactly (fma residual), ties to even like printf (float inputs hit
+    exact ties, e.g. 1294.25f at one decimal), and values that round to
+    zero keep their sign ("-0.0")
+  - Magnitudes from 9e15 / 10^decimals up print as "inf"; the HUD's values
+    stay far below
+  - Used by every widget: digit atlases, bar gauge labels, battery,
+    session offset
+
+  Usage:
+    char buf[24];
+    hudFormatFixed(buf, sizeof(buf), value, 6);           // "-7.828440"
+    hudFormatFixed(buf, sizeof(buf), offset_ns, 3, true); // "+12.345"
+    hudFormatInt(buf, sizeof(buf), percent, 3);           // " 42"
+*/
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Copies s (and the terminator) if it fits; returns its length
+inline size_t hudFormatCopy(char *out, size_t size, const char *s) {
+  size_t n = 0;
+  while (s[n]) ++n;
+  if (n < size) {
+    for (size_t i = 0; i <= n; ++i) out[i] = s[i];
+  } else if (size) {
+    out[0] = 0;
+  }
+  return n;
+}
+
+// v with `decimals` (0..9) fractional digits; `plus` prints a '+' for
+// non-negative values. Returns the length; out is left empty if it does
+// not fit.
+inline size_t hudFormatFixed(char *out, size_t size, double v, int decimals, bool plus = false) {
+  static const uint64_t POW10[10] = { 1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull,
+                                      1000000ull, 10000000ull, 100000000ull, 1000000000ull };
+  if (decimals < 0) decimals = 0;
+  if (decimals > 9) decimals = 9;
+  const bool neg = signbit(v);
+  if (isnan(v)) return hudFormatCopy(out, size, neg ? "-nan" : "nan");
+
+  // |v| * 10^decimals = prod + err exactly; round the exact product to
+  // the nearest integer, ties to even
+  const double a = fabs(v), scale = (double)POW10[decimals];
+  const double prod = a * scale;
+  if (!(prod < 9.0e15)) return hudFormatCopy(out, size, neg ? "-inf" : (plus ? "+inf" : "inf"));
+  const double err = fma(a, scale, -prod);
+  const double whole = floor(prod);
+  uint64_t u = (uint64_t)whole;
+  const double above = ((prod - whole) - 0.5) + err;
+  if (above > 0.0 || (above == 0.0 && (u & 1))) ++u;
+  const uint64_t ip = u / POW10[decimals];
+  uint64_t fp = u % POW10[decimals];
+
+  // Right to left in a stack buffer: fraction, point, integer part, sign
+  char tmp[32];
+  char *end = tmp + sizeof(tmp) - 1;
+  *end = 0;
+  char *p = end;
+  for (int i = 0; i < decimals; ++i) {
+    *--p = (char)('0' + (int)(fp % 10));
+    fp /= 10;
+  }
+  if (decimals) *--p = '.';
+  uint64_t q = ip;
+  do {
+    *--p = (char)('0' + (int)(q % 10));
+    q /= 10;
+  } while (q);
+  if (neg) *--p = '-';
+  else if (plus) *--p = '+';
+  return hudFormatCopy(out, size, p);
+}
+
+// v right-aligned in at least `width` characters (space padded)
+inline size_t hudFormatInt(char *out, size_t size, long v, int width = 0) {
+  char tmp[32];
+  char *end = tmp + sizeof(tmp) - 1;
+  *end = 0;
+  char *p = end;
+  uint64_t q = (v < 0) ? (uint64_t)(-(v + 1)) + 1 : (uint64_t)v;
+  do {
+    *--p = (char)('0' + (int)(q % 10));
+    q /= 10;
+  } while (q);
+  if (v < 0) *--p = '-';
+  if (width > (int)sizeof(tmp) - 1) width = (int)sizeof(tmp) - 1;
+  while (end - p < width) *--p = ' ';
+  return hudFormatCopy(out, size, p);
+}
+
+// Appends s to the string in out (truncating); returns the new length
+inline size_t hudFormatAppend(char *out, size_t size, const char *s) {
+  size_t n = 0;
+  while (n < size && out[n]) ++n;
+  while (*s && n + 1 < size) out[n++] = *s++;
+  if (n < size) out[n] = 0;
+  return n;
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <M5Unified.h>
 #include <vector>
+#include "hud_fonts.h"
+#include "relativistic_clock_history.h"
 
 // ========= Simple Battery Status =========
 // 0–10%: red | 10–20%: yellow | >20%: dark green
@@ -52,38 +54,122 @@ inline void drawBatteryStatus(M5Canvas &canvas, int x, int y, float scale = 1.0f
     int text_y = y + body_h / 2;
     canvas.setTextDatum(ML_DATUM);
     canvas.setTextColor(col_txt, col_bg);
-    canvas.loadFont(RobotoBoldCondensed12);
+    canvas.setFont(hudFont(RobotoBoldCondensed12));
     canvas.setTextSize(scale < 1.2f ? 1 : (scale < 2.0f ? 2 : 3));
     char line1[16];
-    snprintf(line1, sizeof(line1), "%3d%%", percent);
+    hudFormatInt(line1, sizeof(line1), percent, 3);
+    hudFormatAppend(line1, sizeof(line1), "%");
     canvas.drawString(line1, text_x, text_y);
   }
 }
 
 
-// Arc gauge for altitude with green gradient (dark -> light).
-// Fills a number of segments proportional to altitude.
-// If altitude < 0, filled segments turn red (alert).
-void drawAltitudeGauge(M5Canvas &canvas, int cx, int cy,
-                       int outer_radius, int inner_radius,
-                       int segments, int start_angle_deg, int total_angle_deg,
-                       int gap_deg, float altitude) {
+// Altitude ring as span tables: which segment owns each ring pixel, built
+// once by fillArc-ing segment indices into an 8-bit sprite (so coverage is
+// exactly fillArc's, later segments winning overlaps as in a full redraw),
+// plus the gradient color of each segment. A frame then redraws only the
+// segments whose fill state changed since the last frame.
+struct AltitudeRingCache {
+  struct Span {
+    int16_t x, y, len;
+  };
+  const void *buffer = nullptr;  // canvas pixels drawn into (new sprite = rebuild)
+  int cx = 0, cy = 0, outer_radius = 0, inner_radius = 0;
+  int segments = 0, start_angle_deg = 0, total_angle_deg = 0, gap_deg = 0;
+  std::vector<Span> spans;
+  std::vector<uint32_t> first;  // spans of segment i: [first[i], first[i + 1])
+  std::vector<uint16_t> color;  // gradient color of segment i
+  int filled = -1;              // filled segments on the canvas (-1: not drawn)
+  bool red_alert = false;
+
+  bool matches(M5Canvas &canvas, int cx_, int cy_, int ro, int ri,
+               int segs, int start, int total, int gap) const {
+    return buffer == canvas.getBuffer() && cx == cx_ && cy == cy_ && outer_radius == ro && inner_radius == ri
+           && segments == segs && start_angle_deg == start && total_angle_deg == total && gap_deg == gap;
+  }
+};
+
+// Segment i spans [seg_start, seg_end] degrees
+static inline void altitudeSegmentAngles(int i, int start_angle_deg, float angle_per_segment, int gap_deg,
+                                         int &seg_start, int &seg_end) {
+  seg_start = int(start_angle_deg + i * angle_per_segment);
+  seg_end = int(seg_start + angle_per_segment - gap_deg);
+  if (seg_end < seg_start) seg_end = seg_start;
+}
+
+static bool buildAltitudeRing(AltitudeRingCache &c, M5Canvas &canvas, int cx, int cy,
+                              int outer_radius, int inner_radius,
+                              int segments, int start_angle_deg, int total_angle_deg, int gap_deg) {
+  const int w = canvas.width(), h = canvas.height();
+  M5Canvas owner;
+  owner.setColorDepth(8);
+  if (segments > 255 || !owner.createSprite(w, h)) return false;
+  owner.fillScreen((uint8_t)0);
+
+  const float angle_per_segment = float(total_angle_deg) / segments;
+  for (int i = 0; i < segments; i++) {
+    int seg_start, seg_end;
+    altitudeSegmentAngles(i, start_angle_deg, angle_per_segment, gap_deg, seg_start, seg_end);
+    owner.fillArc(cx, cy, outer_radius, inner_radius, seg_start, seg_end, (uint8_t)(i + 1));
+  }
+
+  // Runs of equal owner, bucketed per segment
+  std::vector<std::vector<AltitudeRingCache::Span>> per(segments);
+  const uint8_t *px = (const uint8_t *)owner.getBuffer();
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w;) {
+      const uint8_t id = px[y * w + x];
+      int len = 1;
+      while (x + len < w && px[y * w + x + len] == id) len++;
+      if (id) per[id - 1].push_back({ (int16_t)x, (int16_t)y, (int16_t)len });
+      x += len;
+    }
+  }
+  owner.deleteSprite();
+
+  c.spans.clear();
+  c.first.assign(1, 0);
+  for (int i = 0; i < segments; i++) {
+    c.spans.insert(c.spans.end(), per[i].begin(), per[i].end());
+    c.first.push_back((uint32_t)c.spans.size());
+  }
+
   // Gradient: dark green (min) -> light green (max)
   int r_start = 0, g_start = 60, b_start = 0;
   int r_end = 100, g_end = 255, b_end = 100;
+  c.color.resize(segments);
+  for (int i = 0; i < segments; i++) {
+    float t = (segments > 1) ? float(i) / float(segments - 1) : 1.0f;
+    int r = int(r_start + (r_end - r_start) * t);
+    int g = int(g_start + (g_end - g_start) * t);
+    int b = int(b_start + (b_end - b_start) * t);
+    c.color[i] = canvas.color565(r, g, b);
+  }
 
-  // Scale limits
-  float alt_min = -500.0f;
-  float alt_max = 9000.0f;
+  c.buffer = canvas.getBuffer();
+  c.cx = cx;
+  c.cy = cy;
+  c.outer_radius = outer_radius;
+  c.inner_radius = inner_radius;
+  c.segments = segments;
+  c.start_angle_deg = start_angle_deg;
+  c.total_angle_deg = total_angle_deg;
+  c.gap_deg = gap_deg;
+  c.filled = -1;
+  return true;
+}
 
-  // How many segments to fill (clamp 0..1)
-  float p = (altitude - alt_min) / (alt_max - alt_min);
-  if (p < 0) p = 0;
-  if (p > 1) p = 1;
-  int filled_segments = int(segments * p + 0.5f);
+// Direct drawing of every segment (fallback when the span table cannot be
+// built: more than 255 segments or no memory for the index sprite).
+void drawAltitudeGaugeSegments(M5Canvas &canvas, int cx, int cy,
+                               int outer_radius, int inner_radius,
+                               int segments, int start_angle_deg, int total_angle_deg,
+                               int gap_deg, int filled_segments, bool red_alert) {
+  // Gradient: dark green (min) -> light green (max)
+  int r_start = 0, g_start = 60, b_start = 0;
+  int r_end = 100, g_end = 255, b_end = 100;
 
   float angle_per_segment = float(total_angle_deg) / segments;
-  bool red_alert = (altitude < 0);
 
   for (int i = 0; i < segments; i++) {
     // Linear RGB gradient along segments
@@ -93,9 +179,8 @@ void drawAltitudeGauge(M5Canvas &canvas, int cx, int cy,
     int b = int(b_start + (b_end - b_start) * t);
     uint16_t seg_color = red_alert ? TFT_RED : canvas.color565(r, g, b);
 
-    int seg_start = int(start_angle_deg + i * angle_per_segment);
-    int seg_end = int(seg_start + angle_per_segment - gap_deg);
-    if (seg_end < seg_start) seg_end = seg_start;
+    int seg_start, seg_end;
+    altitudeSegmentAngles(i, start_angle_deg, angle_per_segment, gap_deg, seg_start, seg_end);
 
     if (i < filled_segments) {
       // Filled segments: green gradient OR red if alert
@@ -108,6 +193,61 @@ void drawAltitudeGauge(M5Canvas &canvas, int cx, int cy,
   }
 }
 
+// Arc gauge for altitude with green gradient (dark -> light).
+// Fills a number of segments proportional to altitude.
+// If altitude < 0, filled segments turn red (alert).
+// Only segments that changed state since the previous call are redrawn
+// (the ring pixels belong to this gauge alone on the canvas).
+void drawAltitudeGauge(M5Canvas &canvas, int cx, int cy,
+                       int outer_radius, int inner_radius,
+                       int segments, int start_angle_deg, int total_angle_deg,
+                       int gap_deg, float altitude) {
+  static AltitudeRingCache ring;
+
+  // Scale limits
+  float alt_min = -500.0f;
+  float alt_max = 9000.0f;
+
+  // How many segments to fill (clamp 0..1)
+  float p = (altitude - alt_min) / (alt_max - alt_min);
+  if (p < 0) p = 0;
+  if (p > 1) p = 1;
+  int filled_segments = int(segments * p + 0.5f);
+  bool red_alert = (altitude < 0);
+
+  if (!ring.matches(canvas, cx, cy, outer_radius, inner_radius, segments, start_angle_deg, total_angle_deg, gap_deg)
+      && !buildAltitudeRing(ring, canvas, cx, cy, outer_radius, inner_radius,
+                            segments, start_angle_deg, total_angle_deg, gap_deg)) {
+    ring.buffer = nullptr;
+    drawAltitudeGaugeSegments(canvas, cx, cy, outer_radius, inner_radius, segments,
+                              start_angle_deg, total_angle_deg, gap_deg, filled_segments, red_alert);
+    return;
+  }
+
+  // Changed range: between the old and new fill level, or every filled
+  // segment when the alert color flips
+  int lo = 0, hi = segments;
+  if (ring.filled >= 0) {
+    if (red_alert != ring.red_alert) {
+      hi = (ring.filled > filled_segments) ? ring.filled : filled_segments;
+    } else {
+      lo = (ring.filled < filled_segments) ? ring.filled : filled_segments;
+      hi = (ring.filled > filled_segments) ? ring.filled : filled_segments;
+    }
+  }
+
+  const uint16_t col_unfilled = canvas.color565(30, 40, 30);
+  for (int i = lo; i < hi; i++) {
+    const uint16_t col = (i < filled_segments) ? (red_alert ? (uint16_t)TFT_RED : ring.color[i]) : col_unfilled;
+    for (uint32_t k = ring.first[i]; k < ring.first[i + 1]; k++) {
+      const AltitudeRingCache::Span &s = ring.spans[k];
+      canvas.drawFastHLine(s.x, s.y, s.len, col);
+    }
+  }
+  ring.filled = filled_segments;
+  ring.red_alert = red_alert;
+}
+
 static inline int norm360(int a) {
   a %= 360;
   if (a < 0) a += 360;
@@ -261,12 +401,93 @@ void drawLatitudeGauge(M5Canvas &canvas, int cx, int cy,
 }
 
 
+// Pre-rendered gradient of one bar gauge instance (RGB565 sprite, built on
+// the first call) and what the instance last put on its canvas, so an
+// unchanged frame can be skipped. Owned by the caller, one per gauge.
+struct BarGaugeStrip {
+  M5Canvas strip;
+  const void *buffer = nullptr;  // canvas drawn into (new sprite = redraw)
+  int width = 0, height = 0;
+  int rgb_start = -1, rgb_end = -1;
+  int filled_w = -1;  // -1: nothing drawn yet
+  char label[24] = "";
+
+  // Builds the strip if the geometry or colors differ from the last call
+  bool prepare(int width_, int height_, int r_start, int g_start, int b_start, int r_end, int g_end, int b_end) {
+    const int rgb0 = (r_start << 16) | (g_start << 8) | b_start;
+    const int rgb1 = (r_end << 16) | (g_end << 8) | b_end;
+    if (strip.getBuffer() && width == width_ && height == height_ && rgb_start == rgb0 && rgb_end == rgb1) return true;
+
+    strip.deleteSprite();
+    strip.setColorDepth(16);
+    if (!strip.createSprite(width_, height_)) return false;
+    int denom = (width_ > 1) ? (width_ - 1) : 1;
+    for (int i = 0; i < width_; i++) {
+      float t = float(i) / float(denom);
+      int r = int(r_start + (r_end - r_start) * t);
+      int g = int(g_start + (g_end - g_start) * t);
+      int b = int(b_start + (b_end - b_start) * t);
+      strip.drawFastVLine(i, 0, height_, strip.color565(r, g, b));
+    }
+    width = width_;
+    height = height_;
+    rgb_start = rgb0;
+    rgb_end = rgb1;
+    filled_w = -1;
+    return true;
+  }
+
+  // True if the canvas already shows this fill and label; otherwise
+  // remembers them for the next frame
+  bool unchanged(M5Canvas &canvas, int filled_w_, const char *label_) {
+    const char *l = label_ ? label_ : "";
+    if (buffer == canvas.getBuffer() && filled_w == filled_w_ && strcmp(label, l) == 0) return true;
+    buffer = canvas.getBuffer();
+    filled_w = filled_w_;
+    strlcpy(label, l, sizeof(label));
+    return false;
+  }
+
+  // Copies the first filled_w_ columns of the strip onto the canvas
+  void blit(M5Canvas &canvas, int x, int y, int filled_w_) {
+    if (filled_w_ <= 0) return;
+    canvas.setClipRect(x, y, filled_w_, height);
+    strip.pushSprite(&canvas, x, y);
+    canvas.clearClipRect();
+  }
+};
+
+// Gradient fill (left -> right) of the first filled_w columns: one strip
+// copy when the instance has a strip, column by column otherwise
+static inline void drawBarGradient(M5Canvas &canvas, BarGaugeStrip *strip,
+                                   int x, int y, int width, int height, int filled_w,
+                                   int r_start, int g_start, int b_start,
+                                   int r_end, int g_end, int b_end) {
+  if (strip && strip->prepare(width, height, r_start, g_start, b_start, r_end, g_end, b_end)) {
+    strip->blit(canvas, x, y, filled_w);
+    return;
+  }
+  int denom = (width > 1) ? (width - 1) : 1;
+  for (int i = 0; i < filled_w; i++) {
+    float t = float(i) / float(denom);
+    int r = int(r_start + (r_end - r_start) * t);
+    int g = int(g_start + (g_end - g_start) * t);
+    int b = int(b_start + (b_end - b_start) * t);
+    uint16_t col = canvas.color565(r, g, b);
+    canvas.drawFastVLine(x + i, y, height, col);
+  }
+}
+
 // Horizontal speed bar with true gradient fill.
 // Fills from left (min) to right (max).
-void drawSpeedBarGauge(M5Canvas &canvas, int x, int y, int width, int height,
+// With a strip: the fill is one copy from the pre-rendered gradient, and
+// nothing is drawn (returns false) while the fill width and label (the
+// value the caller prints) are the same as on the previous call.
+bool drawSpeedBarGauge(M5Canvas &canvas, int x, int y, int width, int height,
                        float speed, float speed_min, float speed_max,
                        int r_start, int g_start, int b_start,  // gradient start color
-                       int r_end, int g_end, int b_end)        // gradient end color
+                       int r_end, int g_end, int b_end,        // gradient end color
+                       BarGaugeStrip *strip = nullptr, const char *label = nullptr)
 {
   uint16_t col_bg = canvas.color565(30, 40, 30);
 
@@ -280,28 +501,25 @@ void drawSpeedBarGauge(M5Canvas &canvas, int x, int y, int width, int height,
   if (p > 1) p = 1;
   int filled_w = int(width * p + 0.5f);
 
+  if (strip && strip->unchanged(canvas, filled_w, label)) return false;
+
   // Background
-  canvas.fillRect(x, y, width, height, col_bg);
+  canvas.fillRect(x + filled_w, y, width - filled_w, height, col_bg);
 
   // Gradient fill (left -> right)
-  int denom = (width > 1) ? (width - 1) : 1;
-  for (int i = 0; i < filled_w; i++) {
-    float t = float(i) / float(denom);
-    int r = int(r_start + (r_end - r_start) * t);
-    int g = int(g_start + (g_end - g_start) * t);
-    int b = int(b_start + (b_end - b_start) * t);
-    uint16_t col = canvas.color565(r, g, b);
-    canvas.drawFastVLine(x + i, y, height, col);
-  }
+  drawBarGradient(canvas, strip, x, y, width, height, filled_w,
+                  r_start, g_start, b_start, r_end, g_end, b_end);
 
   // Optional border
   // canvas.drawRect(x, y, width, height, canvas.color565(80, 80, 80));
+  return true;
 }
 
 // Horizontal bar with gradient and optional scale (min, mid, max).
 // - Fills from left (min) to right (max)
 // - Optional ticks and labels below the bar
-void drawHorizontalBarGauge(
+// - Optional strip: as for drawSpeedBarGauge (returns false when skipped)
+bool drawHorizontalBarGauge(
   M5Canvas &canvas,
   int x, int y, int width, int height,
   float value, float val_min, float val_max,
@@ -314,7 +532,10 @@ void drawHorizontalBarGauge(
   int decimals = 3,
   const char *unit = " m/s^2",
   int text_margin = 4,
-  int text_size = 1) {
+  int text_size = 1,
+  // --- cached gradient / change detection:
+  BarGaugeStrip *strip = nullptr,
+  const char *label = nullptr) {
 
   // Colors
   uint16_t col_bg = canvas.color565(30, 40, 30);
@@ -337,19 +558,14 @@ void drawHorizontalBarGauge(
   if (p > 1) p = 1;
   int filled_w = int(width * p + 0.5f);
 
+  if (strip && strip->unchanged(canvas, filled_w, label)) return false;
+
   // Background
-  canvas.fillRect(x, y, width, height, col_bg);
+  canvas.fillRect(x + filled_w, y, width - filled_w, height, col_bg);
 
   // Gradient fill (left -> right)
-  int denom = (width > 1) ? (width - 1) : 1;
-  for (int i = 0; i < filled_w; i++) {
-    float t = float(i) / float(denom);
-    int r = int(r_start + (r_end - r_start) * t);
-    int g = int(g_start + (g_end - g_start) * t);
-    int b = int(b_start + (b_end - b_start) * t);
-    uint16_t col = canvas.color565(r, g, b);
-    canvas.drawFastVLine(x + i, y, height, col);
-  }
+  drawBarGradient(canvas, strip, x, y, width, height, filled_w,
+                  r_start, g_start, b_start, r_end, g_end, b_end);
 
   // Ticks (top/bottom)
   if (draw_ticks && ticks > 0) {
@@ -378,20 +594,19 @@ void drawHorizontalBarGauge(
     int y_text = y + height + text_margin;
     float v_mid = (val_min + val_max) * 0.5f;
 
-    auto fmt = [&](float v) {
-      char buf[24];
-      dtostrf(v, 0, decimals, buf);
-      int len = strlen(buf);
-      strlcpy(buf + len, unit, sizeof(buf) - len);
-      return String(buf);
+    // Value + unit into stack buffers
+    auto fmt = [&](char (&buf)[24], float v) {
+      hudFormatFixed(buf, sizeof(buf), v, decimals);
+      hudFormatAppend(buf, sizeof(buf), unit);
     };
 
-    String s_min = fmt(val_min);
-    String s_mid = fmt(v_mid);
-    String s_max = fmt(val_max);
+    char s_min[24], s_mid[24], s_max[24];
+    fmt(s_min, val_min);
+    fmt(s_mid, v_mid);
+    fmt(s_max, val_max);
 
     // canvas.setTextSize(text_size);
-    canvas.loadFont(RobotoBold9);
+    canvas.setFont(hudFont(RobotoBold9));
     canvas.setTextColor(col_text, canvas.color565(253, 47, 43));  // keep logic as-is
     canvas.setTextDatum(TC_DATUM);                                // Top-Center
 
@@ -404,6 +619,7 @@ void drawHorizontalBarGauge(
 
     canvas.setTextDatum(TL_DATUM);  // restore default
   }
+  return true;
 }
 
 
@@ -532,18 +748,31 @@ inline void drawGpsSignalGauge5Smooth(M5Canvas &c, int x, int y, int h,
 
 
 // Sliding ECG with horizontal grid per UNIT and dense vertical grid (parametrizable)
+// Scrolls: each call shifts the canvas left by one column (memmove per row)
+// and draws only the new right column (grid, zero dash) and the newest line
+// segment; the grid scrolls with the trace like chart paper. The whole
+// chart is redrawn only on the first call, a new canvas / size, or when
+// the range, colors or grid parameters change.
+// With a history and level 0..3, each column is one history bucket (1 s,
+// 10 s, 1 min, 10 min) drawn as a min/max envelope under the mean line;
+// the chart then scrolls when a bucket closes and otherwise repaints only
+// the two right columns (the open bucket). Level -1: one sample per frame.
 void drawTimeDilationChart(M5Canvas &canvas, double dilation_value,
                            double minVal = -6.0, double maxVal = 3.0,
                            uint16_t colBg = 0, uint16_t colLine = 0,
                            uint16_t colZero = 0, uint16_t colGrid = 0,
                            int dashLen = 4, int gapLen = 3,
-                           int vStepPx = 6, int vMajorEvery = 4, uint16_t colGridMajor = 0) {
+                           int vStepPx = 6, int vMajorEvery = 4, uint16_t colGridMajor = 0,
+                           const DilationHistory *history = nullptr, int level = -1) {
   // Default colors
   if (colBg == 0) colBg = 0;
   if (colLine == 0) colLine = canvas.color565(80, 255, 80);           // waveform
   if (colZero == 0) colZero = canvas.color565(220, 170, 40);          // zero (amber)
   if (colGrid == 0) colGrid = canvas.color565(18, 36, 18);            // fine grid
   if (colGridMajor == 0) colGridMajor = canvas.color565(32, 64, 32);  // “major” grid
+  if (vStepPx < 1) vStepPx = 1;
+  const uint16_t colEnvelope = canvas.color565(30, 110, 30);          // min/max band
+  if (!history || level < 0 || level >= DilationHistory::LEVELS) level = -1;
 
   const int W = canvas.width();
   const int H = canvas.height();
@@ -556,15 +785,29 @@ void drawTimeDilationChart(M5Canvas &canvas, double dilation_value,
     return int(outMin + p * (outMax - outMin) + 0.5);
   };
 
-  // State: circular buffer
+  // State: circular buffer, scroll phase and what the canvas was drawn with
   struct State {
     bool prim = true;
     int head = -1;
     int lastW = 0, lastH = 0;
     std::vector<int> ybuf;
+    uint32_t scrolled = 0;  // columns scrolled since the last full redraw
+    uint32_t closed = 0;    // history buckets closed at the last draw
+    const void *buffer = nullptr;
+    const DilationHistory *history = nullptr;
+    int level = -1;
+    double minVal = 0, maxVal = 0;
+    uint16_t colors[5] = {};
+    int params[4] = {};
   };
   static State st;
 
+  const uint16_t colors[5] = { colBg, colLine, colZero, colGrid, colGridMajor };
+  const int params[4] = { dashLen, gapLen, vStepPx, vMajorEvery };
+  const bool full = st.prim || st.lastW != W || st.lastH != H || st.buffer != canvas.getBuffer()
+                    || st.minVal != minVal || st.maxVal != maxVal || st.history != history || st.level != level
+                    || memcmp(st.colors, colors, sizeof(colors)) != 0 || memcmp(st.params, params, sizeof(params)) != 0;
+
   if (st.prim || st.lastW != W || st.lastH != H) {
     st.ybuf.assign(W, mapf_clamp(dilation_value, minVal, maxVal, H - 1, 0));
     st.head = W - 1;
@@ -576,34 +819,30 @@ void drawTimeDilationChart(M5Canvas &canvas, double dilation_value,
     st.ybuf[st.head] = mapf_clamp(dilation_value, minVal, maxVal, H - 1, 0);
   }
 
-  // Background
-  canvas.fillScreen(colBg);
+  const int yZero = (minVal <= 0.0 && 0.0 <= maxVal) ? mapf_clamp(0.0, minVal, maxVal, H - 1, 0) : -1;
+  const int uStart = (int)ceil(minVal);
+  const int uEnd = (int)floor(maxVal);
 
-  // DENSE VERTICAL GRID (major lines every vMajorEvery * vStepPx)
-  if (vStepPx < 1) vStepPx = 1;
-  for (int x = 0; x < W; x += vStepPx) {
-    bool isMajor = (vMajorEvery > 0) && (x % (vStepPx * vMajorEvery) == 0);
-    canvas.drawFastVLine(x, 0, H, isMajor ? colGridMajor : colGrid);
-  }
+  // Background, grid and zero dash of canvas column x (grid column x + scroll phase)
+  auto drawColumn = [&](int x) {
+    const uint32_t g = st.scrolled + (uint32_t)x;
+    canvas.drawFastVLine(x, 0, H, colBg);
 
-  // HORIZONTAL GRID per unit (except zero)
-  int uStart = (int)ceil(minVal);
-  int uEnd = (int)floor(maxVal);
-  for (int u = uStart; u <= uEnd; ++u) {
-    if (u == 0) continue;
-    int yU = mapf_clamp((double)u, minVal, maxVal, H - 1, 0);
-    canvas.drawFastHLine(0, yU, W, colGrid);
-  }
+    // DENSE VERTICAL GRID (major lines every vMajorEvery * vStepPx)
+    if (g % (uint32_t)vStepPx == 0) {
+      bool isMajor = (vMajorEvery > 0) && (g % (uint32_t)(vStepPx * vMajorEvery) == 0);
+      canvas.drawFastVLine(x, 0, H, isMajor ? colGridMajor : colGrid);
+    }
 
-  // Zero as dashed line (if inside range)
-  if (minVal <= 0.0 && 0.0 <= maxVal) {
-    int yZero = mapf_clamp(0.0, minVal, maxVal, H - 1, 0);
-    for (int x = 0; x < W; x += (dashLen + gapLen)) {
-      int len = dashLen;
-      if (x + len > W) len = W - x;
-      if (len > 0) canvas.drawFastHLine(x, yZero, len, colZero);
+    // HORIZONTAL GRID per unit (except zero)
+    for (int u = uStart; u <= uEnd; ++u) {
+      if (u == 0) continue;
+      canvas.drawPixel(x, mapf_clamp((double)u, minVal, maxVal, H - 1, 0), colGrid);
     }
-  }
+
+    // Zero as dashed line (if inside range)
+    if (yZero >= 0 && g % (uint32_t)(dashLen + gapLen) < (uint32_t)dashLen) canvas.drawPixel(x, yZero, colZero);
+  };
 
   // Sliding waveform: newest at the right
   auto idx_from_x = [&](int x) -> int {
@@ -612,11 +851,73 @@ void drawTimeDilationChart(M5Canvas &canvas, double dilation_value,
     if (k < 0) k += W;
     return k;
   };
-  int x0 = 0, y0 = st.ybuf[idx_from_x(0)];
-  for (int x = 1; x < W; ++x) {
-    int y1 = st.ybuf[idx_from_x(x)];
-    canvas.drawLine(x0, y0, x, y1, colLine);
-    x0 = x;
-    y0 = y1;
+
+  // Column x: rows of max, min and mean; false if no data (empty bucket)
+  auto columnAt = [&](int x, int &yMax, int &yMin, int &yMean) -> bool {
+    if (level < 0) {
+      yMax = yMin = yMean = st.ybuf[idx_from_x(x)];
+      return true;
+    }
+    HistoryBucket b;
+    if (!history->bucket(level, (uint32_t)(W - 1 - x), b) || !b.count) return false;
+    yMax = mapf_clamp(b.max, minVal, maxVal, H - 1, 0);
+    yMin = mapf_clamp(b.min, minVal, maxVal, H - 1, 0);
+    yMean = mapf_clamp(b.mean(), minVal, maxVal, H - 1, 0);
+    return true;
+  };
+
+  // Repaints columns x0..x1: grid, envelope, and every line segment
+  // crossing them (clipped)
+  auto paintColumns = [&](int x0, int x1) {
+    canvas.setClipRect(x0, 0, x1 - x0 + 1, H);
+    for (int x = x0; x <= x1; ++x) drawColumn(x);
+    int yMax, yMin, yMean, prevMean = 0;
+    if (level >= 0) {
+      for (int x = x0; x <= x1; ++x) {
+        if (columnAt(x, yMax, yMin, yMean)) canvas.drawFastVLine(x, yMax, yMin - yMax + 1, colEnvelope);
+      }
+    }
+    const int xa = (x0 > 0) ? x0 - 1 : 0;
+    const int xb = (x1 < W - 1) ? x1 + 1 : W - 1;
+    bool prev = columnAt(xa, yMax, yMin, prevMean);
+    for (int x = xa + 1; x <= xb; ++x) {
+      const bool cur = columnAt(x, yMax, yMin, yMean);
+      if (prev && cur) canvas.drawLine(x - 1, prevMean, x, yMean, colLine);
+      prev = cur;
+      prevMean = yMean;
+    }
+    canvas.clearClipRect();
+  };
+
+  // Columns to shift: one per frame, or one per closed history bucket
+  const uint32_t closed = (level >= 0) ? history->closed(level) : st.closed + 1;
+  const uint32_t shift = closed - st.closed;
+  st.closed = closed;
+
+  if (full || shift > 1) {
+    st.scrolled = 0;
+    st.buffer = canvas.getBuffer();
+    st.minVal = minVal;
+    st.maxVal = maxVal;
+    st.history = history;
+    st.level = level;
+    memcpy(st.colors, colors, sizeof(colors));
+    memcpy(st.params, params, sizeof(params));
+    paintColumns(0, W - 1);
+    return;
+  }
+
+  if (shift == 1) {
+    // Scroll left by one column (memmove per row); column 0 still holds
+    // the left half of the segment that scrolled out
+    uint8_t *px = (uint8_t *)canvas.getBuffer();
+    const size_t bpp = (canvas.getColorDepth() + 7) / 8;
+    const size_t stride = (size_t)W * bpp;
+    for (int y = 0; y < H; ++y) memmove(px + y * stride, px + y * stride + bpp, stride - bpp);
+    ++st.scrolled;
+    paintColumns(0, 0);
   }
+
+  // Newest column (and its segment into the previous one)
+  paintColumns(W - 2, W - 1);
 }
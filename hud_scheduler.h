@@ -0,0 +1,191 @@
+#pragma once
+/*
+  hud_scheduler.h  —  Frame pacing with a refresh policy per widget
+  ----------------------------------------------------------------
+  - Each task (a widget draw, the touch poll, a sensor read...) declares a
+    period, event bits, or both: it is due when its deadline has passed or
+    when one of its events was signalled since its last run (e.g. a new
+    GNSS fix). With both, the period is a fallback: every run, by event or
+    not, pushes the deadline one period ahead
+  - Periodic tasks keep a fixed rate (deadline += period); a task that
+    fell more than a period behind skips the missed runs instead of
+    catching up in a burst
+  - sleepMs(): time to the earliest deadline (0 while an event is
+    pending), so loop() sleeps exactly that long, or less when a new
+    GNSS fix wakes it
+  - Reports per task: runs, achieved vs. target rate over a window
+    (target = 1 / period, or the rate of its events, several before one
+    run counting once), late runs (deadline missed by more than the frame
+    budget) and the worst lateness; per pass: work time and passes over
+    the frame budget
+  - Check every task with due() on every pass (a task never checked keeps
+    its deadline in the past and the loop never sleeps); gate the work,
+    not the check: if (sched.due(id, now) && enabled) ...
+  - No Arduino dependency: times are passed in (millis() / micros() on the
+    device, virtual time in tools/hud_render)
+
+  Usage:
+    HudScheduler sched(16);                                  // frame budget, ms
+    const int chart = sched.add("chart", 1000, EV_FIX);      // per fix, >= 1 Hz
+    if (gpsOK) sched.signal(EV_FIX);
+    sched.beginPass(micros());
+    if (sched.due(chart, millis())) drawDynamicLineChart(...);
+    sched.endPass(micros());
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sched.sleepMs(millis())));
+*/
+
+#include <stdint.h>
+
+class HudScheduler {
+public:
+  static const int MAX_TASKS = 16;
+
+  struct Task {
+    const char *name;
+    uint32_t period_ms;    // 0: events only
+    uint32_t events;       // event bits that make it due
+    uint32_t next_ms;      // deadline (period_ms > 0)
+    bool pending;          // one of its events arrived since the last run
+    uint32_t runs;
+    uint32_t late;         // runs past the deadline by more than the budget
+    uint32_t max_late_ms;  // worst lateness of a periodic run
+    uint32_t window_runs, window_events;
+  };
+
+  struct Stats {
+    uint32_t passes;     // beginPass() / endPass() pairs
+    uint32_t overruns;   // passes whose work exceeded the frame budget
+    uint32_t max_work_us;
+    uint64_t work_us;
+    uint32_t sleeps;     // slept() calls
+    uint32_t woken;      // sleeps cut short by an event
+  };
+
+  explicit HudScheduler(uint32_t budget_ms = 16) : budget_ms_(budget_ms) {
+    stats = Stats();
+  }
+
+  // Returns the task's id (-1 if the table is full). Due on the first check.
+  int add(const char *name, uint32_t period_ms, uint32_t events = 0) {
+    if (count_ == MAX_TASKS) return -1;
+    Task &t = tasks_[count_];
+    t = Task();
+    t.name = name;
+    t.period_ms = period_ms;
+    t.events = events;
+    t.pending = true;
+    t.next_ms = 0;
+    return count_++;
+  }
+
+  // Marks every task waiting for one of these bits as due
+  void signal(uint32_t events) {
+    for (int i = 0; i < count_; ++i) {
+      Task &t = tasks_[i];
+      if (!(t.events & events)) continue;
+      if (!t.pending) ++t.window_events;  // events before its next run count once
+      t.pending = true;
+    }
+  }
+
+  // True (and the run is counted) if the task is due now
+  bool due(int id, uint32_t now_ms) {
+    if (id < 0 || id >= count_) return false;
+    start(now_ms);
+    Task &t = tasks_[id];
+    const bool timed = t.period_ms && (int32_t)(now_ms - t.next_ms) >= 0;
+    if (!timed && !t.pending) return false;
+
+    if (timed && !t.pending) {
+      const uint32_t lateness = now_ms - t.next_ms;
+      if (lateness > t.max_late_ms) t.max_late_ms = lateness;
+      if (lateness > budget_ms_) ++t.late;
+    }
+    if (t.period_ms) {
+      if (t.events) {
+        t.next_ms = now_ms + t.period_ms;  // fallback: one period after any run
+      } else {
+        t.next_ms += t.period_ms;
+        if ((int32_t)(now_ms - t.next_ms) >= 0) t.next_ms = now_ms + t.period_ms;  // skip missed runs
+      }
+    }
+    t.pending = false;
+    ++t.runs;
+    ++t.window_runs;
+    return true;
+  }
+
+  // Milliseconds until the earliest deadline (0: something is due now);
+  // at most max_ms
+  uint32_t sleepMs(uint32_t now_ms, uint32_t max_ms = 1000) const {
+    uint32_t wait = max_ms;
+    for (int i = 0; i < count_; ++i) {
+      const Task &t = tasks_[i];
+      if (t.pending) return 0;
+      if (!t.period_ms) continue;
+      const int32_t left = (int32_t)(t.next_ms - now_ms);
+      if (left <= 0) return 0;
+      if ((uint32_t)left < wait) wait = (uint32_t)left;
+    }
+    return wait;
+  }
+
+  // ---- Pass accounting ----
+  void beginPass(uint32_t now_us) { pass_us_ = now_us; }
+
+  void endPass(uint32_t now_us) {
+    const uint32_t work = now_us - pass_us_;
+    ++stats.passes;
+    stats.work_us += work;
+    if (work > stats.max_work_us) stats.max_work_us = work;
+    if (work > budget_ms_ * 1000u) ++stats.overruns;
+  }
+
+  // After each sleep: woken_by_event if it ended before its timeout
+  void slept(bool woken_by_event) {
+    ++stats.sleeps;
+    if (woken_by_event) ++stats.woken;
+  }
+
+  // ---- Report ----
+  int count() const { return count_; }
+  const Task &task(int id) const { return tasks_[id]; }
+  uint32_t budgetMs() const { return budget_ms_; }
+
+  float achievedHz(int id, uint32_t now_ms) const {
+    const uint32_t span = now_ms - window_ms_;
+    return span ? tasks_[id].window_runs * 1000.0f / span : 0.0f;
+  }
+
+  // 1 / period, or the rate of the task's events while they arrive
+  float targetHz(int id, uint32_t now_ms) const {
+    const Task &t = tasks_[id];
+    const uint32_t span = now_ms - window_ms_;
+    if (t.events && t.window_events && span) return t.window_events * 1000.0f / span;
+    return t.period_ms ? 1000.0f / t.period_ms : 0.0f;
+  }
+
+  // Starts a new rate window
+  void resetWindow(uint32_t now_ms) {
+    window_ms_ = now_ms;
+    for (int i = 0; i < count_; ++i) tasks_[i].window_runs = tasks_[i].window_events = 0;
+  }
+
+  Stats stats;
+
+private:
+  // First check: deadlines and the rate window count from here
+  void start(uint32_t now_ms) {
+    if (started_) return;
+    started_ = true;
+    window_ms_ = now_ms;
+    for (int i = 0; i < count_; ++i) tasks_[i].next_ms = now_ms;
+  }
+
+  Task tasks_[MAX_TASKS];
+  int count_ = 0;
+  bool started_ = false;
+  uint32_t budget_ms_;
+  uint32_t window_ms_ = 0;
+  uint32_t pass_us_ = 0;
+};
@@ -0,0 +1,184 @@
+#pragma once
+/*
+  nav_rate_governor.h  —  Navigation rate from motion and battery
+  --------------------------------------------------------------
+  - Picks one of three levels from the GNSS ground speed, the motion the
+    IMU sees (|accel| - 1 g, smoothed), the fix-to-fix acceleration and
+    the battery level:
+      STATIONARY  2 Hz   on a desk
+      MOVING     10 Hz   walking, driving (and the boot level)
+      FLIGHT     25 Hz   above ~200 km/h (planes, fast trains)
+  - Hysteresis: going up is quick (moving for 2 s, or a jolt at once;
+    above 55 m/s for 5 s), going down is slow (still for 45 s; below
+    40 m/s for 20 s), so a red light or a slow taxi does not flap the
+    rate; and no two switches within MIN_DWELL_MS
+  - Battery below LOW_BATTERY caps the level at MOVING until it is back
+    above BATTERY_OK
+  - Without a fix (speed NAN: the physics task's raw speed, stale 3 s
+    after the last fix) the level is held; only an IMU jolt still wakes
+    it from STATIONARY
+  - Counts the time spent in each level and the switches
+  - No Arduino dependency: the sketch runs it in a HUD task and applies
+    the level's receiver profile (navRateProfile()), tools/replay
+    --governor runs it on a replayed track
+
+  Usage:
+    NavRateGovernor governor;
+    const NavRateGovernor::Level l = governor.update(millis(), st.fix_ms, st.raw_vel_kmh / 3.6, imu_ms2, batt);
+    if (navRateProfile(l) != profile) ...queue the profile (ubx_config.h)...
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include "ubx_valset.h"
+
+class NavRateGovernor {
+public:
+  enum Level : uint8_t { STATIONARY, MOVING, FLIGHT };
+  static const int LEVELS = 3;
+
+  // Speeds in m/s, accelerations in m/s²
+  static constexpr double STILL_SPEED = 0.5;    // below: not moving
+  static constexpr double MOVE_SPEED = 1.0;     // above for MOVE_MS: moving
+  static constexpr double STILL_MOTION = 0.3;   // IMU motion below: still
+  static constexpr double JOLT = 0.8;           // IMU motion or fix-to-fix acceleration above: moving at once
+  static constexpr double FLIGHT_SPEED = 55.0;  // above for FLIGHT_MS: flight
+  static constexpr double LANDED_SPEED = 40.0;  // below for LANDED_MS: back to moving
+  static const uint32_t MOVE_MS = 2000;
+  static const uint32_t STILL_MS = 45000;
+  static const uint32_t FLIGHT_MS = 5000;
+  static const uint32_t LANDED_MS = 20000;
+  static const uint32_t MIN_DWELL_MS = 3000;
+  static const uint32_t ACCEL_WINDOW_MS = 1000;  // fix-to-fix acceleration over at least this
+  static const int LOW_BATTERY = 15;             // %
+  static const int BATTERY_OK = 20;
+
+  struct Stats {
+    uint32_t time_ms[LEVELS];  // in each level
+    uint32_t capped_ms;        // level capped by the battery
+    uint32_t switches;
+  };
+
+  NavRateGovernor() { stats = Stats(); }
+
+  // One observation: fix_ms is the time of the latest fix (changes per
+  // fix), speed_ms its ground speed (NAN: none or stale), imu_ms2 the
+  // accelerometer's |a| - g (NAN: no IMU), battery in % (< 0: unknown).
+  // Returns the level to run at.
+  Level update(uint32_t now_ms, uint32_t fix_ms, double speed_ms, double imu_ms2, int battery) {
+    account(now_ms);
+
+    // IMU motion, smoothed (vibration when carried, ~0.05 on a desk)
+    if (!isnan(imu_ms2)) motion_ = isnan(motion_) ? fabs(imu_ms2) : motion_ + 0.2 * (fabs(imu_ms2) - motion_);
+
+    // Fix-to-fix acceleration over >= ACCEL_WINDOW_MS (the rate does not matter)
+    double accel = 0.0;
+    if (fix_ms != lastFix_) {
+      lastFix_ = fix_ms;
+      if (isnan(speed_ms)) {
+        refSpeed_ = NAN;
+      } else if (isnan(refSpeed_)) {
+        refSpeed_ = speed_ms;
+        refMs_ = fix_ms;
+      } else if (fix_ms - refMs_ >= ACCEL_WINDOW_MS) {
+        accel = fabs(speed_ms - refSpeed_) * 1000.0 / (fix_ms - refMs_);
+        refSpeed_ = speed_ms;
+        refMs_ = fix_ms;
+      }
+    }
+
+    const bool fix = !isnan(speed_ms);
+    const bool jolt = accel > JOLT || (!isnan(motion_) && motion_ > JOLT);
+    const bool still = fix && speed_ms < STILL_SPEED && !jolt && (isnan(motion_) || motion_ < STILL_MOTION);
+    const bool moving = held(moveT_, fix && speed_ms > MOVE_SPEED, now_ms, MOVE_MS);
+    const bool flight = held(flightT_, fix && speed_ms > FLIGHT_SPEED, now_ms, FLIGHT_MS);
+    const bool landed = held(landedT_, fix && speed_ms < LANDED_SPEED, now_ms, LANDED_MS);
+    const bool stopped = held(stillT_, still, now_ms, STILL_MS);
+
+    Level want = level_;
+    switch (level_) {
+      case STATIONARY:
+        if (flight) want = FLIGHT;
+        else if (moving || jolt) want = MOVING;
+        break;
+      case MOVING:
+        if (flight) want = FLIGHT;
+        else if (stopped) want = STATIONARY;
+        break;
+      case FLIGHT:
+        if (stopped) want = STATIONARY;
+        else if (landed) want = MOVING;
+        break;
+    }
+
+    if (battery >= 0) {
+      if (battery < LOW_BATTERY) lowBattery_ = true;
+      else if (battery >= BATTERY_OK) lowBattery_ = false;
+    }
+    if (lowBattery_ && want == FLIGHT) want = MOVING;
+
+    if (want != level_ && now_ms - changed_ms_ >= MIN_DWELL_MS) {
+      level_ = want;
+      changed_ms_ = now_ms;
+      ++stats.switches;
+    }
+    return level_;
+  }
+
+  Level level() const { return level_; }
+  bool batteryCapped() const { return lowBattery_; }
+
+  // Navigation rate of a level's receiver profile
+  static uint8_t hz(Level l) { return l == STATIONARY ? 2 : (l == MOVING ? 10 : 25); }
+  static const char *name(Level l) { return l == STATIONARY ? "stationary" : (l == MOVING ? "moving" : "flight"); }
+
+  Stats stats;
+
+private:
+  struct Timer {
+    bool on;
+    uint32_t since;
+  };
+
+  // True once cond has held for ms
+  static bool held(Timer &t, bool cond, uint32_t now_ms, uint32_t ms) {
+    if (!cond) {
+      t.on = false;
+      return false;
+    }
+    if (!t.on) {
+      t.on = true;
+      t.since = now_ms;
+    }
+    return now_ms - t.since >= ms;
+  }
+
+  void account(uint32_t now_ms) {
+    if (started_) {
+      const uint32_t dt = now_ms - last_ms_;
+      stats.time_ms[level_] += dt;
+      if (lowBattery_) stats.capped_ms += dt;
+    } else {
+      started_ = true;
+      changed_ms_ = now_ms;
+    }
+    last_ms_ = now_ms;
+  }
+
+  Level level_ = MOVING;
+  bool started_ = false, lowBattery_ = false;
+  uint32_t last_ms_ = 0, changed_ms_ = 0;
+  double motion_ = NAN;
+  uint32_t lastFix_ = 0, refMs_ = 0;
+  double refSpeed_ = NAN;
+  Timer moveT_ = {}, flightT_ = {}, landedT_ = {}, stillT_ = {};
+};
+
+// Receiver profile (ubx_valset.h) for a level
+inline UbxProfile navRateProfile(NavRateGovernor::Level l) {
+  switch (l) {
+    case NavRateGovernor::STATIONARY: return UbxProfile::Idle2Hz;
+    case NavRateGovernor::FLIGHT: return UbxProfile::Flight25Hz;
+    default: return UbxProfile::Moving10Hz;
+  }
+}
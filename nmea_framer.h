@@ -0,0 +1,77 @@
+#pragma once
+/*
+  nmea_framer.h  —  NMEA sentence framing between UART and parser
+  --------------------------------------------------------------
+  - NmeaFramer: byte-at-a-time state machine; '$' starts a sentence, LF
+    ends it; XOR checksum verified before the sentence is handed on
+  - NmeaIngest<N>: FrameIngest (frame_ingest.h) over NmeaFramer; whole,
+    valid sentences only reach the ring
+*/
+
+#include "frame_ingest.h"
+
+// NMEA 0183 allows 82 chars; u-blox GSV with many SVs can be longer
+static constexpr size_t NMEA_MAX_SENTENCE = 128;
+
+class NmeaFramer {
+public:
+  NmeaFramer() : len_(0), in_(false), stray_(0) {}
+
+  // Feeds one byte. Complete: frame()/length() hold "$...*hh\r\n".
+  FrameStatus push(uint8_t c) {
+    if (c == '$') {
+      // Start (or restart: a partial sentence without LF is discarded)
+      const bool restarted = in_;
+      in_ = true;
+      len_ = 0;
+      buf_[len_++] = (char)c;
+      return restarted ? FrameStatus::Overlong : FrameStatus::None;
+    }
+    if (!in_) {
+      ++stray_;
+      return FrameStatus::None;
+    }
+    if (len_ >= NMEA_MAX_SENTENCE) {
+      in_ = false;
+      return FrameStatus::Overlong;
+    }
+    buf_[len_++] = (char)c;
+    if (c != '\n') return FrameStatus::None;
+
+    in_ = false;
+    return checksumOk() ? FrameStatus::Complete : FrameStatus::BadChecksum;
+  }
+
+  const uint8_t *frame() const { return (const uint8_t *)buf_; }
+  const char *sentence() const { return buf_; }
+  size_t length() const { return len_; }
+  uint32_t stray() const { return stray_; }
+
+private:
+  static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+  }
+
+  // "$" body "*" hh "\r\n" (CR optional)
+  bool checksumOk() const {
+    size_t end = len_ - 1;                       // LF
+    if (end > 0 && buf_[end - 1] == '\r') --end;  // CR
+    if (end < 4 || buf_[end - 3] != '*') return false;
+    const int h = hexValue(buf_[end - 2]), l = hexValue(buf_[end - 1]);
+    if (h < 0 || l < 0) return false;
+    uint8_t x = 0;
+    for (size_t i = 1; i < end - 3; ++i) x ^= (uint8_t)buf_[i];
+    return x == (uint8_t)(h * 16 + l);
+  }
+
+  char buf_[NMEA_MAX_SENTENCE];
+  size_t len_;
+  bool in_;
+  uint32_t stray_;
+};
+
+template <size_t N>
+using NmeaIngest = FrameIngest<NmeaFramer, N>;
@@ -15,11 +15,15 @@
 // ============================================================================
 
 #include <M5Unified.h>
-#include <Adafruit_BMP280.h>  // BMP280 barometer
 #include <TinyGPSPlus.h>      // GNSS NMEA decoder
 #include "relativistic_clock_hud.h"
-#include "relativistic_clock_utils.h"
-#include "tinygps_hae_utils.h"
+#include "relativistic_clock_core.h"
+#include "relativistic_clock_state.h"
+#include "gnss_ingest.h"
+#include "ubx_config.h"
+#include "hud_scheduler.h"
+#include "nav_rate_governor.h"
+#include "bmp280_reader.h"
 
 // ---- Canvas instances (must match externs declared in HUD header) ----
 M5Canvas canvasBackground(&M5.Display);
@@ -41,8 +45,14 @@ M5Canvas canvasDynamicTimeDilation(&M5.Display);
 M5Canvas canvasDynamicHeader(&M5.Display);
 M5Canvas canvasDynamicLineChart(&M5.Display);
 
-// ---- Physical constants ----
-const double SPEED_OF_LIGHT = 299792458.0;  // m/s
+// Framebuffer the layers are pushed into; dirty rectangles go out by DMA
+HudCompositor hudCompositor;
+
+// ---- Modes (boot defaults; switchable from the touch menu) ----
+// Tap TIME DILATION panel : cycle GR mode 0 → 1 → 2
+// Hold TIME DILATION panel: toggle location simulation
+// Tap altitude gauge      : toggle barometric / HAE altitude
+// Hold header             : next receiver profile (automatic → static 1 Hz → idle 2 Hz → ... → flight 25 Hz → automatic)
 const bool HAE_MODE = false;
 
 
@@ -57,128 +67,256 @@ const bool SIM_MODE = false;  // false = disable simulation
 const double SIM_LAT = 0;   // dec
 const double SIM_ALT = 0;    // m
 
+// --- GNSS protocol ---
+// true  = binary UBX-NAV-PVT (lat/lon, HAE, velocity, time; ~1/3 the UART bytes)
+// false = NMEA through TinyGPSPlus (+ GGA geoid separation for HAE)
+const bool UBX_MODE = true;
+
+// --- Receiver profile (one CFG-VALSET, read back with CFG-VALGET) ---
+// true  = automatic: 2 Hz still, 10 Hz moving, 25 Hz in flight (nav_rate_governor.h)
+// false = GNSS_PROFILE: Static1Hz (stationary model), Idle2Hz, Moving10Hz,
+//         Portable25Hz, Flight25Hz (airborne < 1 g model)
+const bool NAV_RATE_GOVERNOR = true;
+const UbxProfile GNSS_PROFILE = UbxProfile::Portable25Hz;
+// UBX_LAYER_RAM: until power-off; | UBX_LAYER_BBR | UBX_LAYER_FLASH to keep it
+const uint8_t GNSS_CONFIG_LAYERS = UBX_LAYER_RAM;
+
+// --- Barometer (BMP280 converting continuously, read once per sample) ---
+// Precise:  x16 pressure / x2 temperature, IIR 16, ~23 Hz
+// Dynamic:  x4 / x1, IIR 16, ~72 Hz (least lag, more noise)
+// LowPower: x16 / x2, IIR 4, ~9 Hz
+const Bmp280Profile BARO_PROFILE = Bmp280Profile::Precise;
+
+// --- Physics arithmetic ---
+// true  = DoubleFloat path on the float FPU (calcTimeDilationDF)
+// false = double path (software-emulated on the ESP32-S3)
+const bool DF_PHYSICS = true;
+const bool PHYSICS_CYCLE_REPORT = false;   // print cycles/call of both paths on Serial at boot
+const bool PIPELINE_STATS_REPORT = false;  // print stage, offset and GNSS ingest stats (physics task) and barometer stats (HUD) every 10 s
+const bool SCHEDULER_REPORT = false;       // print achieved vs. target rates, frame overruns, HUD flush stats every 10 s
+const bool BOOT_REPORT = false;            // print the receiver configuration (boot, profile switch) and the first fix on screen (a failure always)
+const bool GOVERNOR_REPORT = false;        // print the nav rate, its switches and the time at each rate every 10 s
+const bool BARO_RAW_LOG = false;           // print the barometer calibration and every raw sample on Serial (tools/baro_bench input)
+
+// ---- GNSS parsing, raw/UI values, physics pipeline and session clock offset ----
+// (same code as tools/replay; after setup() only the physics task touches it)
+ClockCore<UBX_MODE, DF_PHYSICS> core;
+static uint32_t tStats = 0;
+
 // ---- Sensor objects ----
-Adafruit_BMP280 barometer(&Wire1);
-TinyGPSPlus gps;
-TinyGPSHaeHelper hae(gps);
+// The BMP280 sits on the internal I2C bus (G12 / G11) with the touch
+// controller, the PMU and the IMU. M5Unified drives that bus as
+// M5.In_I2C, so the barometer goes through the same driver, from the same
+// task (loop(), core 1): one owner, no second driver on the pins
+class InI2cWire {  // the TwoWire calls Bmp280Reader makes, on M5.In_I2C
+public:
+  static const uint32_t FREQ = 400000;
+
+  void beginTransmission(uint8_t addr) {
+    addr_ = addr;
+    txLen_ = 0;
+  }
+  size_t write(uint8_t b) {
+    if (txLen_ >= sizeof(tx_)) return 0;
+    tx_[txLen_++] = b;
+    return 1;
+  }
+  // Without a stop the register address waits for requestFrom()'s
+  // repeated start (M5.In_I2C.readRegister)
+  uint8_t endTransmission(bool stop = true) {
+    if (!stop || !txLen_) return 0;
+    return M5.In_I2C.writeRegister(addr_, tx_[0], tx_ + 1, txLen_ - 1, FREQ) ? 0 : 4;
+  }
+  uint8_t requestFrom(uint8_t addr, uint8_t n) {
+    rxLen_ = rxPos_ = 0;
+    if (!txLen_ || n > sizeof(rx_) || !M5.In_I2C.readRegister(addr, tx_[0], rx_, n, FREQ)) return 0;
+    rxLen_ = n;
+    return n;
+  }
+  int read() { return rxPos_ < rxLen_ ? rx_[rxPos_++] : -1; }
+
+private:
+  uint8_t addr_ = 0, tx_[8], rx_[32];
+  uint8_t txLen_ = 0, rxLen_ = 0, rxPos_ = 0;
+};
+InI2cWire inI2cWire;
+Bmp280Reader<InI2cWire> barometer;
+static uint64_t baroReadUsTotal = 0;  // read + altitude, HUD task
+static uint32_t baroReadUsMax = 0;
+SeqlockSnapshot<BaroReading> baroReading;  // HUD task (bus owner) → physics
+static uint32_t baroSeen = 0;              // physics task: last reading taken
 HardwareSerial GNSSSerial(1);  // UART1 for GNSS
 
+// ---- Receiver configuration (ACK-checked, read back; runs in the ingest task) ----
+UbxConfigurator<HardwareSerial> gnssConfig;
+static bool gnssConfigReported = false, gnssFault = false;
+static uint32_t firstFixShownMs = 0;  // millis() when the first fix was drawn
+static UbxProfile gnssProfile = GNSS_PROFILE;
+static bool gnssAuto = NAV_RATE_GOVERNOR;  // the governor picks the profile
+NavRateGovernor navRateGovernor;
+
+// ---- GNSS ingest ring (UBX frames or NMEA sentences) ----
+typedef std::conditional<UBX_MODE, UbxIngest<GNSS_INGEST_RING>, NmeaIngest<GNSS_INGEST_RING>>::type GnssIngest;
+GnssIngest gnssIngest;
+
+// ---- Core split: ingest + physics task on core 0, HUD (loop()) on core 1 ----
+SeqlockSnapshot<ClockState> clockState;       // physics → HUD, every physics pass
+SeqlockSnapshot<ClockMode> clockModeRequest;  // touch menu → physics
+ClockProducer<ClockCore<UBX_MODE, DF_PHYSICS>, GnssIngest> clockProducer(core, gnssIngest, clockState, clockModeRequest);
+static TaskHandle_t clockTask = nullptr, hudTask = nullptr;
+static ClockMode hudMode;  // as the touch menu last set it
 
+// ---- Status ----
+int g_batt = -1;
 
-// ---- Earth rotation tangential speed (m/s) at given lat/alt ----
-double calcEarthRotationSpeed(double latitude_deg, double altitude_m) {
-  const double a = 6378137.0;       // WGS-84 semi-major axis
-  const double b = 6356752.314245;  // WGS-84 semi-minor axis
-  const double phi = radians(latitude_deg);
-  const double s = sin(phi), c = cos(phi);
-  const double e2 = (a * a - b * b) / (a * a);
-  const double N = a / sqrt(1.0 - e2 * s * s);
-  const double r = (N + altitude_m) * c;
-  return 7.292115e-5 * r;  // ω·r
-}
-
-double calcLocalGravity(double latitude_deg, double altitude_m) {
-  // Optional clamp to avoid absurd inputs (e.g., bad readings)
-  if (altitude_m < -500.0) altitude_m = -500.0;
-  if (altitude_m > 20000.0) altitude_m = 20000.0;
+// ---- Frame scheduler: refresh policy per widget (replaces a fixed 16 ms frame) ----
+// Events: a new GNSS fix, a new barometer reading, a mode switch
+enum : uint32_t { EV_FIX = 1, EV_BARO = 2, EV_MODE = 4 };
+HudScheduler hudScheduler(16);  // frame budget, ms
+static const int taskInput = hudScheduler.add("touch", 20);
+static const int taskAltitude = hudScheduler.add("altitude", 33);  // smoothed azimuth arc
+static const int taskLatitude = hudScheduler.add("latitude", 0, EV_FIX | EV_MODE);
+static const int taskVelocity = hudScheduler.add("velocity", 0, EV_FIX | EV_MODE);
+static const int taskTotalVelocity = hudScheduler.add("total velocity", 0, EV_FIX | EV_MODE);
+static const int taskGravity = hudScheduler.add("local gravity", 0, EV_FIX | EV_BARO | EV_MODE);
+static const int taskDilation = hudScheduler.add("time dilation", 100);
+static const int taskChart = hudScheduler.add("line chart", 1000, EV_FIX | EV_MODE);  // GNSS rate, 1 Hz without fix
+static const int taskHeader = hudScheduler.add("header", 200);
+static const int taskBattery = hudScheduler.add("battery", 1000);
+static const int taskBarometer = hudScheduler.add("barometer", bmp280PeriodMs(BARO_PROFILE));  // one per sample
+static const int taskGovernor = hudScheduler.add("rate governor", 100);
+static const int taskReport = hudScheduler.add("report", 10000);
+static uint32_t seenFixes = 0, seenBaro = 0;  // ClockState counters at the last pass
+
+// ---- Dilation chart history (tap the chart to zoom) ----
+DilationHistory dilationHistory;
+static int chartLevel = -1;  // -1: last 160 fixes; 0..3: 1 s / 10 s / 1 min / 10 min per column
 
-  const double phi = radians(latitude_deg);
-  const double s = sin(phi);
-  const double sin2 = s * s;
+// ---- Sea Level Pressure (configurable) ----
+static float slp_hPa = 1013.25f;
 
-  // Classic WGS84 constants
-  const double ge = 9.7803253359;  // m/s²
-  const double k = 0.00193185265241;
-  const double e2 = 0.00669437999013;
 
-  const double g0 = ge * (1.0 + k * sin2) / sqrt(1.0 - e2 * sin2);
 
-  // Linear free-air correction (~0.3086 mGal/m = 3.086e-6 m/s² per meter)
-  return g0 - 3.086e-6 * altitude_m;
-}
+// ---------------------- Physics cycle report ----------------------
+// Average CPU cycles per call of each path over a fixed set of fixes.
+static void reportPhysicsCycles() {
+  const int N = 256;
+  double g, vRot, vTot;
+  volatile double sink = 0.0;
 
+  for (int grMode = 0; grMode <= 2; ++grMode) {
+    uint32_t c0 = ESP.getCycleCount();
+    for (int i = 0; i < N; ++i) {
+      sink = sink + calcTimeDilation(i * 11.7, i * 1.41, -90.0 + i * 0.7, -500.0 + i * 80.0, g, vRot, vTot, grMode);
+    }
+    const uint32_t cDouble = ESP.getCycleCount() - c0;
 
-// ---- Time dilation (returns ns/s). Horizontal ground speed only. ----
-double calcTimeDilation(double velocity_kmh, double azimuth_deg, double latitude_deg, double altitude_m,
-                        double &out_gravity, double &out_earthRotationSpeed, double &out_relativeVelocity) {
-  // Convert to m/s
-  const double v = velocity_kmh / 3.6;
+    c0 = ESP.getCycleCount();
+    for (int i = 0; i < N; ++i) {
+      sink = sink + calcTimeDilationDF(i * 11.7, i * 1.41, -90.0 + i * 0.7, -500.0 + i * 80.0, g, vRot, vTot, grMode);
+    }
+    const uint32_t cDF = ESP.getCycleCount() - c0;
 
-  if (SIM_MODE) {
-    latitude_deg = SIM_LAT;
-    altitude_m = SIM_ALT;
+    Serial.printf("GR %d: double %lu cycles/call, DoubleFloat %lu cycles/call\n",
+                  grMode, (unsigned long)(cDouble / N), (unsigned long)(cDF / N));
   }
+}
 
-  // Horizontal components (0° = North, 90° = East)
-  const double vE = v * sin(radians(azimuth_deg));  // East (+)
-  const double vN = v * cos(radians(azimuth_deg));  // North (+)
-
-  // Earth rotation at location (Eastward)
-  const double vRot = calcEarthRotationSpeed(latitude_deg, altitude_m);
-  out_earthRotationSpeed = vRot;
-
-  // Total inertial-frame speed (rotation + own motion)
-  const double vTot = sqrt((vRot + vE) * (vRot + vE) + vN * vN);
-  out_relativeVelocity = vTot;
-
-  // Local gravity
-  const double g = calcLocalGravity(latitude_deg, altitude_m);
-  out_gravity = g;
-
-  // SR: slows clock (negative)
-  const double deltaSR = -(vTot * vTot) / (2.0 * SPEED_OF_LIGHT * SPEED_OF_LIGHT);
-
-  // GR: General Relativity
-  double deltaGR = 0.0;
+// ---------------------- Mode switching ----------------------
+static void setClockMode(const ClockMode &m) {
+  if (m == hudMode) return;
+  hudMode = m;
+  clockModeRequest.publish(m);  // the physics task switches on its next pass
+  hudScheduler.signal(EV_MODE);
+}
 
-  if (GR_MODE == 0) {
-    // Local GR WITHOUT centrifugal: g_pure ≈ GM / r0^2
-    const double r0 = geocentric_radius_m(latitude_deg, 0.0);
-    const double g_pure = GM_EARTH / (r0 * r0);
-    deltaGR = (g_pure * altitude_m) / (SPEED_OF_LIGHT * SPEED_OF_LIGHT);
+// Receiver profile: queued here, sent by the ingest task (ignored while a
+// configuration is still running)
+static void setGnssProfile(UbxProfile p) {
+  if (!gnssConfig.finished()) return;
+  gnssConfig.clear();
+  if (!ubxQueueProfile(gnssConfig, p, 460800, UBX_MODE, GNSS_CONFIG_LAYERS)) return;
+  gnssProfile = p;
+  gnssConfigReported = false;
+  gnssConfig.start();
+}
 
+// Header hold: automatic → each profile in turn → automatic
+static void nextGnssProfile() {
+  if (gnssAuto) {
+    gnssAuto = false;
+    setGnssProfile(UbxProfile::Static1Hz);
+  } else if (NAV_RATE_GOVERNOR && gnssProfile == UbxProfile::Flight25Hz) {
+    gnssAuto = true;  // the governor's next tick applies its level
   } else {
-    // Absolute modes: use ONLY the gravitational potential (no centrifugal term)
-    const double r = geocentric_radius_m(latitude_deg, altitude_m);
-    const double Phi_here = -GM_EARTH / r;
-
-    if (GR_MODE == 1) {
-      // (1) Absolute WITH reference (e.g., Equator, 0 m)
-      const double r0 = geocentric_radius_m(0.0, 0.0);
-      const double Phi_ref = -GM_EARTH / r0;
-      deltaGR = (Phi_here - Phi_ref) / (SPEED_OF_LIGHT * SPEED_OF_LIGHT);
-
-    } else {  // GR_MODE == 2
-      // (2) Absolute WITHOUT reference (raw value)
-      deltaGR = (Phi_here) / (SPEED_OF_LIGHT * SPEED_OF_LIGHT);
-    }
+    setGnssProfile(nextUbxProfile(gnssProfile));
   }
-
-
-  // Net (ns per second)
-  return (deltaSR + deltaGR) * 1e9;
 }
 
-// ---- Raw (for physics; no smoothing) ----
-double raw_lat = NAN, raw_lon = NAN;
-double raw_vel_kmh = NAN, raw_az_deg = NAN;
-double raw_alt_m = NAN;
-
-// ---- UI-smoothed (for gauges only) ----
-double ui_vel_kmh = 0.0, ui_az_deg = NAN;
+static bool touchIn(const m5::touch_detail_t &t, int x, int y, int w, int h) {
+  return t.x >= x && t.x < x + w && t.y >= y && t.y < y + h;
+}
 
-// ---- Status ----
-double g_hdop = NAN;
-int g_sats = 0;
-int g_batt = -1;
+// Touch menu: hit areas are the panels' screen rectangles
+static void handleTouch() {
+  if (M5.Touch.getCount() == 0) return;
+  const auto t = M5.Touch.getDetail();
+  ClockMode m = hudMode;
+
+  if (touchIn(t, 5, 165, 145, 70)) {  // TIME DILATION panel
+    if (t.wasClicked()) m.gr = nextGrMode(m.gr);
+    if (t.wasHold()) m.sim = !m.sim;
+  } else if (touchIn(t, 215, 100, 90, 90) && t.wasClicked()) {  // altitude gauge
+    m.alt = (m.alt == AltSource::Hae) ? AltSource::Baro : AltSource::Hae;
+  } else if (touchIn(t, 155, 195, 160, 40) && t.wasClicked()) {  // dilation chart: zoom out, wrap to live
+    chartLevel = (chartLevel + 1 < DilationHistory::LEVELS) ? chartLevel + 1 : -1;
+    hudScheduler.signal(EV_MODE);
+  } else if (touchIn(t, 140, 0, 180, 25) && t.wasHold()) {  // header
+    nextGnssProfile();
+  }
+  setClockMode(m);
+}
 
-// ---- Header refresh throttle ----
-static uint32_t tHeader = 0;
+// ---------------------- Physics task (core 0) ----------------------
+static void reportPipeline() {
+  const PipelineStats &st = core.physics.stats;
+  Serial.printf("position eval %lu skip %lu | motion eval %lu skip %lu\n",
+                (unsigned long)st.position_evals, (unsigned long)st.position_skips,
+                (unsigned long)st.motion_evals, (unsigned long)st.motion_skips);
+  Serial.printf("gnss frames %lu dropped %lu bad %lu overlong %lu | uart errors %lu\n",
+                (unsigned long)gnssIngest.stats.frames.load(), (unsigned long)gnssIngest.stats.dropped.load(),
+                (unsigned long)gnssIngest.stats.bad_sum.load(), (unsigned long)gnssIngest.stats.overlong.load(),
+                (unsigned long)gnssUartErrors.load());
+  Serial.printf("offset %.6f ns over %.1f s | ns/h min %.6f max %.6f mean %.6f\n",
+                core.offset.offset_ns(), core.offset.elapsed_s(),
+                core.offset.min_ns_per_s() * 3600.0, core.offset.max_ns_per_s() * 3600.0,
+                core.offset.mean_ns_per_s() * 3600.0);
+}
 
-// ---- Sea Level Pressure (configurable) ----
-static float slp_hPa = 1013.25f;
+// The barometer's latest reading (read by the HUD task), once; NAN if
+// there is none since the last call
+static double takeBarometer() {
+  if (baroReading.version() == baroSeen) return NAN;
+  BaroReading b;
+  baroSeen = baroReading.read(b);
+  return b.alt_m;
+}
 
+// GNSS frames, barometer, smoothing and physics; publishes a ClockState
+// every pass and wakes the HUD on a new fix. Woken by the ingest task.
+static void clockTaskMain(void *) {
+  for (;;) {
+    const uint32_t now = millis();
+    if (clockProducer.pass(now, takeBarometer)) xTaskNotifyGive(hudTask);
 
+    if (PIPELINE_STATS_REPORT && now - tStats >= 10000) {
+      reportPipeline();
+      tStats = now;
+    }
+    const uint32_t wait = clockProducer.sleepMs(millis());
+    if (wait) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
+  }
+}
 
 // ---------------------- Setup ----------------------
 void setup() {
@@ -186,24 +324,51 @@ void setup() {
   M5.begin(cfg);
   M5.Power.setExtPower(true);  // power Grove port
 
-  Wire1.begin(12, 11, 400000);  // I2C for GNSS/BMP module
-
-  // BMP280 (default I2C address 0x76)
-  if (!barometer.begin(0x76)) {
+  // BMP280 (default I2C address 0x76) on M5.In_I2C (M5.begin() set it
+  // up), converting continuously; loop() reads it once per sample period
+  if (!barometer.begin(inI2cWire, 0x76, BARO_PROFILE)) {
     M5.Display.setCursor(10, 10);
     M5.Display.setTextColor(RED);
     M5.Display.println("ERRO: BMP280 NAO ENCONTRADO!");
     while (1) {}
   }
+  clockProducer.setBaroPeriod(barometer.periodMs());
+  if (BARO_RAW_LOG) {
+    const Bmp280Calib &c = barometer.calib();
+    Serial.printf("# bmp280 calib %d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", c.T1, c.T2, c.T3, c.P1, c.P2, c.P3, c.P4,
+                  c.P5, c.P6, c.P7, c.P8, c.P9);
+  }
 
   // GNSS (NEO-M9N) on UART1 (GPIO 18 RX, 17 TX)
+  GNSSSerial.setRxBufferSize(GNSS_UART_RX_BUFFER);
   GNSSSerial.begin(460800, SERIAL_8N1, 18, 17);
-  delay(200);
 
-  // 25 Hz navigation; GSA/GSV at 1 Hz
-  initUblox25Hz_reduceGSV_GSA(GNSSSerial, 460800, false);
-
-  // HUD static layers
+  // Receiver profile (the governor's boot level, 10 Hz, or GNSS_PROFILE).
+  // Queued here, sent, ACK-checked and read back by the ingest task while
+  // the HUD is set up below
+  if (gnssAuto) gnssProfile = navRateProfile(navRateGovernor.level());
+  gnssConfig.begin(GNSSSerial, 460800);
+  ubxQueueProfile(gnssConfig, gnssProfile, 460800, UBX_MODE, GNSS_CONFIG_LAYERS);
+  gnssConfig.start();
+
+  core.setSimLocation(SIM_LAT, SIM_ALT);
+  hudMode = { (GrMode)GR_MODE, HAE_MODE ? AltSource::Hae : AltSource::Baro, SIM_MODE };
+  core.setMode(hudMode);
+
+  if (PHYSICS_CYCLE_REPORT) reportPhysicsCycles();
+
+  // Core 0: physics task, woken by the ingest task whenever whole frames
+  // were queued (from here on only the ingest task reads and writes
+  // GNSSSerial, configuration first, and only the physics task touches
+  // core).
+  // Core 1: this task (loop()) draws the HUD from clockState snapshots
+  // and is the only one on the I2C bus (touch, PMU, IMU, barometer)
+  hudTask = xTaskGetCurrentTaskHandle();
+  xTaskCreatePinnedToCore(clockTaskMain, "clock", 8192, nullptr, 4, &clockTask, 0);
+  startGnssIngest(GNSSSerial, gnssIngest, clockTask, &gnssConfig);
+
+  // HUD static layers (into the compositor's framebuffer)
+  hudCompositor.begin(M5.Display);
   drawBackground();
   drawStaticHeader();
   drawStaticLineChart();
@@ -214,109 +379,153 @@ void setup() {
   drawStaticAltitude();
   drawStaticLatitude();
   createDynamicCanvases();
-
-  delay(500);
+  hudCompositor.flush();
 }
 
-// ---------------------- Main loop ----------------------
-void loop() {
-  M5.update();
-
-  // GNSS ingest (non-blocking)
-  while (GNSSSerial.available() > 0) {
-    gps.encode(GNSSSerial.read());
+// ---------------------- Boot report ----------------------
+// Receiver configuration result, once the ingest task has finished it
+static void reportGnssConfig() {
+  Serial.printf("gnss config %s %s in %lu ms (done at %lu ms), %lu retries, %lu baud\n",
+                ubxProfileName(gnssProfile), gnssConfig.failed() ? "FAILED" : "ok", (unsigned long)gnssConfig.elapsedMs(),
+                (unsigned long)gnssConfig.doneMs(), (unsigned long)gnssConfig.retries(),
+                (unsigned long)gnssConfig.baud());
+  for (int i = 0; i < gnssConfig.count(); ++i) {
+    const UbxCommand &c = gnssConfig.command(i);
+    Serial.printf("  %-18s %-8s attempts %u answer %u ms\n", c.name, ubxCmdStatusName(c.status),
+                  (unsigned)c.attempts, (unsigned)c.answer_ms);
   }
-  const bool gpsOK = gps.location.isUpdated() && gps.speed.isUpdated() && gps.course.isUpdated();
-
-  // Freshness: invalidate stale readings
-  const unsigned long ageLoc = gps.location.age();
-  const unsigned long ageSpd = gps.speed.age();
-  const unsigned long ageCrs = gps.course.age();
-
-  if (ageLoc > 3000) {
-    raw_lat = NAN;
-    raw_lon = NAN;
-  }  // >3 s
-  if (ageSpd > 3000) { raw_vel_kmh = NAN; }
-  if (ageCrs > 3000) { raw_az_deg = NAN; }
-
-  g_sats = (gps.satellites.isValid() && gps.satellites.age() < 5000)
-             ? (int)gps.satellites.value()
-             : 0;
-
-  g_hdop = (gps.hdop.isValid() && gps.hdop.age() < 5000)
-             ? gps.hdop.hdop()
-             : NAN;
-
-  // Current GNSS values (may be invalid)
-  const double lat_now = gps.location.isValid() ? gps.location.lat() : NAN;
-  const double lon_now = gps.location.isValid() ? gps.location.lng() : NAN;
-  const double vel_now = gps.speed.isValid() ? gps.speed.kmph() : NAN;
-  const double az_now = gps.course.isValid() ? gps.course.deg() : NAN;
-
-  // Raw for physics (keep last valid)
-  raw_lat = keepOr(raw_lat, lat_now);
-  raw_lon = keepOr(raw_lon, lon_now);
-  raw_vel_kmh = keepOr(raw_vel_kmh, vel_now);
-  raw_az_deg = keepOr(raw_az_deg, az_now);
-
-
-  //HAE Mode
-  if (HAE_MODE) {
-    hae.update();  // Update N cache
-    double hae_m = hae.getHAE_m(5000);
-    const double alt_now = hae_m;
-    if (!isnan(alt_now) && isfinite(alt_now)) {
-      raw_alt_m = alt_now;  // raw for physics
-    }
-  } else {
-    // Barometric altitude (m) using current SLP
-    const double alt_now = barometer.readAltitude(slp_hPa);
-    if (!isnan(alt_now) && isfinite(alt_now)) {
-      raw_alt_m = alt_now;  // raw for physics
-    }
+}
+
+// ---------------------- Scheduler report ----------------------
+static void reportScheduler() {
+  const uint32_t now = millis();
+  const HudScheduler::Stats &st = hudScheduler.stats;
+  Serial.printf("passes %lu | work mean %lu us max %lu us | over %lu ms budget %lu | sleeps %lu woken by GNSS %lu\n",
+                (unsigned long)st.passes, (unsigned long)(st.passes ? st.work_us / st.passes : 0),
+                (unsigned long)st.max_work_us, (unsigned long)hudScheduler.budgetMs(), (unsigned long)st.overruns,
+                (unsigned long)st.sleeps, (unsigned long)st.woken);
+  for (int i = 0; i < hudScheduler.count(); ++i) {
+    const HudScheduler::Task &t = hudScheduler.task(i);
+    Serial.printf("  %-15s %6.1f / %6.1f Hz | runs %lu late %lu max late %lu ms\n", t.name,
+                  hudScheduler.achievedHz(i, now), hudScheduler.targetHz(i, now),
+                  (unsigned long)t.runs, (unsigned long)t.late, (unsigned long)t.max_late_ms);
   }
+  hudScheduler.resetWindow(now);
+  const HudCompositor::Stats &hs = hudCompositor.stats;
+  Serial.printf("hud flush %lu frames | %lu windows %lu dma | %llu px marked %llu px sent\n",
+                (unsigned long)hs.frames, (unsigned long)hs.rects, (unsigned long)hs.chunks,
+                (unsigned long long)hs.marked, (unsigned long long)hs.pixels);
+}
 
-  // UI smoothing (visual only)
-  if (!isnan(raw_vel_kmh)) ui_vel_kmh = lpf(ui_vel_kmh, raw_vel_kmh, 0.12f);
-  if (!isnan(raw_az_deg)) ui_az_deg = smooth_heading_deg(ui_az_deg, raw_az_deg, 0.10f);
+// ---------------------- Barometer (HUD task, I2C owner) ----------------------
+// One sample (a 6-byte burst) as altitude, handed to the physics task
+static void readBarometer() {
+  const uint32_t t0 = micros();
+  const bool ok = barometer.read();
+  const BaroReading r = { ok ? (double)barometer.altitudeM(slp_hPa) : NAN };
+  const uint32_t us = micros() - t0;
+  baroReadUsTotal += us;
+  if (us > baroReadUsMax) baroReadUsMax = us;
+  if (!ok) return;  // bus error: the physics task keeps the last altitude
+  baroReading.publish(r);
+  if (BARO_RAW_LOG)
+    Serial.printf("%lu,%ld,%ld\n", (unsigned long)millis(), (long)barometer.rawTemperature(), (long)barometer.rawPressure());
+}
 
-  // Physics use raw values only (replace NaNs with zeros)
-  const double lat_calc = isnan(raw_lat) ? 0.0 : raw_lat;
-  const double alt_calc = isnan(raw_alt_m) ? 0.0 : raw_alt_m;
-  const double vel_calc = isnan(raw_vel_kmh) ? 0.0 : raw_vel_kmh;
-  const double az_calc = isnan(raw_az_deg) ? 0.0 : raw_az_deg;
+static void reportBarometer() {
+  const Bmp280Reader<InI2cWire>::Stats &b = barometer.stats;
+  Serial.printf("baro %s every %lu ms: reads %lu unchanged %lu errors %lu | %.0f us/read, max %lu us\n",
+                bmp280ProfileName(barometer.profile()), (unsigned long)barometer.periodMs(), (unsigned long)b.reads,
+                (unsigned long)b.unchanged, (unsigned long)b.errors,
+                b.reads ? (double)baroReadUsTotal / b.reads : 0.0, (unsigned long)baroReadUsMax);
+}
 
-  double local_gravity = 0.0;         // m/s² (output)
-  double earth_rotation_speed = 0.0;  // m/s  (output)
-  double relative_velocity = 0.0;     // m/s  (output)
+// ---------------------- Nav rate governor ----------------------
+// Motion the IMU (BMI270) sees: | |a| - 1 g |, m/s² (NAN: no IMU)
+static double readImuMotion() {
+  float ax, ay, az;
+  if (!M5.Imu.isEnabled() || !M5.Imu.update() || !M5.Imu.getAccel(&ax, &ay, &az)) return NAN;
+  return fabs(sqrt(ax * ax + ay * ay + az * az) - 1.0) * 9.80665;
+}
 
-  const double delta_ns_per_second = calcTimeDilation(
-    vel_calc, az_calc, lat_calc, alt_calc,
-    local_gravity, earth_rotation_speed, relative_velocity);
+static void reportGovernor() {
+  const NavRateGovernor::Stats &gs = navRateGovernor.stats;
+  Serial.printf("nav rate %s %s | %lu switches | battery cap %lu s\n", gnssAuto ? "auto" : "manual",
+                ubxProfileName(gnssProfile), (unsigned long)gs.switches, (unsigned long)(gs.capped_ms / 1000));
+  for (int l = 0; l < NavRateGovernor::LEVELS; ++l) {
+    const NavRateGovernor::Level lv = (NavRateGovernor::Level)l;
+    Serial.printf("  %2u Hz %-10s %lu s\n", NavRateGovernor::hz(lv), NavRateGovernor::name(lv),
+                  (unsigned long)(gs.time_ms[l] / 1000));
+  }
+}
 
-  const double delta_ns_per_hour = delta_ns_per_second * 3600.0;
+// ---------------------- Main loop (HUD, core 1) ----------------------
+void loop() {
+  hudScheduler.beginPass(micros());
+  const uint32_t now = millis();
 
-  // HUD dynamic layers
-  if (gpsOK) {
-    drawDynamicAltitude(alt_calc, ui_az_deg);
-  } else {
-    drawDynamicAltitude(alt_calc, -1);
+  if (hudScheduler.due(taskInput, now)) {
+    M5.update();
+    handleTouch();
   }
-  drawDynamicLatitude(lat_calc);
-  drawDynamicVelocity(earth_rotation_speed * 3.6);    // km/h
-  drawDynamicTotalVelocity(relative_velocity * 3.6);  // km/h
-  drawDynamicLocalGravity(local_gravity);
-  drawDynamicTimeDilation(delta_ns_per_hour);
-  drawDynamicLineChart(delta_ns_per_hour);
-
-  // Header refresh (~200 ms)
-  if (millis() - tHeader >= 200) {
-    g_batt = M5.Power.getBatteryLevel();
-    drawDynamicHeader(isnan(g_hdop) ? -1.0 : g_hdop, g_batt, g_sats);
-    tHeader = millis();
+  if (hudScheduler.due(taskBarometer, now)) readBarometer();
+
+  // Latest physics pass; new fixes / barometer readings are redraw events
+  ClockState st;
+  clockState.read(st);
+  if (st.fixes != seenFixes) hudScheduler.signal(EV_FIX);
+  if (st.baro_reads != seenBaro) hudScheduler.signal(EV_BARO);
+  seenFixes = st.fixes;
+  seenBaro = st.baro_reads;
+
+  // Receiver configuration finished: a failure is always reported
+  if (!gnssConfigReported && gnssConfig.finished()) {
+    gnssConfigReported = true;
+    gnssFault = gnssConfig.failed();
+    if (gnssFault || BOOT_REPORT) reportGnssConfig();
+  }
+
+  // HUD dynamic layers, each at its own rate
+  if (hudScheduler.due(taskAltitude, now)) {
+    if (st.fixes && (int32_t)(now - st.fix_ms) < 2500) {  // azimuth arc while fixes arrive (1 Hz profiles too)
+      drawDynamicAltitude(st.alt_m, st.ui_az_deg);
+    } else {
+      drawDynamicAltitude(st.alt_m, -1);
+    }
+  }
+  if (hudScheduler.due(taskLatitude, now)) {
+    drawDynamicLatitude(st.lat_deg);
+    if (st.fixes && !firstFixShownMs) {
+      firstFixShownMs = millis();
+      if (BOOT_REPORT) Serial.printf("first fix on screen %lu ms after boot\n", (unsigned long)firstFixShownMs);
+    }
+  }
+  if (hudScheduler.due(taskVelocity, now)) drawDynamicVelocity(st.vRot * 3.6);             // km/h
+  if (hudScheduler.due(taskTotalVelocity, now)) drawDynamicTotalVelocity(st.vTot * 3.6);  // km/h
+  if (hudScheduler.due(taskGravity, now)) drawDynamicLocalGravity(st.gravity);
+  if (hudScheduler.due(taskDilation, now)) drawDynamicTimeDilation(st.ns_per_h, st.offset_ns);
+  if (hudScheduler.due(taskChart, now)) {
+    dilationHistory.add(now, st.ns_per_h);  // one point per fix
+    drawDynamicLineChart(st.ns_per_h, &dilationHistory, chartLevel);
+  }
+  if (hudScheduler.due(taskBattery, now)) g_batt = M5.Power.getBatteryLevel();
+  if (hudScheduler.due(taskGovernor, now) && gnssAuto) {
+    const NavRateGovernor::Level l = navRateGovernor.update(now, st.fix_ms, st.raw_vel_kmh / 3.6, readImuMotion(), g_batt);
+    if (navRateProfile(l) != gnssProfile) setGnssProfile(navRateProfile(l));  // retried while a configuration runs
+  }
+  if (hudScheduler.due(taskHeader, now)) drawDynamicHeader(isnan(st.hdop) ? -1.0 : st.hdop, g_batt, st.sats, gnssFault);
+
+  // Everything drawn this pass goes out together
+  hudCompositor.flush();
+
+  if (hudScheduler.due(taskReport, now)) {
+    if (SCHEDULER_REPORT) reportScheduler();
+    if (PIPELINE_STATS_REPORT) reportBarometer();
+    if (GOVERNOR_REPORT) reportGovernor();
   }
+  hudScheduler.endPass(micros());
 
-  // UI cadence ~60 Hz
-  delay(16);
+  // Sleep until the next deadline, or until the physics task has a new fix
+  const uint32_t wait = hudScheduler.sleepMs(millis());
+  if (wait) hudScheduler.slept(ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait)) != 0);
 }
@@ -0,0 +1,256 @@
+#pragma once
+/*
+  relativistic_clock_core.h  —  The path between GNSS ingest and HUD
+  -----------------------------------------------------------------
+  - Everything the physics task (relativistic_clock_state.h) does with the
+    sensor data, without M5/HUD code:
+      gnss:     parse whole frames from the ingest ring (UBX NAV-PVT, or
+                NMEA through TinyGPSPlus), freshness, satellites, HAE
+      baro:     raw barometric altitude
+      smooth:   UI speed / heading (lpf, smooth_heading_deg)
+      evaluate: physics pipeline and session clock offset
+  - The sketch and tools/replay run this same code; the replay builds it
+    against the host Arduino.h in tools/host (virtual millis())
+  - Stages are separate calls, so the replay can time each one
+
+  Usage:
+    ClockCore<UBX_MODE, DF_PHYSICS> core;
+    core.setSimLocation(lat, alt);  core.setMode(mode);
+    // each physics pass (ClockProducer::pass):
+    core.beginFrame();
+    while ((n = ingest.consume(buf, sizeof(buf))) > 0) core.feedGnss(buf, n);
+    core.endGnss();
+    if (core.wantsBaro() && barometer.read()) core.setBaroAltitude(barometer.altitudeM(slp));
+    core.smooth();
+    core.evaluate();  // core.physics.result, core.offset
+*/
+
+#include "Arduino.h"
+#include <TinyGPSPlus.h>
+#include "tinygps_hae_utils.h"
+#include "ubx_decoder.h"
+#include "relativistic_clock_utils.h"
+#include "relativistic_clock_pipeline.h"
+#include "relativistic_clock_offset.h"
+
+template <bool UbxMode, bool DF>
+struct ClockCore {
+  // ---- Parsers ----
+  TinyGPSPlus gps;
+  TinyGPSHaeHelper hae;  // after gps
+  UbxDecoder ubx;
+
+  // ---- Raw (for physics; no smoothing) ----
+  double raw_lat, raw_lon;
+  double raw_vel_kmh, raw_az_deg;
+  double raw_alt_baro_m, raw_alt_hae_m;
+
+  // ---- UI-smoothed (for gauges only) ----
+  double ui_vel_kmh, ui_az_deg;
+
+  // ---- Status ----
+  double hdop;  // NMEA HDOP, or NAV-PVT PDOP
+  int sats;
+
+  // ---- This frame ----
+  bool gpsOK;         // new position/speed/course arrived
+  double fix_time_s;  // its GNSS time (NAN if none)
+
+  // ---- Physics and session clock offset ----
+  PhysicsPipeline<DF> physics;
+  ClockOffsetIntegrator offset;
+  uint32_t fixes;  // frames with gpsOK
+
+  ClockCore()
+    : hae(gps),
+      raw_lat(NAN), raw_lon(NAN), raw_vel_kmh(NAN), raw_az_deg(NAN),
+      raw_alt_baro_m(NAN), raw_alt_hae_m(NAN),
+      ui_vel_kmh(0.0), ui_az_deg(NAN),
+      hdop(NAN), sats(0),
+      gpsOK(false), fix_time_s(NAN),
+      fixes(0), mode_{ GrMode::Reference, AltSource::Baro, false }, tLastPvt_(0), tLastFix_(0) {}
+
+  void setSimLocation(double lat_deg, double alt_m) { physics.setSimLocation(lat_deg, alt_m); }
+
+  void setMode(const ClockMode &m) {
+    mode_ = m;
+    physics.setMode(m);
+  }
+  const ClockMode &mode() const { return mode_; }
+
+  // Barometer is read only while it is the altitude source
+  bool wantsBaro() const { return mode_.alt == AltSource::Baro; }
+
+  void beginFrame() {
+    gpsOK = false;
+    fix_time_s = NAN;
+    noFixBefore_ = noFixAfter_ = false;
+  }
+
+  // Whole frames (sentences / UBX frames) from the ingest ring
+  void feedGnss(const uint8_t *p, size_t n) {
+    if (UbxMode) {
+      feedUbx(p, n);
+    } else {
+      for (size_t i = 0; i < n; ++i) gps.encode(p[i]);
+    }
+  }
+
+  void endGnss() {
+    if (UbxMode) {
+      endUbx();
+    } else {
+      endNmea();
+    }
+    if (gpsOK) ++fixes;
+  }
+
+  void setBaroAltitude(double alt_m) {
+    if (!isnan(alt_m) && isfinite(alt_m)) raw_alt_baro_m = alt_m;  // raw for physics
+  }
+
+  // UI smoothing (visual only)
+  void smooth() {
+    if (!isnan(raw_vel_kmh)) ui_vel_kmh = lpf(ui_vel_kmh, raw_vel_kmh, 0.12f);
+    if (!isnan(raw_az_deg)) ui_az_deg = smooth_heading_deg(ui_az_deg, raw_az_deg, 0.10f);
+  }
+
+  // Physics use raw values only (replace NaNs with zeros). set() bumps an
+  // input's sequence only on a real change; update() then re-runs only the
+  // stages depending on it (new speed/course: SR only; new lat/alt: all).
+  // The clock offset integrates fixes only; an epoch without a fix (or a
+  // stale fix) breaks its chain, so that time is a gap.
+  void evaluate() {
+    physics.latitude.set(isnan(raw_lat) ? 0.0 : raw_lat);
+    physics.alt_baro.set(isnan(raw_alt_baro_m) ? 0.0 : raw_alt_baro_m);
+    physics.alt_hae.set(isnan(raw_alt_hae_m) ? 0.0 : raw_alt_hae_m);
+    physics.velocity.set(isnan(raw_vel_kmh) ? 0.0 : raw_vel_kmh);
+    physics.azimuth.set(isnan(raw_az_deg) ? 0.0 : raw_az_deg);
+    physics.update();
+
+    // Accumulate once per GNSS fix, over the receiver's own time step
+    if (noFixBefore_) offset.noFix();
+    if (gpsOK && !isnan(fix_time_s)) offset.addFix(fix_time_s, physics.result.ns_per_s);
+    if (noFixAfter_) offset.noFix();
+  }
+
+  // Altitude used by the physics (active source)
+  double altitude() const {
+    return (mode_.alt == AltSource::Hae) ? physics.alt_hae.value : physics.alt_baro.value;
+  }
+
+private:
+  void feedUbx(const uint8_t *p, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      if (ubx.push(p[i]) != FrameStatus::Complete) continue;
+      const UbxNavPvt *pvt = ubx.navPvt();
+      if (!pvt) continue;
+
+      GnssFix fix;
+      ubxNavPvtToFix(*pvt, fix);
+      tLastPvt_ = millis();
+      sats = fix.num_sv;
+      hdop = fix.pdop;  // signal gauge input; PDOP ≥ HDOP
+      if (!fix.fix_ok) {
+        noFixEpoch();
+        continue;
+      }
+      tLastFix_ = tLastPvt_;
+      fixEpoch();
+      fix_time_s = fix.time_valid ? fix.gnss_time_s : NAN;
+
+      // Raw for physics; HAE straight from the receiver
+      raw_lat = fix.lat_deg;
+      raw_lon = fix.lon_deg;
+      raw_vel_kmh = fix.speed_kmh;
+      raw_az_deg = fix.heading_deg;
+      raw_alt_hae_m = fix.hae_m;
+      gpsOK = true;
+    }
+  }
+
+  void endUbx() {
+    // Freshness: no fix for >3 s invalidates the raw readings (NAV-PVT
+    // without a fix still reports satellites), no NAV-PVT the rest
+    const uint32_t now = millis();
+    if (now - tLastFix_ > 3000) {
+      noFixEpoch();
+      raw_lat = raw_lon = NAN;
+      raw_vel_kmh = raw_az_deg = NAN;
+    }
+    if (now - tLastPvt_ > 3000) {
+      sats = 0;
+      hdop = NAN;
+    }
+  }
+
+  void endNmea() {
+    gpsOK = gps.location.isUpdated() && gps.speed.isUpdated() && gps.course.isUpdated();
+    // RMC / GGA without a fix still commit the time, not the location
+    if (gps.time.isUpdated() && !gps.location.isUpdated()) noFixEpoch();
+    if (gpsOK) fixEpoch();
+
+    // Freshness: invalidate stale readings
+    const unsigned long ageLoc = gps.location.age();
+    const unsigned long ageSpd = gps.speed.age();
+    const unsigned long ageCrs = gps.course.age();
+
+    if (ageLoc > 3000) {
+      noFixEpoch();
+      raw_lat = NAN;
+      raw_lon = NAN;
+    }  // >3 s
+    if (ageSpd > 3000) { raw_vel_kmh = NAN; }
+    if (ageCrs > 3000) { raw_az_deg = NAN; }
+
+    sats = (gps.satellites.isValid() && gps.satellites.age() < 5000)
+             ? (int)gps.satellites.value()
+             : 0;
+
+    hdop = (gps.hdop.isValid() && gps.hdop.age() < 5000)
+             ? gps.hdop.hdop()
+             : NAN;
+
+    // Current GNSS values (may be invalid; TinyGPSPlus keeps the last
+    // valid one, so stale ones must not come back)
+    const double lat_now = (gps.location.isValid() && ageLoc <= 3000) ? gps.location.lat() : NAN;
+    const double lon_now = (gps.location.isValid() && ageLoc <= 3000) ? gps.location.lng() : NAN;
+    const double vel_now = (gps.speed.isValid() && ageSpd <= 3000) ? gps.speed.kmph() : NAN;
+    const double az_now = (gps.course.isValid() && ageCrs <= 3000) ? gps.course.deg() : NAN;
+
+    // Raw for physics (keep last valid)
+    raw_lat = keepOr(raw_lat, lat_now);
+    raw_lon = keepOr(raw_lon, lon_now);
+    raw_vel_kmh = keepOr(raw_vel_kmh, vel_now);
+    raw_az_deg = keepOr(raw_az_deg, az_now);
+
+    // HAE = MSL + geoid separation from GGA
+    if (mode_.alt == AltSource::Hae) {
+      hae.update();  // Update N cache
+      const double alt_now = hae.getHAE_m(5000);
+      if (!isnan(alt_now) && isfinite(alt_now)) {
+        raw_alt_hae_m = alt_now;  // raw for physics
+      }
+    }
+
+    if (gps.time.isUpdated() && gps.time.isValid() && gps.date.isValid()) {
+      fix_time_s = gnssTimeSeconds(gps.date.year(), gps.date.month(), gps.date.day(),
+                                   gps.time.hour(), gps.time.minute(), gps.time.second(),
+                                   gps.time.centisecond());
+    }
+  }
+
+  // Order of fix / no-fix epochs within one pass, for the offset chain
+  void noFixEpoch() {
+    if (gpsOK) noFixAfter_ = true;
+    else noFixBefore_ = true;
+  }
+  void fixEpoch() {
+    if (noFixAfter_) noFixBefore_ = true;  // fix, no fix, fix: the gap precedes the last fix
+    noFixAfter_ = false;
+  }
+
+  ClockMode mode_;
+  uint32_t tLastPvt_, tLastFix_;
+  bool noFixBefore_ = false, noFixAfter_ = false;
+};
@@ -0,0 +1,127 @@
+#pragma once
+/*
+  relativistic_clock_history.h  —  Long dilation history for the chart
+  --------------------------------------------------------------------
+  - Fixed memory: four levels of min / max / mean buckets, 1 s, 10 s,
+    1 min and 10 min wide, BUCKETS of each (160 = one per chart column:
+    2.7 min, 27 min, 2.7 h and 26.7 h of history)
+  - Each level keeps an open bucket that absorbs its children (samples for
+    1 s, closed 1 s buckets for 10 s, ...); closing a bucket folds it into
+    the next level, so add() is O(1) amortized and no level ever rescans
+    samples
+  - Seconds without samples close as empty buckets (count 0), so bucket
+    ages stay aligned with time; the chart leaves them blank
+  - Bucket times come from millis() at the caller (display history, not
+    GNSS time)
+
+  Usage:
+    DilationHistory history;
+    history.add(millis(), delta_ns_per_hour);     // every frame
+    HistoryBucket b;
+    history.bucket(level, age, b);                // age 0: still open
+*/
+
+#include <stdint.h>
+
+struct HistoryBucket {
+  float min, max;
+  float sum;
+  uint32_t count;  // samples; 0 = no data in this interval
+
+  void clear() {
+    min = max = sum = 0.0f;
+    count = 0;
+  }
+  void add(float v) {
+    if (!count || v < min) min = v;
+    if (!count || v > max) max = v;
+    sum += v;
+    ++count;
+  }
+  void merge(const HistoryBucket &b) {
+    if (!b.count) return;
+    if (!count || b.min < min) min = b.min;
+    if (!count || b.max > max) max = b.max;
+    sum += b.sum;
+    count += b.count;
+  }
+  float mean() const { return count ? sum / count : 0.0f; }
+};
+
+struct DilationHistory {
+  static const int LEVELS = 4;
+  static const int BUCKETS = 160;  // closed buckets kept per level
+
+  DilationHistory() { reset(); }
+
+  void reset() {
+    for (int k = 0; k < LEVELS; ++k) {
+      open_[k].clear();
+      closed_[k] = 0;
+      children_[k] = 0;
+    }
+    second_ = 0;
+    started_ = false;
+  }
+
+  // One sample at t_ms (millis())
+  void add(uint32_t t_ms, float v) {
+    const uint32_t sec = t_ms / 1000;
+    if (!started_) {
+      second_ = sec;
+      started_ = true;
+    }
+    // Close every second that ended since the last sample (empty if skipped)
+    while ((int32_t)(sec - second_) > 0) {
+      close(0);
+      ++second_;
+    }
+    open_[0].add(v);
+  }
+
+  // Buckets closed on a level since reset (grows by one per level width)
+  uint32_t closed(int level) const { return closed_[level]; }
+
+  // age 0: the open (partial) bucket, all samples so far; 1: newest
+  // closed; up to BUCKETS.
+  // False if the level has no bucket of that age.
+  bool bucket(int level, uint32_t age, HistoryBucket &out) const {
+    if (level < 0 || level >= LEVELS) return false;
+    if (age == 0) {
+      // Open bucket plus the still-open buckets below it (not yet folded in)
+      out = open_[level];
+      for (int k = 0; k < level; ++k) out.merge(open_[k]);
+      return true;
+    }
+    if (age > closed_[level] || age > (uint32_t)BUCKETS) return false;
+    out = ring_[level][(closed_[level] - age) % BUCKETS];
+    return true;
+  }
+
+private:
+  // Children per parent bucket: 10 x 1 s, 6 x 10 s, 10 x 1 min
+  static int factor(int level) {
+    static const uint8_t F[LEVELS] = { 1, 10, 6, 10 };
+    return F[level];
+  }
+
+  void close(int level) {
+    ring_[level][closed_[level] % BUCKETS] = open_[level];
+    ++closed_[level];
+    if (level + 1 < LEVELS) {
+      open_[level + 1].merge(open_[level]);
+      if (++children_[level + 1] == factor(level + 1)) {
+        close(level + 1);
+        children_[level + 1] = 0;
+      }
+    }
+    open_[level].clear();
+  }
+
+  HistoryBucket ring_[LEVELS][BUCKETS];
+  HistoryBucket open_[LEVELS];
+  uint32_t closed_[LEVELS];
+  int children_[LEVELS];
+  uint32_t second_;  // second of open_[0]
+  bool started_;
+};
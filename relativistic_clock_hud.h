@@ -8,6 +8,7 @@
 #include "assets/fonts/RobotoBoldCondensed12.h"
 #include "assets/fonts/RobotoBoldCondensed10.h"
 #include <hud_gauges.h>
+#include "hud_compositor.h"
 
 extern M5Canvas canvasBackground;
 extern M5Canvas canvasStaticVelocity;
@@ -28,12 +29,100 @@ extern M5Canvas canvasDynamicTimeDilation;
 extern M5Canvas canvasDynamicHeader;
 extern M5Canvas canvasDynamicLineChart;
 
+// All layers reach the panel through it (one framebuffer, flushed per frame)
+extern HudCompositor hudCompositor;
+
+// ---- Layer color depths ----
+// The panel is RGB565, so a 16-bit layer pushes exactly what a 32-bit one
+// would, with half the RAM and half the bytes read per push.
+// HUD_DEPTH_PALETTE layers are drawn in RGB565 and then re-encoded once as
+// 8-bit indices into a palette of their own colors (exact up to 256
+// colors; a layer with more stays RGB565); the push converts back.
+// Without an alpha channel, unpainted pixels hold TFT_TRANSPARENT and the
+// pushes key it out.
+#define HUD_DEPTH_PALETTE 8
+#ifndef HUD_STATIC_DEPTH
+#define HUD_STATIC_DEPTH HUD_DEPTH_PALETTE  // flat static frames, pushed once
+#endif
+#ifndef HUD_DYNAMIC_DEPTH
+#define HUD_DYNAMIC_DEPTH 16  // gauges, redrawn every frame
+#endif
+
+// Allocates a layer for `depth` (32, 16 or HUD_DEPTH_PALETTE)
+inline void createHudLayer(M5Canvas &layer, int32_t w, int32_t h, uint8_t depth) {
+  layer.setColorDepth(depth == 32 ? 32 : 16);
+  layer.createSprite(w, h);
+  if (depth != 32) layer.fillScreen(TFT_TRANSPARENT);
+}
+
+// Re-encodes a drawn RGB565 layer as 8-bit palette indices. Returns the
+// index of TFT_TRANSPARENT (-1: unused), or -2 if the layer has more than
+// 256 colors or there is no memory (the layer stays RGB565).
+inline int paletteLayer(M5Canvas &layer) {
+  const int32_t w = layer.width(), h = layer.height();
+  uint8_t *index = (uint8_t *)malloc((size_t)w * h);
+  if (!index) return -2;
+  uint16_t colors[256];
+  int count = 0, k = -1;
+  for (int32_t y = 0; y < h; ++y) {
+    for (int32_t x = 0; x < w; ++x) {
+      const uint16_t c = layer.readPixel(x, y);
+      if (k < 0 || colors[k] != c) {
+        for (k = 0; k < count && colors[k] != c; ++k) {}
+        if (k == count) {
+          if (count == 256) {
+            free(index);
+            return -2;
+          }
+          colors[count++] = c;
+        }
+      }
+      index[(size_t)y * w + x] = (uint8_t)k;
+    }
+  }
+
+  layer.deleteSprite();
+  layer.setColorDepth(8);
+  const bool packed = layer.createSprite(w, h) && layer.createPalette();
+  if (!packed) {
+    layer.deleteSprite();
+    layer.setColorDepth(16);
+    layer.createSprite(w, h);
+  }
+  int key = -1;
+  for (int i = 0; i < count; ++i) {
+    const uint32_t r = (colors[i] >> 11) & 0x1F, g = (colors[i] >> 5) & 0x3F, b = colors[i] & 0x1F;
+    if (packed) layer.setPaletteColor(i, (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2)));
+    if (colors[i] == TFT_TRANSPARENT) key = i;
+  }
+  // Runs of one index per row; palette sprites take indices as colors
+  for (int32_t y = 0; y < h; ++y) {
+    const uint8_t *row = index + (size_t)y * w;
+    for (int32_t x = 0; x < w;) {
+      int32_t n = 1;
+      while (x + n < w && row[x + n] == row[x]) ++n;
+      if (packed) layer.drawFastHLine(x, y, n, row[x]);
+      else layer.drawFastHLine(x, y, n, colors[row[x]]);
+      x += n;
+    }
+  }
+  free(index);
+  return packed ? key : -2;
+}
+
+// Pushes a finished static layer (once, at setup)
+inline void pushStaticLayer(M5Canvas &layer, int32_t x, int32_t y, uint8_t depth) {
+  const int key = (depth == HUD_DEPTH_PALETTE) ? paletteLayer(layer) : -2;
+  if (key >= 0) hudCompositor.push(layer, x, y, (uint8_t)key);
+  else if (key == -1) hudCompositor.push(layer, x, y);
+  else hudCompositor.push(layer, x, y, TFT_TRANSPARENT);
+}
+
 
 // ---- Background (static) ----
 // Draws the main background, header strip, bottom highlight band, and separators.
 inline void drawBackground() {
-  canvasBackground.setColorDepth(32);
-  canvasBackground.createSprite(320, 240);
+  createHudLayer(canvasBackground, 320, 240, HUD_STATIC_DEPTH);
   canvasBackground.fillScreen(canvasBackground.color888(20, 21, 39));
   canvasBackground.fillRoundRect(0, 0, 320, 25, 0, canvasBackground.color888(0, 0, 0));
   canvasBackground.fillRoundRect(0, 160, 320, 90, 0, canvasBackground.color888(208, 247, 32));
@@ -41,139 +130,123 @@ inline void drawBackground() {
   canvasBackground.drawGradientHLine(0, 154, 320, canvasBackground.color565(208, 247, 32), canvasBackground.color565(50, 50, 50));
   canvasBackground.drawGradientHLine(0, 156, 320, canvasBackground.color565(208, 247, 32), canvasBackground.color565(50, 50, 50));
   canvasBackground.drawGradientHLine(0, 158, 320, canvasBackground.color565(208, 247, 32), canvasBackground.color565(50, 50, 50));
-  canvasBackground.loadFont(BebasNeueRegular20);
+  canvasBackground.setFont(hudFont(BebasNeueRegular20));
   canvasBackground.setTextColor(WHITE, BLACK);
   canvasBackground.drawString("RELATIVISTIC CLOCK", 5, 0);
-  canvasBackground.unloadFont();
-  canvasBackground.pushSprite(0, 0);
+  pushStaticLayer(canvasBackground, 0, 0, HUD_STATIC_DEPTH);
 }
 
 // ---- Header (static) ----
 // Prepares the static header container; dynamic content is drawn elsewhere.
 inline void drawStaticHeader() {
-  canvasStaticHeader.setColorDepth(32);
-  canvasStaticHeader.createSprite(180, 25);
+  createHudLayer(canvasStaticHeader, 180, 25, HUD_STATIC_DEPTH);
   canvasStaticHeader.fillScreen(canvasStaticHeader.color888(0, 0, 0));
   canvasStaticHeader.fillRoundRect(0, 0, 180, 25, 0, canvasStaticHeader.color888(0, 0, 0));
-  canvasStaticHeader.pushSprite(140, 0);
+  pushStaticLayer(canvasStaticHeader, 140, 0, HUD_STATIC_DEPTH);
 }
 
 // ---- Line Chart (static) ----
 // Creates the static area for the line chart; data is rendered dynamically.
 inline void drawStaticLineChart() {
-  canvasStaticLineChart.setColorDepth(32);
-  canvasStaticLineChart.createSprite(160, 40);
-  canvasStaticLineChart.pushSprite(155, 195);
+  createHudLayer(canvasStaticLineChart, 160, 40, HUD_STATIC_DEPTH);
+  pushStaticLayer(canvasStaticLineChart, 155, 195, HUD_STATIC_DEPTH);
 }
 
 // ---- Altitude gauge (static frame) ----
 // Draws static decorations and units for the altitude gauge.
 inline void drawStaticAltitude() {
-  canvasStaticAltitude.setColorDepth(32);
-  canvasStaticAltitude.createSprite(90, 90);
+  createHudLayer(canvasStaticAltitude, 90, 90, HUD_STATIC_DEPTH);
   canvasStaticAltitude.fillCircle(45, 45, 44, canvasStaticAltitude.color888(20, 21, 39));
   canvasStaticAltitude.fillCircle(45, 45, 40, canvasStaticAltitude.color888(20, 21, 39));
   canvasStaticAltitude.setTextColor(canvasStaticAltitude.color888(224, 106, 34), canvasStaticAltitude.color888(20, 21, 39));
-  canvasStaticAltitude.loadFont(RobotoBoldCondensed12);
+  canvasStaticAltitude.setFont(hudFont(RobotoBoldCondensed12));
   canvasStaticAltitude.drawString("ALT.", 35, 22);
   canvasStaticAltitude.setTextColor(canvasStaticAltitude.color888(0, 0, 0), canvasStaticAltitude.color888(27, 228, 234));
   canvasStaticAltitude.fillCircle(46, 59, 8, canvasStaticAltitude.color888(27, 228, 234));
   canvasStaticAltitude.drawString("m", 42, 52);
-  canvasStaticAltitude.unloadFont();
-  canvasStaticAltitude.pushSprite(215, 100, TFT_TRANSPARENT);
+  pushStaticLayer(canvasStaticAltitude, 215, 100, HUD_STATIC_DEPTH);
 }
 
 // ---- Latitude gauge (static frame) ----
 // Draws static decorations and label for the latitude gauge.
 inline void drawStaticLatitude() {
-  canvasStaticLatitude.setColorDepth(32);
-  canvasStaticLatitude.createSprite(90, 90);
+  createHudLayer(canvasStaticLatitude, 90, 90, HUD_STATIC_DEPTH);
   canvasStaticLatitude.fillCircle(45, 45, 44, canvasStaticLatitude.color888(20, 21, 39));
   canvasStaticLatitude.fillCircle(45, 45, 40, canvasStaticLatitude.color888(20, 21, 39));
   canvasStaticLatitude.setTextColor(canvasStaticLatitude.color888(115, 228, 163), canvasStaticLatitude.color888(20, 21, 39));
-  canvasStaticLatitude.loadFont(RobotoBoldCondensed10);
+  canvasStaticLatitude.setFont(hudFont(RobotoBoldCondensed10));
   canvasStaticLatitude.drawString("LAT.", 35, 22);
-  canvasStaticLatitude.unloadFont();
-  canvasStaticLatitude.pushSprite(150, 100, TFT_TRANSPARENT);
+  pushStaticLayer(canvasStaticLatitude, 150, 100, HUD_STATIC_DEPTH);
 }
 
 // ---- Local rotational velocity (static frame) ----
 // Draws the static frame and labels for the local rotational velocity bar.
 inline void drawStaticVelocity() {
-  canvasStaticVelocity.setColorDepth(32);
-  canvasStaticVelocity.createSprite(310, 30);
+  createHudLayer(canvasStaticVelocity, 310, 30, HUD_STATIC_DEPTH);
   canvasStaticVelocity.fillScreen(canvasStaticVelocity.color888(20, 21, 39));
   canvasStaticVelocity.fillRoundRect(0, 0, 60, 15, 0, canvasStaticVelocity.color888(20, 21, 39));
   canvasStaticVelocity.fillRoundRect(0, 15, 60, 15, 0, canvasStaticVelocity.color888(20, 21, 39));
   canvasStaticVelocity.fillRoundRect(60, 15, 250, 15, 0, canvasStaticVelocity.color888(20, 21, 39));
   canvasStaticVelocity.setTextColor(canvasStaticVelocity.color888(150, 150, 150), canvasStaticVelocity.color888(20, 21, 39));
-  canvasStaticVelocity.loadFont(RobotoBoldCondensed10);
+  canvasStaticVelocity.setFont(hudFont(RobotoBoldCondensed10));
   canvasStaticVelocity.drawString("km/h", 19, 15);
-  canvasStaticVelocity.loadFont(RobotoBoldCondensed10);
+  canvasStaticVelocity.setFont(hudFont(RobotoBoldCondensed10));
   canvasStaticVelocity.setTextColor(canvasStaticVelocity.color888(255, 255, 255), canvasStaticVelocity.color888(20, 21, 39));
   canvasStaticVelocity.drawString("LOCAL ROTATIONAL VELOCITY", 120, 15);
-  canvasStaticVelocity.unloadFont();
-  canvasStaticVelocity.loadFont(RobotoRegular9);
+  canvasStaticVelocity.setFont(hudFont(RobotoRegular9));
   canvasStaticVelocity.drawString("0", 60, 16);
   canvasStaticVelocity.drawString("1700", 289, 16);
-  canvasStaticVelocity.unloadFont();
-  canvasStaticVelocity.pushSprite(5, 30, TFT_TRANSPARENT);
+  pushStaticLayer(canvasStaticVelocity, 5, 30, HUD_STATIC_DEPTH);
 }
 
 // ---- Total velocity (static frame) ----
 // Draws the static frame and labels for the total velocity bar.
 inline void drawStaticTotalVelocity() {
-  canvasStaticTotalVelocity.setColorDepth(32);
-  canvasStaticTotalVelocity.createSprite(310, 30);
+  createHudLayer(canvasStaticTotalVelocity, 310, 30, HUD_STATIC_DEPTH);
   canvasStaticTotalVelocity.fillScreen(canvasStaticTotalVelocity.color888(20, 21, 39));
   canvasStaticTotalVelocity.fillRoundRect(0, 0, 60, 15, 0, canvasStaticTotalVelocity.color888(20, 21, 39));
   canvasStaticTotalVelocity.fillRoundRect(0, 15, 60, 15, 0, canvasStaticTotalVelocity.color888(20, 21, 39));
   canvasStaticTotalVelocity.fillRoundRect(60, 15, 250, 15, 0, canvasStaticTotalVelocity.color888(20, 21, 39));
   canvasStaticTotalVelocity.setTextColor(canvasStaticTotalVelocity.color888(150, 150, 150), canvasStaticTotalVelocity.color888(20, 21, 39));
-  canvasStaticTotalVelocity.loadFont(RobotoBoldCondensed10);
+  canvasStaticTotalVelocity.setFont(hudFont(RobotoBoldCondensed10));
   canvasStaticTotalVelocity.drawString("km/h", 19, 15);
-  canvasStaticTotalVelocity.loadFont(RobotoBoldCondensed10);
+  canvasStaticTotalVelocity.setFont(hudFont(RobotoBoldCondensed10));
   canvasStaticTotalVelocity.setTextColor(canvasStaticTotalVelocity.color888(255, 255, 255), canvasStaticTotalVelocity.color888(20, 21, 39));
   canvasStaticTotalVelocity.drawString("TOTAL VELOCITY", 148, 15);
-  canvasStaticTotalVelocity.unloadFont();
-  canvasStaticTotalVelocity.loadFont(RobotoRegular9);
+  canvasStaticTotalVelocity.setFont(hudFont(RobotoRegular9));
   canvasStaticTotalVelocity.drawString("0", 60, 16);
   canvasStaticTotalVelocity.drawString("2700", 289, 16);
-  canvasStaticTotalVelocity.unloadFont();
-  canvasStaticTotalVelocity.pushSprite(5, 67, TFT_TRANSPARENT);
+  pushStaticLayer(canvasStaticTotalVelocity, 5, 67, HUD_STATIC_DEPTH);
 }
 
 // ---- Local gravity (static frame) ----
 // Draws the pill-shaped static container and label for local gravity.
 inline void drawStaticLocalGravity() {
-  canvasStaticLocalGravity.setColorDepth(32);
-  canvasStaticLocalGravity.createSprite(200, 45);
+  createHudLayer(canvasStaticLocalGravity, 200, 45, HUD_STATIC_DEPTH);
   // Good color options (kept as reference)
   // canvasStaticLocalGravity.fillRoundRect(0, 0, 200, 45, 7, canvasStaticLocalGravity.color888(7, 84, 76));
   // canvasStaticLocalGravity.fillRoundRect(0, 0, 200, 45, 7, canvasStaticLocalGravity.color888(35, 59, 66));
   // canvasStaticLocalGravity.fillRoundRect(0, 0, 200, 45, 7, canvasStaticLocalGravity.color888(50, 26, 50));
   canvasStaticLocalGravity.fillRoundRect(0, 0, 200, 45, 7, canvasStaticLocalGravity.color888(253, 47, 43));
-  canvasStaticLocalGravity.loadFont(RobotoBold9);
+  canvasStaticLocalGravity.setFont(hudFont(RobotoBold9));
   canvasStaticLocalGravity.setTextColor(canvasStaticLocalGravity.color888(255, 255, 255), canvasStaticLocalGravity.color888(253, 47, 43));
   canvasStaticLocalGravity.drawString("LOCAL GRAVITY (m/s   )", 12, 3);
-  canvasStaticLocalGravity.loadFont(RobotoBlack8);
+  canvasStaticLocalGravity.setFont(hudFont(RobotoBlack8));
   canvasStaticLocalGravity.drawString("2", 102, 1);
-  canvasStaticLocalGravity.pushSprite(5, 102, TFT_TRANSPARENT);
+  pushStaticLayer(canvasStaticLocalGravity, 5, 102, HUD_STATIC_DEPTH);
 }
 
 // ---- Time dilation (static frame) ----
 // Draws the static container and title for the time dilation panel.
 inline void drawStaticTimeDilation() {
-  canvasStaticTimeDilation.setColorDepth(32);
-  canvasStaticTimeDilation.createSprite(145, 70);
+  createHudLayer(canvasStaticTimeDilation, 145, 70, HUD_STATIC_DEPTH);
   canvasStaticTimeDilation.fillRoundRect(0, 0, 145, 70, 7, canvasStaticTimeDilation.color888(35, 34, 68));
 
-  canvasStaticTimeDilation.loadFont(RobotoBoldCondensed10);
+  canvasStaticTimeDilation.setFont(hudFont(RobotoBoldCondensed10));
   canvasStaticTimeDilation.setTextColor(canvasStaticTimeDilation.color888(255, 255, 255), canvasStaticTimeDilation.color888(35, 34, 68));
   canvasStaticTimeDilation.drawString("TIME DILATION (ns/h)", 28, 3);
 
-  canvasStaticTimeDilation.unloadFont();
-  canvasStaticTimeDilation.pushSprite(5, 165, TFT_TRANSPARENT);
+  pushStaticLayer(canvasStaticTimeDilation, 5, 165, HUD_STATIC_DEPTH);
 }
 
 // ---- Altitude (dynamic) ----
@@ -211,17 +284,19 @@ inline void drawDynamicAltitude(float altitude, float azimuth = -1) {
                                        /*arc_inset_inner_px*/ 2,
                                        /*draw_track*/         true);
 
-  canvasDynamicAltitude.loadFont(RobotoBoldCondensed10);
-  canvasDynamicAltitude.setTextColor(WHITE, canvasDynamicAltitude.color888(20, 21, 39));
-  canvasDynamicAltitude.drawFloat(altitude, 1, 30, 36);
-  canvasDynamicAltitude.pushSprite(215, 100, TFT_TRANSPARENT);
+  static HudDigitAtlas digits;
+  digits.drawFloat(canvasDynamicAltitude, RobotoBoldCondensed10,
+                   canvasDynamicAltitude.color888(255, 255, 255), canvasDynamicAltitude.color888(20, 21, 39),
+                   altitude, 1, 30, 36);
+  hudCompositor.push(canvasDynamicAltitude, 215, 100, TFT_TRANSPARENT);
 }
 
 // ---- Header (dynamic) ----
 // Draws dynamic header info: satellites, GPS signal (smoothed), and battery.
-inline void drawDynamicHeader(float hdop, int batteryLevel, int satellites) {
+// gnssFault: the receiver configuration failed ("CFG ERR" in red instead of "SIGNAL:").
+inline void drawDynamicHeader(float hdop, int batteryLevel, int satellites, bool gnssFault = false) {
   const int sats = satellites;
-  canvasDynamicHeader.loadFont(RobotoBoldCondensed10);
+  canvasDynamicHeader.setFont(hudFont(RobotoBoldCondensed10));
 
   // Opaque header background (no transparency)
   canvasDynamicHeader.fillRect(0, 0,
@@ -237,12 +312,19 @@ inline void drawDynamicHeader(float hdop, int batteryLevel, int satellites) {
   canvasDynamicHeader.drawString("SAT:", 0, 6);
 
   // SAT value
-  canvasDynamicHeader.setTextColor(canvasDynamicHeader.color888(9, 193, 175), canvasDynamicHeader.color888(0, 0, 0));
-  canvasDynamicHeader.drawNumber(sats, 24, 6);
+  static HudDigitAtlas digits;
+  digits.drawNumber(canvasDynamicHeader, RobotoBoldCondensed12,  // font left by drawBatteryStatus
+                    canvasDynamicHeader.color888(9, 193, 175), canvasDynamicHeader.color888(0, 0, 0),
+                    sats, 24, 6);
 
   // Signal gauge
-  canvasDynamicHeader.setTextColor(canvasDynamicHeader.color888(239, 224, 0), canvasDynamicHeader.color888(0, 0, 0));
-  canvasDynamicHeader.drawString("SIGNAL:", 40, 6);
+  if (gnssFault) {
+    canvasDynamicHeader.setTextColor(canvasDynamicHeader.color888(255, 40, 40), canvasDynamicHeader.color888(0, 0, 0));
+    canvasDynamicHeader.drawString("CFG ERR", 40, 6);
+  } else {
+    canvasDynamicHeader.setTextColor(canvasDynamicHeader.color888(239, 224, 0), canvasDynamicHeader.color888(0, 0, 0));
+    canvasDynamicHeader.drawString("SIGNAL:", 40, 6);
+  }
 
   // Exponential smoothing for signal level (0..5) derived from HDOP
   static float levelSmooth = 0.0f;                // internal state
@@ -253,12 +335,13 @@ inline void drawDynamicHeader(float hdop, int batteryLevel, int satellites) {
   drawGpsSignalGauge5Smooth(canvasDynamicHeader, 82, 5, 13, 5, 2, levelSmooth);
 
   // Push header (opaque)
-  canvasDynamicHeader.pushSprite(140, 0);
+  hudCompositor.push(canvasDynamicHeader, 140, 0);
 }
 
 // ---- Line Chart (dynamic) ----
 // Draws the live time-dilation chart over the static container.
-inline void drawDynamicLineChart(double dilation) {
+// level -1: last 160 samples (one per fix); 0..3: history envelope per 1 s / 10 s / 1 min / 10 min.
+inline void drawDynamicLineChart(double dilation, const DilationHistory *history = nullptr, int level = -1) {
   // canvasDynamicLineChart.fillRoundRect(0, 0, 160, 40, 10, canvasStaticLineChart.color888(20, 21, 39));
   drawTimeDilationChart(canvasDynamicLineChart, dilation,
                           -6.0, 3.0,
@@ -269,9 +352,10 @@ inline void drawDynamicLineChart(double dilation) {
                           /*dash*/ 4, /*gap*/ 3,
                           /*vStepPx*/ 3,      // vertical grid lines every 6 px
                           /*vMajorEvery*/ 0,  // kept for compatibility
-                          /*colGridMajor*/ canvasDynamicLineChart.color565(50, 90, 50));
+                          /*colGridMajor*/ canvasDynamicLineChart.color565(50, 90, 50),
+                          history, level);
 
-  canvasDynamicLineChart.pushSprite(155, 195);
+  hudCompositor.push(canvasDynamicLineChart, 155, 195);
 }
 
 // ---- Latitude (dynamic) ----
@@ -296,9 +380,12 @@ inline void drawDynamicLatitude(float latitude) {
     latitude                             // Latitude (-90 to +90)
   );
 
-  canvasDynamicLatitude.loadFont(RobotoBoldCondensed10);
+  static HudDigitAtlas digits;
+  digits.drawFloat(canvasDynamicLatitude, RobotoBoldCondensed10,
+                   canvasDynamicLatitude.color888(255, 255, 255), canvasDynamicLatitude.color888(20, 21, 39),
+                   latitude, 5, 23, 36);
+  canvasDynamicLatitude.setFont(hudFont(RobotoBoldCondensed10));
   canvasDynamicLatitude.setTextColor(WHITE, canvasDynamicLatitude.color888(20, 21, 39));
-  canvasDynamicLatitude.drawFloat(latitude, 5, 23, 36);
 
   if (latitude > 0) {
     canvasDynamicLatitude.setTextColor(canvasDynamicLatitude.color888(0, 0, 0), canvasDynamicLatitude.color888(235, 41, 67));
@@ -313,8 +400,7 @@ inline void drawDynamicLatitude(float latitude) {
     canvasDynamicLatitude.drawString("--", 42, 52);
   }
 
-  canvasDynamicLatitude.unloadFont();
-  canvasDynamicLatitude.pushSprite(150, 100, TFT_TRANSPARENT);
+  hudCompositor.push(canvasDynamicLatitude, 150, 100, TFT_TRANSPARENT);
 }
 
 // ---- Local rotational velocity (dynamic) ----
@@ -325,16 +411,22 @@ inline void drawDynamicVelocity(float velocity) {
   float vmin = 0.0f, vmax = 1700.0f;
   float value = velocity;
 
-  drawSpeedBarGauge(canvasDynamicVelocity, x, y, width, height,
-                    value, vmin, vmax,
-                    255, 0, 0,       // gradient start (R,G,B)
-                    100, 255, 100);  // gradient end   (R,G,B)
-
-  canvasDynamicVelocity.setTextColor(canvasDynamicVelocity.color888(255, 255, 255), canvasDynamicVelocity.color888(20, 21, 39));
-  canvasDynamicVelocity.loadFont(RobotoBoldCondensed12);
+  // Value as printed; nothing is redrawn while it and the bar are unchanged
+  static BarGaugeStrip bar;
+  char label[24];
+  hudFormatFixed(label, sizeof(label), velocity, 1);
+  if (!drawSpeedBarGauge(canvasDynamicVelocity, x, y, width, height,
+                         value, vmin, vmax,
+                         255, 0, 0,       // gradient start (R,G,B)
+                         100, 255, 100,   // gradient end   (R,G,B)
+                         &bar, label)) return;
+
+  static HudDigitAtlas digits;
   canvasDynamicVelocity.setTextDatum(top_left);
-  canvasDynamicVelocity.drawFloat(velocity, 1, 12, 0);
-  canvasDynamicVelocity.pushSprite(5, 30, TFT_TRANSPARENT);
+  digits.drawFloat(canvasDynamicVelocity, RobotoBoldCondensed12,
+                   canvasDynamicVelocity.color888(255, 255, 255), canvasDynamicVelocity.color888(20, 21, 39),
+                   velocity, 1, 12, 0);
+  hudCompositor.push(canvasDynamicVelocity, 5, 30, TFT_TRANSPARENT);
 }
 
 // ---- Total velocity (dynamic) ----
@@ -345,78 +437,93 @@ inline void drawDynamicTotalVelocity(float total_velocity) {
   float vmin = 0.0f, vmax = 2700.0f;
   float value = total_velocity;
 
-  drawSpeedBarGauge(canvasDynamicTotalVelocity, x, y, width, height,
-                    value, vmin, vmax,
-                    28, 236, 221,   // gradient start
-                    234, 20, 223);  // gradient end
+  static BarGaugeStrip bar;
+  char label[24];
+  hudFormatFixed(label, sizeof(label), value, 1);
+  if (!drawSpeedBarGauge(canvasDynamicTotalVelocity, x, y, width, height,
+                         value, vmin, vmax,
+                         28, 236, 221,   // gradient start
+                         234, 20, 223,   // gradient end
+                         &bar, label)) return;
 
-  canvasDynamicTotalVelocity.setTextColor(canvasDynamicTotalVelocity.color888(255, 255, 255), canvasDynamicTotalVelocity.color888(20, 21, 39));
-  canvasDynamicTotalVelocity.loadFont(RobotoBoldCondensed12);
+  static HudDigitAtlas digits;
   //canvasDynamicTotalVelocity.setTextDatum(top_left);
-  canvasDynamicTotalVelocity.drawFloat(value, 1, 12, 0);
-  canvasDynamicTotalVelocity.pushSprite(5, 67, TFT_TRANSPARENT);
+  digits.drawFloat(canvasDynamicTotalVelocity, RobotoBoldCondensed12,
+                   canvasDynamicTotalVelocity.color888(255, 255, 255), canvasDynamicTotalVelocity.color888(20, 21, 39),
+                   value, 1, 12, 0);
+  hudCompositor.push(canvasDynamicTotalVelocity, 5, 67, TFT_TRANSPARENT);
 }
 
 // ---- Local gravity (dynamic) ----
 // Draws the live horizontal gauge for local gravity and the numeric value.
 inline void drawDynamicLocalGravity(float gravity) {
-  drawHorizontalBarGauge(canvasDynamicLocalGravity, 20, 17, 110, 12,
-                         gravity, 9.76f, 9.84f,
-                         /*start*/ 0, 160, 0,
-                         /*end*/ 218, 34, 57,
-                         true, 5, true,
-                         /*labels*/ true, 2, "", 1, 4);
-
-  canvasDynamicLocalGravity.loadFont(RobotoBoldCondensed10);
-  canvasDynamicLocalGravity.setTextColor(canvasDynamicLocalGravity.color888(0, 0, 0), canvasDynamicLocalGravity.color888(253, 47, 43));
-  canvasDynamicLocalGravity.drawFloat(gravity, 5, 116, 2);
-  canvasDynamicLocalGravity.pushSprite(5, 102, TFT_TRANSPARENT);
+  static BarGaugeStrip bar;
+  char label[24];
+  hudFormatFixed(label, sizeof(label), gravity, 5);
+  if (!drawHorizontalBarGauge(canvasDynamicLocalGravity, 20, 17, 110, 12,
+                              gravity, 9.76f, 9.84f,
+                              /*start*/ 0, 160, 0,
+                              /*end*/ 218, 34, 57,
+                              true, 5, true,
+                              /*labels*/ true, 2, "", 1, 4,
+                              &bar, label)) return;
+
+  static HudDigitAtlas digits;
+  digits.drawFloat(canvasDynamicLocalGravity, RobotoBoldCondensed10,
+                   canvasDynamicLocalGravity.color888(0, 0, 0), canvasDynamicLocalGravity.color888(253, 47, 43),
+                   gravity, 5, 116, 2);
+  hudCompositor.push(canvasDynamicLocalGravity, 5, 102, TFT_TRANSPARENT);
 }
 
 // ---- Time dilation (dynamic) ----
-// Renders the numeric value and status text ("LAGGING"/"ADVANCING").
-inline void drawDynamicTimeDilation(float time_dilation) {
+// Renders the numeric value, status text ("SLOWER"/"FASTER") and the
+// offset accumulated over the session (ns).
+inline void drawDynamicTimeDilation(float time_dilation, double offset_ns) {
   canvasDynamicTimeDilation.fillRoundRect(0, 18, 145, 46, 0, canvasDynamicTimeDilation.color888(35, 34, 68));
-  canvasDynamicTimeDilation.loadFont(BebasNeueRegular35);
-  canvasDynamicTimeDilation.setTextColor(canvasDynamicTimeDilation.color888(35, 242, 240), canvasDynamicTimeDilation.color888(35, 34, 68));
-  canvasDynamicTimeDilation.drawFloat(time_dilation, 6, 15, 14);
-  canvasDynamicTimeDilation.loadFont(RobotoBoldCondensed12);
+  static HudDigitAtlas digits;
+  digits.drawFloat(canvasDynamicTimeDilation, BebasNeueRegular35,
+                   canvasDynamicTimeDilation.color888(35, 242, 240), canvasDynamicTimeDilation.color888(35, 34, 68),
+                   time_dilation, 6, 15, 14);
+  canvasDynamicTimeDilation.setFont(hudFont(RobotoBoldCondensed12));
 
   if (time_dilation < 0) {
     canvasDynamicTimeDilation.setTextColor(canvasDynamicTimeDilation.color888(127, 255, 27), canvasDynamicTimeDilation.color888(35, 34, 68));
-    canvasDynamicTimeDilation.drawString("TIME SLOWER", 39, 50);
+    canvasDynamicTimeDilation.drawString("SLOWER", 10, 50);
   } else if (time_dilation > 0) {
     canvasDynamicTimeDilation.setTextColor(canvasDynamicTimeDilation.color888(239, 196, 16), canvasDynamicTimeDilation.color888(35, 34, 68));
-    canvasDynamicTimeDilation.drawString("TIME FASTER", 40, 50);
+    canvasDynamicTimeDilation.drawString("FASTER", 10, 50);
   }
 
-  canvasDynamicTimeDilation.pushSprite(5, 165, TFT_TRANSPARENT);
+  // Session total (right-aligned)
+  char buf[24];
+  hudFormatFixed(buf, sizeof(buf), offset_ns, 3, true);
+  hudFormatAppend(buf, sizeof(buf), " ns");
+  static HudDigitAtlas offsetDigits("0123456789.-+ ns");
+  canvasDynamicTimeDilation.setTextDatum(TR_DATUM);
+  offsetDigits.drawString(canvasDynamicTimeDilation, RobotoBoldCondensed12,
+                          canvasDynamicTimeDilation.color888(255, 255, 255), canvasDynamicTimeDilation.color888(35, 34, 68),
+                          buf, 137, 50);
+  canvasDynamicTimeDilation.setTextDatum(TL_DATUM);
+
+  hudCompositor.push(canvasDynamicTimeDilation, 5, 165, TFT_TRANSPARENT);
 }
 
 // ---- Create dynamic canvases with the same size as their static counterparts ----
 // Call once during setup to allocate all dynamic sprites.
 inline void createDynamicCanvases() {
-  canvasDynamicHeader.setColorDepth(32);
-  canvasDynamicHeader.createSprite(180, 25);
+  createHudLayer(canvasDynamicHeader, 180, 25, HUD_DYNAMIC_DEPTH);
 
-  canvasDynamicLineChart.setColorDepth(32);
-  canvasDynamicLineChart.createSprite(160, 40);
+  createHudLayer(canvasDynamicLineChart, 160, 40, HUD_DYNAMIC_DEPTH);
 
-  canvasDynamicVelocity.setColorDepth(32);
-  canvasDynamicVelocity.createSprite(310, 30);
+  createHudLayer(canvasDynamicVelocity, 310, 30, HUD_DYNAMIC_DEPTH);
 
-  canvasDynamicTotalVelocity.setColorDepth(32);
-  canvasDynamicTotalVelocity.createSprite(310, 30);
+  createHudLayer(canvasDynamicTotalVelocity, 310, 30, HUD_DYNAMIC_DEPTH);
 
-  canvasDynamicLocalGravity.setColorDepth(32);
-  canvasDynamicLocalGravity.createSprite(200, 45);
+  createHudLayer(canvasDynamicLocalGravity, 200, 45, HUD_DYNAMIC_DEPTH);
 
-  canvasDynamicTimeDilation.setColorDepth(32);
-  canvasDynamicTimeDilation.createSprite(145, 70);
+  createHudLayer(canvasDynamicTimeDilation, 145, 70, HUD_DYNAMIC_DEPTH);
 
-  canvasDynamicAltitude.setColorDepth(32);
-  canvasDynamicAltitude.createSprite(90, 90);
+  createHudLayer(canvasDynamicAltitude, 90, 90, HUD_DYNAMIC_DEPTH);
 
-  canvasDynamicLatitude.setColorDepth(32);
-  canvasDynamicLatitude.createSprite(120, 120);
+  createHudLayer(canvasDynamicLatitude, 120, 120, HUD_DYNAMIC_DEPTH);
 }
@@ -0,0 +1,139 @@
+#pragma once
+/*
+  relativistic_clock_modes.h  —  Mode-specialized time dilation kernels
+  --------------------------------------------------------------------
+  - One kernel per (GR mode, altitude source, simulation, arithmetic)
+    combination, all instantiated at compile time
+  - Each kernel is split into a position stage (lat/alt) and a motion
+    stage (speed/course); the pipeline keeps a function pointer to the
+    active position stage and swaps it only when the mode changes (touch
+    menu), so the per-frame path has no mode branches and no dead code
+    from the other modes
+
+  Usage:
+    PositionStageFn position = selectPositionStage<true>(mode);  // DoubleFloat path
+    MotionStageFn motion = selectMotionStage<true>();
+    PositionState ps;
+    DilationResult r;
+    position(sample, ps);
+    motion(sample, ps, r);
+*/
+
+#include "relativistic_clock_physics_df.h"
+
+// ---- Altitude used by the physics ----
+enum class AltSource : uint8_t { Baro = 0, Hae = 1 };
+
+struct ClockMode {
+  GrMode gr;
+  AltSource alt;
+  bool sim;  // physics at the simulated location (HUD keeps real values)
+};
+
+inline bool operator==(const ClockMode &a, const ClockMode &b) {
+  return a.gr == b.gr && a.alt == b.alt && a.sim == b.sim;
+}
+
+// Inputs of one frame; each kernel reads only the fields its mode needs
+struct DilationSample {
+  double velocity_kmh;
+  double azimuth_deg;
+  double latitude_deg;
+  double alt_baro_m;       // barometric altitude
+  double alt_hae_m;        // GNSS height above ellipsoid
+  double sim_latitude_deg;
+  double sim_altitude_m;
+};
+
+struct DilationResult {
+  double ns_per_s;
+  double gravity;             // m/s²
+  double earthRotationSpeed;  // m/s
+  double relativeVelocity;    // m/s
+};
+
+// Position-only part of a result: depends on lat/alt and mode, not on motion
+struct PositionState {
+  double gravity;             // m/s²
+  double earthRotationSpeed;  // m/s
+  double deltaGR;             // dimensionless
+};
+
+typedef void (*PositionStageFn)(const DilationSample &, PositionState &);
+typedef void (*MotionStageFn)(const DilationSample &, const PositionState &, DilationResult &);
+
+// ---- Kernel for one mode combination ----
+// DF = true: DoubleFloat path (float FPU); false: double path.
+// The split lets a caller skip position() while lat/alt are unchanged
+// (relativistic_clock_pipeline.h).
+template <GrMode G, AltSource A, bool Sim, bool DF>
+struct TimeDilationKernel {
+  static void position(const DilationSample &s, PositionState &ps) {
+    const double lat = Sim ? s.sim_latitude_deg : s.latitude_deg;
+    const double alt = Sim ? s.sim_altitude_m : (A == AltSource::Hae ? s.alt_hae_m : s.alt_baro_m);
+
+    if (DF) {
+      const GeodeticPointDF p(lat, alt);
+      ps.earthRotationSpeed = p.rotationSpeed().toDouble();
+      ps.gravity = p.localGravity();
+      ps.deltaGR = calcDeltaGRDF<G>(p).toDouble();
+    } else {
+      const GeodeticPoint p(lat, alt);
+      ps.earthRotationSpeed = p.rotationSpeed();
+      ps.gravity = p.localGravity();
+      ps.deltaGR = calcDeltaGR<G>(p);
+    }
+  }
+
+  static void motion(const DilationSample &s, const PositionState &ps, DilationResult &r) {
+    r.gravity = ps.gravity;
+    r.earthRotationSpeed = ps.earthRotationSpeed;
+    if (DF) {
+      const DoubleFloat deltaSR = calcDeltaSRDF(dfFromDouble(ps.earthRotationSpeed), s.velocity_kmh, s.azimuth_deg,
+                                                r.relativeVelocity);
+      r.ns_per_s = ((deltaSR + dfFromDouble(ps.deltaGR)) * 1e9f).toDouble();
+    } else {
+      const double deltaSR = calcDeltaSR(ps.earthRotationSpeed, s.velocity_kmh, s.azimuth_deg, r.relativeVelocity);
+      r.ns_per_s = (deltaSR + ps.deltaGR) * 1e9;
+    }
+  }
+};
+
+// ---- Position stage table [GrMode][AltSource][sim] ----
+// The motion stage does not depend on the mode (only on DF), so it needs
+// no table.
+template <bool DF>
+struct PositionStageTable {
+  static const PositionStageFn fn[3][2][2];
+};
+
+template <bool DF>
+const PositionStageFn PositionStageTable<DF>::fn[3][2][2] = {
+  { { &TimeDilationKernel<GrMode::Local, AltSource::Baro, false, DF>::position,
+      &TimeDilationKernel<GrMode::Local, AltSource::Baro, true, DF>::position },
+    { &TimeDilationKernel<GrMode::Local, AltSource::Hae, false, DF>::position,
+      &TimeDilationKernel<GrMode::Local, AltSource::Hae, true, DF>::position } },
+  { { &TimeDilationKernel<GrMode::Reference, AltSource::Baro, false, DF>::position,
+      &TimeDilationKernel<GrMode::Reference, AltSource::Baro, true, DF>::position },
+    { &TimeDilationKernel<GrMode::Reference, AltSource::Hae, false, DF>::position,
+      &TimeDilationKernel<GrMode::Reference, AltSource::Hae, true, DF>::position } },
+  { { &TimeDilationKernel<GrMode::Raw, AltSource::Baro, false, DF>::position,
+      &TimeDilationKernel<GrMode::Raw, AltSource::Baro, true, DF>::position },
+    { &TimeDilationKernel<GrMode::Raw, AltSource::Hae, false, DF>::position,
+      &TimeDilationKernel<GrMode::Raw, AltSource::Hae, true, DF>::position } },
+};
+
+template <bool DF>
+inline PositionStageFn selectPositionStage(const ClockMode &m) {
+  return PositionStageTable<DF>::fn[(int)m.gr][(int)m.alt][m.sim ? 1 : 0];
+}
+
+template <bool DF>
+inline MotionStageFn selectMotionStage() {
+  return &TimeDilationKernel<GrMode::Reference, AltSource::Baro, false, DF>::motion;
+}
+
+// Next GR mode in the touch-menu cycle (Local → Reference → Raw → Local)
+inline GrMode nextGrMode(GrMode g) {
+  return g == GrMode::Local ? GrMode::Reference : g == GrMode::Reference ? GrMode::Raw : GrMode::Local;
+}
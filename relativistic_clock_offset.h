@@ -0,0 +1,132 @@
+#pragma once
+/*
+  relativistic_clock_offset.h  —  Accumulated clock offset over a session
+  ----------------------------------------------------------------------
+  - Integrates the dilation rate (ns/s) of each fix over the real time
+    between fixes, taken from GNSS time (not millis(), which drifts and
+    also counts frames without a new fix)
+  - Trapezoid rule between consecutive fixes; time without a fix (an
+    epoch the receiver reports without one, noFix(), or more than
+    max_gap_s between fixes) is a gap: not integrated at the old rate,
+    the next fix starts a new chain
+  - Sums kept as double-double (TwoSum): at 25 Hz a multi-day session adds
+    ~1e7 increments of ~1e-5 ns to a total of hundreds of ns, and plain
+    double accumulation would lose the sub-ns digits
+  - Running min / max of the rate and time-weighted mean; O(1) per fix
+
+  Usage:
+    ClockOffsetIntegrator offset;
+    offset.addFix(gnssTimeSeconds(y, mo, d, h, mi, s, cs), ns_per_s);  // each fix
+    offset.noFix();       // fix lost
+    offset.offset_ns();   // total gain (+) / loss (-) since the first fix
+*/
+
+#include <math.h>
+#include <stdint.h>
+
+// Seconds since 2000-01-01 00:00:00 for a GNSS (UTC) date and time.
+// Days from civil date (proleptic Gregorian), valid for any year ≥ 2000.
+inline double gnssTimeSeconds(int year, int month, int day, int hour, int minute, int second, int centisecond) {
+  const int y = year - (month <= 2 ? 1 : 0);
+  const int era = y / 400;
+  const int yoe = y - era * 400;
+  const int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  const long days = (long)era * 146097 + doe - 730425;  // 719468 (to 1970) + 10957 (to 2000)
+  return days * 86400.0 + hour * 3600.0 + minute * 60.0 + second + centisecond * 0.01;
+}
+
+// ---- Compensated (double-double) running sum ----
+struct CompensatedSum {
+  double hi, lo;
+
+  CompensatedSum() : hi(0.0), lo(0.0) {}
+
+  inline void add(double x) {
+    // TwoSum: s + e == hi + x exactly
+    const double s = hi + x;
+    const double bb = s - hi;
+    const double e = (hi - (s - bb)) + (x - bb);
+    lo += e;
+    // Renormalize so hi carries the leading bits
+    hi = s + lo;
+    lo -= hi - s;
+  }
+
+  inline double value() const { return hi + lo; }
+};
+
+struct ClockOffsetIntegrator {
+  double max_gap_s;  // longer gaps between fixes are not integrated
+
+  // Counters
+  uint32_t fixes;     // fixes accepted
+  uint32_t gaps;      // chain restarts (fix lost, or > max_gap_s between fixes)
+  uint32_t rejected;  // non-increasing GNSS time (duplicate / out of order)
+
+  explicit ClockOffsetIntegrator(double maxGap_s = 10.0) : max_gap_s(maxGap_s) {
+    reset();
+  }
+
+  void reset() {
+    offset_ = CompensatedSum();
+    elapsed_ = CompensatedSum();
+    fixes = gaps = rejected = 0;
+    last_t_ = NAN;
+    last_rate_ = 0.0;
+    min_rate_ = INFINITY;
+    max_rate_ = -INFINITY;
+  }
+
+  // One fix: GNSS time (s, any fixed epoch) and dilation rate (ns/s).
+  // Returns false if the fix was rejected.
+  bool addFix(double t_s, double ns_per_s) {
+    if (isnan(t_s) || isnan(ns_per_s)) return false;
+    if (!isnan(last_t_)) {
+      const double dt = t_s - last_t_;
+      if (dt <= 0.0) {
+        ++rejected;
+        return false;
+      }
+      if (dt <= max_gap_s) {
+        offset_.add(0.5 * (last_rate_ + ns_per_s) * dt);
+        elapsed_.add(dt);
+      } else {
+        ++gaps;
+      }
+    }
+    last_t_ = t_s;
+    last_rate_ = ns_per_s;
+    if (ns_per_s < min_rate_) min_rate_ = ns_per_s;
+    if (ns_per_s > max_rate_) max_rate_ = ns_per_s;
+    ++fixes;
+    return true;
+  }
+
+  // Time without a fix: the interval up to the next fix is not
+  // integrated (counted once per outage)
+  void noFix() {
+    if (isnan(last_t_)) return;
+    last_t_ = NAN;
+    ++gaps;
+  }
+
+  // Total offset since the first fix (ns); + = clock ahead of the reference
+  inline double offset_ns() const { return offset_.value(); }
+
+  // Integrated time (s), gaps excluded
+  inline double elapsed_s() const { return elapsed_.value(); }
+
+  // Rate statistics (ns/s); NaN before the first fix / interval
+  inline double min_ns_per_s() const { return fixes ? min_rate_ : NAN; }
+  inline double max_ns_per_s() const { return fixes ? max_rate_ : NAN; }
+  inline double mean_ns_per_s() const {
+    const double t = elapsed_s();
+    return t > 0.0 ? offset_ns() / t : NAN;
+  }
+
+private:
+  CompensatedSum offset_, elapsed_;
+  double last_t_, last_rate_;
+  double min_rate_, max_rate_;
+};
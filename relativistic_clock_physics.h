@@ -0,0 +1,230 @@
+#pragma once
+/*
+  relativistic_clock_physics.h  —  Header-only relativistic physics core
+  ---------------------------------------------------------------------
+  - WGS84 geodesy: geocentric radius, Earth-rotation speed, local gravity
+  - GeodeticPoint: sin/cos(latitude) and radii computed once per fix
+  - Time dilation (SR + GR) per fix, in ns/s
+  - Batch entry point over structure-of-arrays inputs (log replay, maps)
+  - No Arduino dependency: builds on a plain host toolchain (g++/clang++)
+
+  The device sketch and host tools call exactly the same functions, so a
+  replayed track produces the same numbers the clock showed.
+
+  Usage (host):
+    #include "relativistic_clock_physics.h"
+
+    DilationBatchIn  in  = { lat, alt, speed_kmh, azimuth };
+    DilationBatchOut out = { ns_per_s, gravity, vRot, vTot };
+    calcTimeDilationBatch(in, out, count, 1);   // GR mode 1
+
+  Notes:
+   - Angles in degrees, altitude in meters above the WGS84 ellipsoid.
+   - Degree→radian conversion uses the same constant as Arduino's radians().
+*/
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ---- Physical constants ----
+static constexpr double SPEED_OF_LIGHT = 299792458.0;  // m/s
+static constexpr double OMEGA_EARTH    = 7.292115e-5;  // rad/s
+
+// Absolute GR – required constants (no centrifugal term)
+static constexpr double GM_EARTH = 3.986004418e14;   // m^3/s^2
+static constexpr double WGS84_A  = 6378137.0;        // m
+static constexpr double WGS84_B  = 6356752.314245;   // m
+static constexpr double WGS84_E2 = 1.0 - (WGS84_B * WGS84_B) / (WGS84_A * WGS84_A);
+
+// Normal gravity (Somigliana) – classic WGS84 constants; the formula's
+// e² is WGS84_E2 (shares sqrt(1 - e² sin²φ) with the prime-vertical radius)
+static constexpr double WGS84_GE          = 9.7803253359;      // m/s² at equator
+static constexpr double SOMIGLIANA_K      = 0.00193185265241;
+static constexpr double FREE_AIR_GRADIENT = 3.086e-6;          // m/s² per meter
+
+// Same value as Arduino's DEG_TO_RAD
+static constexpr double RAD_PER_DEG = 0.017453292519943295769236907684886;
+
+static inline double deg2rad(double deg) {
+  return deg * RAD_PER_DEG;
+}
+
+// Gravitational potential at the Equator, 0 m HAE (GR mode 1 reference).
+// There r = N·cos(0) = a exactly, so Phi_ref needs no trig at runtime.
+static constexpr double PHI_EQUATOR_0 = -GM_EARTH / WGS84_A;  // m²/s²
+
+// ---- Geodetic state of one fix ----
+// Everything the rotation, gravity and potential terms need, computed once:
+// one sin/cos of latitude and two square roots per fix.
+struct GeodeticPoint {
+  double sin_lat, cos_lat;
+  double w;           // sqrt(1 - e² sin²φ)
+  double N;           // prime-vertical radius of curvature (m)
+  double altitude_m;  // above the WGS84 ellipsoid
+  double radius_m;    // geocentric |r| (ECEF) at altitude
+
+  GeodeticPoint(double latitude_deg, double alt_m) {
+    const double phi = deg2rad(latitude_deg);
+    sin_lat = sin(phi);
+    cos_lat = cos(phi);
+    w = sqrt(1.0 - WGS84_E2 * sin_lat * sin_lat);
+    N = WGS84_A / w;
+    altitude_m = alt_m;
+    radius_m = radiusAt(alt_m);
+  }
+
+  // Geocentric radius at another altitude on the same normal (no trig)
+  inline double radiusAt(double h_m) const {
+    const double X = (N + h_m) * cos_lat;
+    const double Z = (N * (1.0 - WGS84_E2) + h_m) * sin_lat;
+    return sqrt(X * X + Z * Z);
+  }
+
+  // Earth rotation tangential speed (m/s): ω · distance to the spin axis
+  inline double rotationSpeed() const {
+    return OMEGA_EARTH * ((N + altitude_m) * cos_lat);
+  }
+
+  // Somigliana normal gravity + linear free-air correction (m/s²)
+  inline double localGravity() const {
+    // Optional clamp to avoid absurd inputs (e.g., bad readings)
+    double h = altitude_m;
+    if (h < -500.0) h = -500.0;
+    if (h > 20000.0) h = 20000.0;
+
+    const double g0 = WGS84_GE * (1.0 + SOMIGLIANA_K * sin_lat * sin_lat) / w;
+
+    // Linear free-air correction (~0.3086 mGal/m = 3.086e-6 m/s² per meter)
+    return g0 - FREE_AIR_GRADIENT * h;
+  }
+
+  // Gravitational potential only, no centrifugal term (m²/s²)
+  inline double potential() const {
+    return -GM_EARTH / radius_m;
+  }
+};
+
+// Geocentric radius |r| for geodetic latitude and altitude
+inline double geocentric_radius_m(double lat_deg, double h_m) {
+  return GeodeticPoint(lat_deg, h_m).radius_m;
+}
+
+// ---- Earth rotation tangential speed (m/s) at given lat/alt ----
+inline double calcEarthRotationSpeed(double latitude_deg, double altitude_m) {
+  return GeodeticPoint(latitude_deg, altitude_m).rotationSpeed();
+}
+
+inline double calcLocalGravity(double latitude_deg, double altitude_m) {
+  return GeodeticPoint(latitude_deg, altitude_m).localGravity();
+}
+
+
+// ---- GR mode ----
+// Local     = 0: g*h/c^2
+// Reference = 1: absolute WITH reference ((Phi_here - Phi_ref)/c^2)
+// Raw       = 2: absolute WITHOUT reference (Phi_here/c^2)
+enum class GrMode : uint8_t { Local = 0, Reference = 1, Raw = 2 };
+
+// ---- GR term (dimensionless, ×1e9 = ns/s). Depends on position only. ----
+// GR mode as a template parameter: each instantiation carries only its own
+// term (used by the mode-specialized kernels, relativistic_clock_modes.h).
+template <GrMode G>
+inline double calcDeltaGR(const GeodeticPoint &p) {
+  if (G == GrMode::Local) {
+    // Local GR WITHOUT centrifugal: g_pure ≈ GM / r0^2
+    const double r0 = p.radiusAt(0.0);
+    const double g_pure = GM_EARTH / (r0 * r0);
+    return (g_pure * p.altitude_m) / (SPEED_OF_LIGHT * SPEED_OF_LIGHT);
+
+  } else if (G == GrMode::Reference) {
+    // (1) Absolute WITH reference (Equator, 0 m); potential only
+    return (p.potential() - PHI_EQUATOR_0) / (SPEED_OF_LIGHT * SPEED_OF_LIGHT);
+
+  } else {  // GrMode::Raw
+    // (2) Absolute WITHOUT reference (raw value)
+    return p.potential() / (SPEED_OF_LIGHT * SPEED_OF_LIGHT);
+  }
+}
+
+// ---- SR term (dimensionless, negative). Horizontal ground speed only. ----
+// vRot: Earth rotation speed at the fix (m/s, Eastward)
+inline double calcDeltaSR(double vRot, double velocity_kmh, double azimuth_deg, double &out_relativeVelocity) {
+  // Convert to m/s
+  const double v = velocity_kmh / 3.6;
+
+  // Horizontal components (0° = North, 90° = East)
+  const double vE = v * sin(deg2rad(azimuth_deg));  // East (+)
+  const double vN = v * cos(deg2rad(azimuth_deg));  // North (+)
+
+  // Total inertial-frame speed (rotation + own motion)
+  const double vTot = sqrt((vRot + vE) * (vRot + vE) + vN * vN);
+  out_relativeVelocity = vTot;
+
+  // SR: slows clock (negative)
+  return -(vTot * vTot) / (2.0 * SPEED_OF_LIGHT * SPEED_OF_LIGHT);
+}
+
+// ---- Time dilation (returns ns/s) ----
+template <GrMode G>
+inline double calcTimeDilationT(const GeodeticPoint &p, double velocity_kmh, double azimuth_deg,
+                                double &out_gravity, double &out_earthRotationSpeed, double &out_relativeVelocity) {
+  // Earth rotation at location (Eastward)
+  const double vRot = p.rotationSpeed();
+  out_earthRotationSpeed = vRot;
+
+  // Local gravity
+  out_gravity = p.localGravity();
+
+  const double deltaSR = calcDeltaSR(vRot, velocity_kmh, azimuth_deg, out_relativeVelocity);
+  const double deltaGR = calcDeltaGR<G>(p);
+
+  // Net (ns per second)
+  return (deltaSR + deltaGR) * 1e9;
+}
+
+// Runtime GR mode (0, 1 or 2, see GrMode); host tools and batch paths
+inline double calcTimeDilation(const GeodeticPoint &p, double velocity_kmh, double azimuth_deg,
+                               double &out_gravity, double &out_earthRotationSpeed, double &out_relativeVelocity,
+                               int grMode = 1) {
+  switch (grMode) {
+    case 0: return calcTimeDilationT<GrMode::Local>(p, velocity_kmh, azimuth_deg, out_gravity, out_earthRotationSpeed, out_relativeVelocity);
+    case 1: return calcTimeDilationT<GrMode::Reference>(p, velocity_kmh, azimuth_deg, out_gravity, out_earthRotationSpeed, out_relativeVelocity);
+    default: return calcTimeDilationT<GrMode::Raw>(p, velocity_kmh, azimuth_deg, out_gravity, out_earthRotationSpeed, out_relativeVelocity);
+  }
+}
+
+inline double calcTimeDilation(double velocity_kmh, double azimuth_deg, double latitude_deg, double altitude_m,
+                               double &out_gravity, double &out_earthRotationSpeed, double &out_relativeVelocity,
+                               int grMode = 1) {
+  return calcTimeDilation(GeodeticPoint(latitude_deg, altitude_m), velocity_kmh, azimuth_deg,
+                          out_gravity, out_earthRotationSpeed, out_relativeVelocity, grMode);
+}
+
+
+// ---- Batch time dilation over structure-of-arrays ----
+// Inputs and outputs are parallel arrays of 'count' elements; every element
+// goes through calcTimeDilation() unchanged, so results match the device.
+struct DilationBatchIn {
+  const double *latitude_deg;
+  const double *altitude_m;
+  const double *velocity_kmh;
+  const double *azimuth_deg;
+};
+
+struct DilationBatchOut {
+  double *ns_per_s;
+  double *gravity;                // m/s²
+  double *earthRotationSpeed;     // m/s
+  double *relativeVelocity;       // m/s
+};
+
+inline void calcTimeDilationBatch(const DilationBatchIn &in, const DilationBatchOut &out,
+                                  size_t count, int grMode = 1) {
+  for (size_t i = 0; i < count; ++i) {
+    out.ns_per_s[i] = calcTimeDilation(in.velocity_kmh[i], in.azimuth_deg[i],
+                                       in.latitude_deg[i], in.altitude_m[i],
+                                       out.gravity[i], out.earthRotationSpeed[i],
+                                       out.relativeVelocity[i], grMode);
+  }
+}
@@ -0,0 +1,182 @@
+#pragma once
+/*
+  relativistic_clock_physics_df.h  —  Single-precision physics path (FPU)
+  ----------------------------------------------------------------------
+  - Same model as calcTimeDilation() (relativistic_clock_physics.h), built
+    on DoubleFloat so the ESP32-S3 runs it on its float FPU instead of the
+    software double emulation
+  - sin/cos in degrees from a 1° table (built once) + short Taylor term,
+    so no double-precision libm call remains per fix
+  - GR mode 1 uses Phi - Phi_ref = GM·(r - a)/(a·r), avoiding the
+    cancellation of two ~6e7 m²/s² potentials
+
+  Accuracy vs. the double path (tools/physics_bench, lat ±90°,
+  alt -500..20000 m, speed 0..3000 km/h, all azimuths, GR modes 0–2):
+   - time dilation: |Δ| ≤ 1e-10 ns/h (the HUD prints a float, whose ULP
+     at a few ns/h is ~5e-7)
+   - rotation / total speed: ≤ 1e-10 m/s
+   - gravity: ≤ 1e-6 m/s² (returned through float; the HUD shows 1e-5)
+
+  Usage:
+    double g, vRot, vTot;
+    double ns_s = calcTimeDilationDF(vel_kmh, az_deg, lat_deg, alt_m, g, vRot, vTot, GR_MODE);
+*/
+
+#include "relativistic_clock_physics.h"
+#include "double_float.h"
+
+static constexpr DoubleFloat DF_RAD_PER_DEG = dfFromDouble(RAD_PER_DEG);
+static constexpr DoubleFloat DF_WGS84_A = dfFromDouble(WGS84_A);
+static constexpr DoubleFloat DF_WGS84_E2 = dfFromDouble(WGS84_E2);
+static constexpr DoubleFloat DF_ONE_MINUS_E2 = dfFromDouble(1.0 - WGS84_E2);
+static constexpr DoubleFloat DF_OMEGA_EARTH = dfFromDouble(OMEGA_EARTH);
+static constexpr DoubleFloat DF_WGS84_GE = dfFromDouble(WGS84_GE);
+static constexpr DoubleFloat DF_SOMIGLIANA_K = dfFromDouble(SOMIGLIANA_K);
+static constexpr DoubleFloat DF_INV_3_6 = dfFromDouble(1.0 / 3.6);
+static constexpr DoubleFloat DF_GM = dfFromDouble(GM_EARTH);
+static constexpr DoubleFloat DF_INV_C2 = dfFromDouble(1.0 / (SPEED_OF_LIGHT * SPEED_OF_LIGHT));
+static constexpr DoubleFloat DF_INV_2C2 = dfFromDouble(1.0 / (2.0 * SPEED_OF_LIGHT * SPEED_OF_LIGHT));
+static constexpr DoubleFloat DF_GM_OVER_A_C2 = dfFromDouble(GM_EARTH / WGS84_A / (SPEED_OF_LIGHT * SPEED_OF_LIGHT));
+
+// ---- sin/cos of whole degrees 0..90, split into float pairs ----
+struct DfTrigTable {
+  DoubleFloat s[91], c[91];
+  DfTrigTable() {
+    for (int k = 0; k <= 90; ++k) {
+      s[k] = dfFromDouble(sin(k * RAD_PER_DEG));
+      c[k] = dfFromDouble(k == 90 ? 0.0 : cos(k * RAD_PER_DEG));
+    }
+  }
+};
+
+inline const DfTrigTable &dfTrigTable() {
+  static const DfTrigTable table;  // built on first use (boot)
+  return table;
+}
+
+// sin/cos of an angle in degrees (any range), DoubleFloat accuracy
+inline void dfSinCosDeg(DoubleFloat deg, DoubleFloat &s_out, DoubleFloat &c_out) {
+  const DfTrigTable &t = dfTrigTable();
+
+  // Quadrant and remainder in [0, 90]
+  const float qf = floorf(deg.hi / 90.0f);
+  const DoubleFloat rem = deg - 90.0f * qf;
+  int k = (int)lroundf(rem.hi);
+  if (k < 0) k = 0;
+  if (k > 90) k = 90;
+
+  // Small angle r (|r| ≲ 0.5°): sin r = r - r³/6 + r⁵/120, cos r = 1 - r²/2 + r⁴/24
+  // r²/2 reaches 4e-5, so it is kept as DoubleFloat; higher terms fit in float.
+  const DoubleFloat r = (rem - (float)k) * DF_RAD_PER_DEG;
+  const DoubleFloat r2 = dfSqr(r);
+  const DoubleFloat sin_r = r + r.hi * r2.hi * (-1.0f / 6.0f + r2.hi * (1.0f / 120.0f));
+  const DoubleFloat cos_r = (DoubleFloat(1.0f) + r2 * -0.5f) + r2.hi * r2.hi * (1.0f / 24.0f);
+
+  const DoubleFloat s = t.s[k] * cos_r + t.c[k] * sin_r;
+  const DoubleFloat c = t.c[k] * cos_r - t.s[k] * sin_r;
+
+  switch (((int)qf) & 3) {
+    case 0: s_out = s; c_out = c; break;
+    case 1: s_out = c; c_out = -s; break;
+    case 2: s_out = -s; c_out = -c; break;
+    default: s_out = -c; c_out = s; break;
+  }
+}
+
+// ---- Geodetic state of one fix (DoubleFloat version of GeodeticPoint) ----
+struct GeodeticPointDF {
+  DoubleFloat sin_lat, cos_lat;
+  DoubleFloat w;           // sqrt(1 - e² sin²φ)
+  DoubleFloat N;           // prime-vertical radius of curvature (m)
+  DoubleFloat altitude_m;
+
+  GeodeticPointDF(double latitude_deg, double alt_m) {
+    dfSinCosDeg(dfFromDouble(latitude_deg), sin_lat, cos_lat);
+    w = dfSqrt(DoubleFloat(1.0f) - DF_WGS84_E2 * dfSqr(sin_lat));
+    N = DF_WGS84_A / w;
+    altitude_m = dfFromDouble(alt_m);
+  }
+
+  inline DoubleFloat radiusAt(DoubleFloat h) const {
+    const DoubleFloat X = (N + h) * cos_lat;
+    const DoubleFloat Z = (N * DF_ONE_MINUS_E2 + h) * sin_lat;
+    return dfSqrt(dfSqr(X) + dfSqr(Z));
+  }
+
+  inline DoubleFloat rotationSpeed() const {
+    return DF_OMEGA_EARTH * ((N + altitude_m) * cos_lat);
+  }
+
+  inline float localGravity() const {
+    // Same clamp as GeodeticPoint::localGravity()
+    float h = altitude_m.toFloat();
+    if (h < -500.0f) h = -500.0f;
+    if (h > 20000.0f) h = 20000.0f;
+
+    const DoubleFloat g0 = DF_WGS84_GE * (DoubleFloat(1.0f) + DF_SOMIGLIANA_K * dfSqr(sin_lat)) / w;
+    return (g0 - (float)FREE_AIR_GRADIENT * h).toFloat();
+  }
+};
+
+// ---- GR term (dimensionless), DoubleFloat path ----
+template <GrMode G>
+inline DoubleFloat calcDeltaGRDF(const GeodeticPointDF &p) {
+  if (G == GrMode::Local) {
+    const DoubleFloat r0 = p.radiusAt(DoubleFloat(0.0f));
+    return DF_GM / dfSqr(r0) * p.altitude_m * DF_INV_C2;
+  } else if (G == GrMode::Reference) {
+    // (Phi_here - Phi_ref)/c² = GM/(a c²) · (r - a)/r
+    const DoubleFloat r = p.radiusAt(p.altitude_m);
+    return DF_GM_OVER_A_C2 * ((r - DF_WGS84_A) / r);
+  } else {
+    const DoubleFloat r = p.radiusAt(p.altitude_m);
+    return -(DF_GM / r) * DF_INV_C2;
+  }
+}
+
+// ---- SR term (dimensionless, negative), DoubleFloat path ----
+inline DoubleFloat calcDeltaSRDF(DoubleFloat vRot, double velocity_kmh, double azimuth_deg,
+                                 double &out_relativeVelocity) {
+  // Horizontal components (0° = North, 90° = East)
+  const DoubleFloat v = dfFromDouble(velocity_kmh) * DF_INV_3_6;
+  DoubleFloat sin_az, cos_az;
+  dfSinCosDeg(dfFromDouble(azimuth_deg), sin_az, cos_az);
+  const DoubleFloat vE = v * sin_az;
+  const DoubleFloat vN = v * cos_az;
+
+  // Earth rotation + own motion
+  const DoubleFloat vTot2 = dfSqr(vRot + vE) + dfSqr(vN);
+  out_relativeVelocity = dfSqrt(vTot2).toDouble();
+
+  // SR: slows clock (negative)
+  return -(vTot2 * DF_INV_2C2);
+}
+
+// ---- Time dilation (returns ns/s), DoubleFloat path ----
+// Drop-in for calcTimeDilationT<G>(); doubles only at the interface.
+template <GrMode G>
+inline double calcTimeDilationDFT(double velocity_kmh, double azimuth_deg, double latitude_deg, double altitude_m,
+                                  double &out_gravity, double &out_earthRotationSpeed, double &out_relativeVelocity) {
+  const GeodeticPointDF p(latitude_deg, altitude_m);
+
+  const DoubleFloat vRot = p.rotationSpeed();
+  out_earthRotationSpeed = vRot.toDouble();
+  out_gravity = p.localGravity();
+
+  const DoubleFloat deltaSR = calcDeltaSRDF(vRot, velocity_kmh, azimuth_deg, out_relativeVelocity);
+  const DoubleFloat deltaGR = calcDeltaGRDF<G>(p);
+
+  // Net (ns per second)
+  return ((deltaSR + deltaGR) * 1e9f).toDouble();
+}
+
+// Runtime GR mode; drop-in for calcTimeDilation()
+inline double calcTimeDilationDF(double velocity_kmh, double azimuth_deg, double latitude_deg, double altitude_m,
+                                 double &out_gravity, double &out_earthRotationSpeed, double &out_relativeVelocity,
+                                 int grMode = 1) {
+  switch (grMode) {
+    case 0: return calcTimeDilationDFT<GrMode::Local>(velocity_kmh, azimuth_deg, latitude_deg, altitude_m, out_gravity, out_earthRotationSpeed, out_relativeVelocity);
+    case 1: return calcTimeDilationDFT<GrMode::Reference>(velocity_kmh, azimuth_deg, latitude_deg, altitude_m, out_gravity, out_earthRotationSpeed, out_relativeVelocity);
+    default: return calcTimeDilationDFT<GrMode::Raw>(velocity_kmh, azimuth_deg, latitude_deg, altitude_m, out_gravity, out_earthRotationSpeed, out_relativeVelocity);
+  }
+}
@@ -0,0 +1,193 @@
+#pragma once
+/*
+  relativistic_clock_physics_simd.h  —  SIMD batch geodesy / dilation (host)
+  -------------------------------------------------------------------------
+  - AVX2+FMA (4 lanes) and AVX-512F (8 lanes) versions of:
+      geocentric_radius_m, calcEarthRotationSpeed, calcLocalGravity,
+      calcTimeDilation (full kernel, all GR modes)
+  - Runtime ISA dispatch; portable fallback = the scalar reference batch
+    from relativistic_clock_physics.h (also used on non-x86 targets)
+  - Kernels are compiled per ISA with target pragmas, so no -mavx flags are
+    needed and one binary runs everywhere
+
+  Accuracy vs. the scalar libm reference (tools/physics_bench, 4M random
+  fixes over lat ±90°, alt -500..20000 m, speed 0..3000 km/h, az 0..360°):
+   - vector sincos (Cephes polynomials, |x| ≤ 2π): ≤ 2 ULP
+   - geocentric radius, rotation speed: ≤ 4 ULP; gravity: ≤ 3 ULP
+   - total speed: ≤ 1e-12 m/s absolute (it crosses zero when westward
+     motion cancels rotation, so ULPs are not meaningful there)
+   - time dilation: ≤ 2e-12 ns/h absolute, all GR modes
+  AVX2 and AVX-512 results are bit-identical to each other.
+
+  Usage (host):
+    #include "relativistic_clock_physics_simd.h"
+    calcTimeDilationBatchSimd(in, out, count, 1);            // best ISA
+    calcTimeDilationBatchSimd(in, out, count, 1, SimdIsa::Avx2);
+*/
+
+#include "relativistic_clock_physics.h"
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RC_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define RC_SIMD_X86 0
+#endif
+
+enum class SimdIsa : uint8_t { Scalar = 0, Avx2 = 1, Avx512 = 2 };
+
+inline const char *simdIsaName(SimdIsa isa) {
+  switch (isa) {
+    case SimdIsa::Avx2: return "AVX2";
+    case SimdIsa::Avx512: return "AVX-512";
+    default: return "scalar";
+  }
+}
+
+inline bool simdIsaSupported(SimdIsa isa) {
+#if RC_SIMD_X86
+  switch (isa) {
+    case SimdIsa::Avx2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case SimdIsa::Avx512: return __builtin_cpu_supports("avx512f");
+    default: return true;
+  }
+#else
+  return isa == SimdIsa::Scalar;
+#endif
+}
+
+inline SimdIsa simdBestIsa() {
+  static const SimdIsa best = simdIsaSupported(SimdIsa::Avx512) ? SimdIsa::Avx512
+                              : simdIsaSupported(SimdIsa::Avx2) ? SimdIsa::Avx2
+                                                                : SimdIsa::Scalar;
+  return best;
+}
+
+#if RC_SIMD_X86
+
+// ===== AVX2 + FMA (4 lanes) =====
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+namespace rc_simd_avx2 {
+static constexpr size_t W = 4;
+struct V {
+  __m256d v;
+};
+typedef __m256d M;
+static inline V loadv(const double *p) { return V{ _mm256_loadu_pd(p) }; }
+static inline void storev(double *p, V a) { _mm256_storeu_pd(p, a.v); }
+static inline V set1(double x) { return V{ _mm256_set1_pd(x) }; }
+static inline V operator+(V a, V b) { return V{ _mm256_add_pd(a.v, b.v) }; }
+static inline V operator-(V a, V b) { return V{ _mm256_sub_pd(a.v, b.v) }; }
+static inline V operator*(V a, V b) { return V{ _mm256_mul_pd(a.v, b.v) }; }
+static inline V operator/(V a, V b) { return V{ _mm256_div_pd(a.v, b.v) }; }
+static inline V sqrtv(V a) { return V{ _mm256_sqrt_pd(a.v) }; }
+static inline V minv(V a, V b) { return V{ _mm256_min_pd(a.v, b.v) }; }
+static inline V maxv(V a, V b) { return V{ _mm256_max_pd(a.v, b.v) }; }
+static inline V fmaddv(V a, V b, V c) { return V{ _mm256_fmadd_pd(a.v, b.v, c.v) }; }
+static inline V roundv(V a) { return V{ _mm256_round_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+static inline V floorv(V a) { return V{ _mm256_floor_pd(a.v) }; }
+static inline M cmpeq(V a, V b) { return _mm256_cmp_pd(a.v, b.v, _CMP_EQ_OQ); }
+static inline M cmpge(V a, V b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ); }
+static inline M mor(M a, M b) { return _mm256_or_pd(a, b); }
+static inline V selectv(M m, V a, V b) { return V{ _mm256_blendv_pd(b.v, a.v, m) }; }
+#include "relativistic_clock_physics_simd_kernels.inc"
+}  // namespace rc_simd_avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+// ===== AVX-512F (8 lanes) =====
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+// GCC 12 flags _mm512_undefined_pd() inside the intrinsics themselves
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+namespace rc_simd_avx512 {
+static constexpr size_t W = 8;
+struct V {
+  __m512d v;
+};
+typedef __mmask8 M;
+static inline V loadv(const double *p) { return V{ _mm512_loadu_pd(p) }; }
+static inline void storev(double *p, V a) { _mm512_storeu_pd(p, a.v); }
+static inline V set1(double x) { return V{ _mm512_set1_pd(x) }; }
+static inline V operator+(V a, V b) { return V{ _mm512_add_pd(a.v, b.v) }; }
+static inline V operator-(V a, V b) { return V{ _mm512_sub_pd(a.v, b.v) }; }
+static inline V operator*(V a, V b) { return V{ _mm512_mul_pd(a.v, b.v) }; }
+static inline V operator/(V a, V b) { return V{ _mm512_div_pd(a.v, b.v) }; }
+static inline V sqrtv(V a) { return V{ _mm512_sqrt_pd(a.v) }; }
+static inline V minv(V a, V b) { return V{ _mm512_min_pd(a.v, b.v) }; }
+static inline V maxv(V a, V b) { return V{ _mm512_max_pd(a.v, b.v) }; }
+static inline V fmaddv(V a, V b, V c) { return V{ _mm512_fmadd_pd(a.v, b.v, c.v) }; }
+static inline V roundv(V a) { return V{ _mm512_roundscale_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+static inline V floorv(V a) { return V{ _mm512_roundscale_pd(a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC) }; }
+static inline M cmpeq(V a, V b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_EQ_OQ); }
+static inline M cmpge(V a, V b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_GE_OQ); }
+static inline M mor(M a, M b) { return (M)(a | b); }
+static inline V selectv(M m, V a, V b) { return V{ _mm512_mask_blend_pd(m, b.v, a.v) }; }
+#include "relativistic_clock_physics_simd_kernels.inc"
+}  // namespace rc_simd_avx512
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+#endif  // RC_SIMD_X86
+
+
+// ---- Dispatching batch entry points ----
+// Unsupported ISAs fall back to the scalar reference.
+inline void geocentric_radius_m_batch(const double *lat_deg, const double *h_m, double *out,
+                                      size_t count, SimdIsa isa = simdBestIsa()) {
+#if RC_SIMD_X86
+  if (isa == SimdIsa::Avx512 && simdIsaSupported(isa)) return rc_simd_avx512::geocentricRadiusBatch(lat_deg, h_m, out, count);
+  if (isa == SimdIsa::Avx2 && simdIsaSupported(isa)) return rc_simd_avx2::geocentricRadiusBatch(lat_deg, h_m, out, count);
+#endif
+  (void)isa;
+  for (size_t i = 0; i < count; ++i) out[i] = geocentric_radius_m(lat_deg[i], h_m[i]);
+}
+
+inline void calcEarthRotationSpeedBatch(const double *lat_deg, const double *alt_m, double *out,
+                                        size_t count, SimdIsa isa = simdBestIsa()) {
+#if RC_SIMD_X86
+  if (isa == SimdIsa::Avx512 && simdIsaSupported(isa)) return rc_simd_avx512::earthRotationSpeedBatch(lat_deg, alt_m, out, count);
+  if (isa == SimdIsa::Avx2 && simdIsaSupported(isa)) return rc_simd_avx2::earthRotationSpeedBatch(lat_deg, alt_m, out, count);
+#endif
+  (void)isa;
+  for (size_t i = 0; i < count; ++i) out[i] = calcEarthRotationSpeed(lat_deg[i], alt_m[i]);
+}
+
+inline void calcLocalGravityBatch(const double *lat_deg, const double *alt_m, double *out,
+                                  size_t count, SimdIsa isa = simdBestIsa()) {
+#if RC_SIMD_X86
+  if (isa == SimdIsa::Avx512 && simdIsaSupported(isa)) return rc_simd_avx512::localGravityBatch(lat_deg, alt_m, out, count);
+  if (isa == SimdIsa::Avx2 && simdIsaSupported(isa)) return rc_simd_avx2::localGravityBatch(lat_deg, alt_m, out, count);
+#endif
+  (void)isa;
+  for (size_t i = 0; i < count; ++i) out[i] = calcLocalGravity(lat_deg[i], alt_m[i]);
+}
+
+inline void calcTimeDilationBatchSimd(const DilationBatchIn &in, const DilationBatchOut &out,
+                                      size_t count, int grMode = 1, SimdIsa isa = simdBestIsa()) {
+#if RC_SIMD_X86
+  if (isa == SimdIsa::Avx512 && simdIsaSupported(isa)) return rc_simd_avx512::timeDilationBatch(in, out, count, grMode);
+  if (isa == SimdIsa::Avx2 && simdIsaSupported(isa)) return rc_simd_avx2::timeDilationBatch(in, out, count, grMode);
+#endif
+  (void)isa;
+  calcTimeDilationBatch(in, out, count, grMode);
+}
@@ -0,0 +1,133 @@
+#pragma once
+/*
+  relativistic_clock_pipeline.h  —  Incremental physics evaluation
+  ---------------------------------------------------------------
+  - Every input carries a sequence number, bumped only when its value
+    actually changes (a repeated NMEA value or barometer reading is not
+    a change)
+  - Two stages, each remembering the input sequences it last used:
+      position: lat, active altitude, mode → vRot, g, GR term
+      motion:   speed, azimuth, position  → total speed, SR term, ns/s
+    A stage runs only when one of its inputs moved; a new speed alone
+    does not recompute gravity or the potential
+  - Counters for evaluations performed vs. skipped, per stage
+
+  Usage:
+    PhysicsPipeline<true> pipe;              // DoubleFloat stages
+    pipe.setMode(mode);
+    pipe.latitude.set(lat);  pipe.velocity.set(kmh);  ...
+    if (pipe.update()) use(pipe.result);     // true = result changed
+*/
+
+#include "relativistic_clock_modes.h"
+#include <string.h>
+
+// ---- One input value with its change sequence ----
+struct PipelineInput {
+  double value;
+  uint32_t seq;
+
+  PipelineInput() : value(0.0), seq(0) {}
+
+  // Returns true (and bumps seq) only if the value changed
+  inline bool set(double v) {
+    if (v == value) return false;
+    value = v;
+    ++seq;
+    return true;
+  }
+};
+
+struct PipelineStats {
+  uint32_t position_evals, position_skips;
+  uint32_t motion_evals, motion_skips;
+};
+
+template <bool DF>
+struct PhysicsPipeline {
+  // Inputs (NaN must be replaced before set(); see loop())
+  PipelineInput latitude, alt_baro, alt_hae, velocity, azimuth;
+
+  // Outputs
+  DilationResult result;
+  uint32_t result_seq;  // bumped each time result is recomputed
+  PipelineStats stats;
+
+  PhysicsPipeline() : result_seq(0), mode_seq_(1), pos_seq_(0) {
+    memset(&result, 0, sizeof(result));
+    memset(&stats, 0, sizeof(stats));
+    memset(&pos_, 0, sizeof(pos_));
+    memset(&pos_dep_, 0, sizeof(pos_dep_));
+    memset(&mot_dep_, 0, sizeof(mot_dep_));
+    memset(&sample_, 0, sizeof(sample_));
+    setMode(ClockMode{ GrMode::Reference, AltSource::Baro, false });
+  }
+
+  // Simulated location (used only while mode.sim is set)
+  void setSimLocation(double lat_deg, double alt_m) {
+    sample_.sim_latitude_deg = lat_deg;
+    sample_.sim_altitude_m = alt_m;
+    ++mode_seq_;
+  }
+
+  // Swaps the stage functions; forces the position stage to run again
+  void setMode(const ClockMode &m) {
+    mode_ = m;
+    position_ = selectPositionStage<DF>(m);
+    motion_ = selectMotionStage<DF>();
+    ++mode_seq_;
+  }
+
+  const ClockMode &mode() const { return mode_; }
+
+  // Runs the stages whose inputs changed. Returns true if result changed.
+  bool update() {
+    // Position stage: while simulating, lat/alt inputs are not used
+    Deps pd;
+    pd.a = mode_seq_;
+    pd.b = mode_.sim ? 0 : latitude.seq;
+    pd.c = mode_.sim ? 0 : (mode_.alt == AltSource::Hae ? alt_hae.seq : alt_baro.seq);
+    if (pd == pos_dep_) {
+      ++stats.position_skips;
+    } else {
+      sample_.latitude_deg = latitude.value;
+      sample_.alt_baro_m = alt_baro.value;
+      sample_.alt_hae_m = alt_hae.value;
+      position_(sample_, pos_);
+      pos_dep_ = pd;
+      ++pos_seq_;
+      ++stats.position_evals;
+    }
+
+    // Motion stage
+    Deps md;
+    md.a = pos_seq_;
+    md.b = velocity.seq;
+    md.c = azimuth.seq;
+    if (md == mot_dep_) {
+      ++stats.motion_skips;
+      return false;
+    }
+    sample_.velocity_kmh = velocity.value;
+    sample_.azimuth_deg = azimuth.value;
+    motion_(sample_, pos_, result);
+    mot_dep_ = md;
+    ++result_seq;
+    ++stats.motion_evals;
+    return true;
+  }
+
+private:
+  struct Deps {
+    uint32_t a, b, c;
+    bool operator==(const Deps &o) const { return a == o.a && b == o.b && c == o.c; }
+  };
+
+  ClockMode mode_;
+  PositionStageFn position_;
+  MotionStageFn motion_;
+  uint32_t mode_seq_, pos_seq_;
+  Deps pos_dep_, mot_dep_;
+  PositionState pos_;
+  DilationSample sample_;
+};
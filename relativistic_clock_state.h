@@ -0,0 +1,235 @@
+#pragma once
+/*
+  relativistic_clock_state.h  —  Snapshot between the physics and HUD cores
+  ------------------------------------------------------------------------
+  - ClockState: everything the HUD shows, one value per field: raw and
+    UI-smoothed GNSS values, the physics result (g, rotation and total
+    speed, ns/h, session offset) and the header status, plus counters the
+    HUD turns into redraw events (fixes, barometer reads)
+  - SeqlockSnapshot<T>: lock-free exchange of a trivially copyable value
+    between one writer task and any number of readers on other cores.
+    Two slots, each with its own sequence (odd while being written): the
+    writer fills the slot the readers are not pointed at and then flips
+    the version, so a reader retries only if the writer publishes twice
+    during one copy. Never blocks either side; the payload moves as
+    32-bit atomic words (plain loads / stores on the ESP32), so a torn
+    copy is detected, never a data race
+  - ClockProducer: one pass of the physics task (ingest ring → ClockCore →
+    snapshot), mode requests from the HUD picked up at the start of a pass
+  - BaroReading: the barometer's altitude, published by the task that owns
+    the I2C bus (the sketch's HUD task: the BMP280 shares the bus with the
+    touch controller, PMU and IMU) for the physics task's readBaro()
+  - No FreeRTOS / M5 dependency: the sketch runs the producer in a task
+    pinned to core 0, tools/replay --split in a std::thread
+
+  Usage:
+    SeqlockSnapshot<ClockState> clockState;
+    SeqlockSnapshot<ClockMode> clockModeRequest;
+    ClockProducer<Core, Ingest> producer(core, ingest, clockState, clockModeRequest);
+    // physics task:
+    if (producer.pass(millis(), readBaro)) ...notify the HUD...
+    sleep producer.sleepMs(millis()) or until the ingest task notifies
+    // HUD task:
+    ClockState s;
+    if (clockState.read(s)) ...draw...
+    clockModeRequest.publish(newMode);
+*/
+
+#include <atomic>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include "relativistic_clock_modes.h"
+
+// ---- What the HUD draws ----
+struct ClockState {
+  // Raw GNSS / barometer values (NAN: none or stale)
+  double raw_lat, raw_lon, raw_vel_kmh, raw_az_deg, raw_alt_baro_m, raw_alt_hae_m;
+  // UI-smoothed (gauges only)
+  double ui_vel_kmh, ui_az_deg;
+  // Physics inputs (active altitude source) and result
+  double lat_deg, alt_m;
+  double gravity;    // m/s²
+  double vRot, vTot; // Earth-rotation and total speed, m/s
+  double ns_per_h;
+  double offset_ns;  // session clock offset
+  // Header status
+  double hdop;       // NAN: none
+  int32_t sats;
+  // Counters (the HUD redraws when they change)
+  uint32_t seq;         // publishes
+  uint32_t fixes;       // GNSS fixes so far
+  uint32_t baro_reads;  // barometer readings so far
+  uint32_t fix_ms;      // millis() of the last fix
+};
+
+// ---- Barometer reading (I2C owner → physics) ----
+struct BaroReading {
+  double alt_m;  // m
+};
+
+// ---- Double-buffered seqlock ----
+template <class T>
+class SeqlockSnapshot {
+  static_assert(std::is_trivially_copyable<T>::value, "snapshot must be trivially copyable");
+
+public:
+  SeqlockSnapshot() : version_(0) {
+    for (int k = 0; k < 2; ++k) {
+      slots_[k].seq.store(0, std::memory_order_relaxed);
+      for (size_t i = 0; i < WORDS; ++i) slots_[k].words[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // Writer side (one task only)
+  void publish(const T &v) {
+    uint32_t w[WORDS];
+    w[WORDS - 1] = 0;
+    memcpy(w, &v, sizeof(T));
+
+    const uint32_t next = version_.load(std::memory_order_relaxed) + 1;
+    Slot &s = slots_[next & 1];
+    const uint32_t q = s.seq.load(std::memory_order_relaxed);
+    s.seq.store(q + 1, std::memory_order_relaxed);  // odd: being written
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < WORDS; ++i) s.words[i].store(w[i], std::memory_order_relaxed);
+    s.seq.store(q + 2, std::memory_order_release);
+    version_.store(next, std::memory_order_release);
+  }
+
+  // Reader side: copies the latest value; returns its version (0: nothing
+  // published yet, out is all zero bytes). retries, if given, is increased
+  // by the copies thrown away
+  uint32_t read(T &out, uint32_t *retries = nullptr) const {
+    uint32_t w[WORDS];
+    for (;;) {
+      const uint32_t v = version_.load(std::memory_order_acquire);
+      const Slot &s = slots_[v & 1];
+      const uint32_t q = s.seq.load(std::memory_order_acquire);
+      if (!(q & 1)) {
+        for (size_t i = 0; i < WORDS; ++i) w[i] = s.words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s.seq.load(std::memory_order_relaxed) == q) {
+          memcpy(&out, w, sizeof(T));
+          return v;
+        }
+      }
+      if (retries) ++*retries;
+    }
+  }
+
+  // Publishes so far (a reader can poll this for changes without copying)
+  uint32_t version() const { return version_.load(std::memory_order_acquire); }
+
+private:
+  static const size_t WORDS = (sizeof(T) + 3) / 4;
+
+  struct Slot {
+    std::atomic<uint32_t> seq;
+    std::atomic<uint32_t> words[WORDS];
+  };
+
+  Slot slots_[2];
+  std::atomic<uint32_t> version_;
+};
+
+// ---- Physics side ----
+template <class Core, class Ingest>
+class ClockProducer {
+public:
+  static const uint32_t SMOOTH_MS = 16;  // UI filters are tuned for ~60 Hz
+  static const uint32_t BARO_MS = 40;  // default; setBaroPeriod(): the sensor's sample period
+
+  ClockProducer(Core &core, Ingest &ingest, SeqlockSnapshot<ClockState> &state,
+                const SeqlockSnapshot<ClockMode> &modeRequest)
+    : core_(core), ingest_(ingest), state_(state), modeRequest_(modeRequest) {}
+
+  // Barometer deadline spacing (a sensor in normal mode: its sample
+  // period, so every read gets a new sample)
+  void setBaroPeriod(uint32_t ms) { baroMs_ = ms ? ms : BARO_MS; }
+
+  // One pass: mode request, GNSS frames, barometer (readBaro() → metres,
+  // NAN: no reading; while it is the altitude source), smoothing,
+  // physics, publish. Returns true if a new fix arrived.
+  template <class ReadBaro>
+  bool pass(uint32_t now_ms, ReadBaro readBaro) {
+    const uint32_t req = modeRequest_.version();
+    if (req != modeSeen_) {
+      ClockMode m;
+      modeRequest_.read(m);
+      if (!(m == core_.mode())) core_.setMode(m);
+      modeSeen_ = req;
+    }
+
+    core_.beginFrame();
+    uint8_t buf[256];
+    size_t n;
+    while ((n = ingest_.consume(buf, sizeof(buf))) > 0) core_.feedGnss(buf, n);
+    core_.endGnss();
+    if (core_.gpsOK) fix_ms_ = now_ms;
+
+    if ((int32_t)(now_ms - tBaro_) >= 0) {
+      tBaro_ = now_ms + baroMs_;
+      if (core_.wantsBaro()) {
+        const double alt = readBaro();
+        if (!isnan(alt)) {
+          core_.setBaroAltitude(alt);
+          ++baro_reads_;
+        }
+      }
+    }
+    if ((int32_t)(now_ms - tSmooth_) >= 0) {
+      tSmooth_ = now_ms + SMOOTH_MS;
+      core_.smooth();
+    }
+    core_.evaluate();
+
+    publish();
+    return core_.gpsOK;
+  }
+
+  // Milliseconds to the next smoothing / barometer deadline
+  uint32_t sleepMs(uint32_t now_ms) const {
+    const int32_t a = (int32_t)(tSmooth_ - now_ms), b = (int32_t)(tBaro_ - now_ms);
+    const int32_t left = a < b ? a : b;
+    return left > 0 ? (uint32_t)left : 0;
+  }
+
+private:
+  void publish() {
+    ClockState s;
+    memset(&s, 0, sizeof(s));
+    s.raw_lat = core_.raw_lat;
+    s.raw_lon = core_.raw_lon;
+    s.raw_vel_kmh = core_.raw_vel_kmh;
+    s.raw_az_deg = core_.raw_az_deg;
+    s.raw_alt_baro_m = core_.raw_alt_baro_m;
+    s.raw_alt_hae_m = core_.raw_alt_hae_m;
+    s.ui_vel_kmh = core_.ui_vel_kmh;
+    s.ui_az_deg = core_.ui_az_deg;
+    s.lat_deg = core_.physics.latitude.value;
+    s.alt_m = core_.altitude();
+    const DilationResult &r = core_.physics.result;
+    s.gravity = r.gravity;
+    s.vRot = r.earthRotationSpeed;
+    s.vTot = r.relativeVelocity;
+    s.ns_per_h = r.ns_per_s * 3600.0;
+    s.offset_ns = core_.offset.offset_ns();
+    s.hdop = core_.hdop;
+    s.sats = core_.sats;
+    s.seq = ++seq_;
+    s.fixes = core_.fixes;
+    s.baro_reads = baro_reads_;
+    s.fix_ms = fix_ms_;
+    state_.publish(s);
+  }
+
+  Core &core_;
+  Ingest &ingest_;
+  SeqlockSnapshot<ClockState> &state_;
+  const SeqlockSnapshot<ClockMode> &modeRequest_;
+  uint32_t modeSeen_ = 0;
+  uint32_t tBaro_ = 0, tSmooth_ = 0, baroMs_ = BARO_MS;
+  uint32_t baro_reads_ = 0, fix_ms_ = 0, seq_ = 0;
+};
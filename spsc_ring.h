@@ -0,0 +1,89 @@
+#pragma once
+/*
+  spsc_ring.h  —  Lock-free single-producer / single-consumer byte ring
+  --------------------------------------------------------------------
+  - One producer (UART ingest task) and one consumer (loop) on any cores;
+    no locks, no interrupts disabled
+  - Capacity N bytes, N a power of two; free-running 32-bit indices, so
+    the full N bytes are usable
+  - Release/acquire on the indices: the consumer never sees an index
+    before the bytes behind it
+  - Portable (std::atomic), also builds on a host for the ingest bench
+
+  Usage:
+    SpscRing<8192> ring;
+    ring.tryWrite(sentence, len);   // producer: all or nothing
+    n = ring.read(buf, sizeof(buf));  // consumer
+*/
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+template <size_t N>
+class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+  SpscRing() : head_(0), tail_(0) {}
+
+  static constexpr size_t capacity() { return N; }
+
+  // Producer: bytes free right now (may grow as the consumer reads)
+  size_t freeSpace() const {
+    return N - (head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_acquire));
+  }
+
+  // Consumer: bytes available right now (may grow as the producer writes)
+  size_t available() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+  }
+
+  // Producer: writes all n bytes, or nothing if they do not fit
+  bool tryWrite(const uint8_t *p, size_t n) {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    const uint32_t tail = tail_.load(std::memory_order_acquire);
+    if (n > N - (head - tail)) return false;
+    copyIn(head, p, n);
+    head_.store(head + (uint32_t)n, std::memory_order_release);
+    return true;
+  }
+
+  // Producer: writes as many bytes as fit, returns the count
+  size_t write(const uint8_t *p, size_t n) {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    const uint32_t tail = tail_.load(std::memory_order_acquire);
+    const size_t room = N - (head - tail);
+    if (n > room) n = room;
+    copyIn(head, p, n);
+    head_.store(head + (uint32_t)n, std::memory_order_release);
+    return n;
+  }
+
+  // Consumer: reads up to max bytes, returns the count
+  size_t read(uint8_t *p, size_t max) {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    const uint32_t head = head_.load(std::memory_order_acquire);
+    size_t n = head - tail;
+    if (n > max) n = max;
+    const size_t at = tail & (N - 1);
+    const size_t first = (n < N - at) ? n : N - at;
+    memcpy(p, buf_ + at, first);
+    memcpy(p + first, buf_, n - first);
+    tail_.store(tail + (uint32_t)n, std::memory_order_release);
+    return n;
+  }
+
+private:
+  void copyIn(uint32_t head, const uint8_t *p, size_t n) {
+    const size_t at = head & (N - 1);
+    const size_t first = (n < N - at) ? n : N - at;
+    memcpy(buf_ + at, p, first);
+    memcpy(buf_, p + first, n - first);
+  }
+
+  uint8_t buf_[N];
+  std::atomic<uint32_t> head_;  // written by the producer only
+  std::atomic<uint32_t> tail_;  // written by the consumer only
+};
@@ -0,0 +1,445 @@
+/*
+  baro_bench.cpp  —  Host benchmark for bmp280_reader.h
+  ----------------------------------------------------
+  - Runs the reader against a simulated BMP280 on a simulated I2C bus
+    (SimBmp280: chip ID, calibration and data registers; the samples
+    change at the profile's typical conversion period) fed with raw
+    temperature / pressure from a recording: checks the registers the
+    reader set, that no burst read a sample already read, and counts
+    transactions and bus time against the library path it replaces
+    (Adafruit readAltitude() every 40 ms: two 3-byte reads, sensor at
+    the library's x16 / x16, no filter)
+  - Accuracy of BaroAltitude against the formula in double, over the
+    recording and over a sweep of p / p0 at several sea-level pressures
+    (the library's float path for comparison); the compensation is
+    checked against the datasheet's worked example
+  - Time per altitude (pow() as the library calls it, powf(), the
+    series), per compensation and per read(). On a host all run in
+    hardware, so the timing only shows the op count; the device time
+    per read is in PIPELINE_STATS_REPORT (relativistic_clock.ino)
+  - Recording: CSV "# bmp280 calib T1,T2,T3,P1,...,P9" then
+    "t_ms,adc_T,adc_P" per sample, as the sketch prints them with
+    BARO_RAW_LOG; without one a synthetic recording is used (desk,
+    stairs, a drive up to 1800 m, a flight cabin)
+  - Exit code 0 if every check passes
+
+  Build (from the repository root):
+    g++ -O2 -std=c++11 -Wall -I. tools/baro_bench/baro_bench.cpp -o baro_bench
+
+  Run:
+    ./baro_bench [recording.csv]
+    ./baro_bench --synth <recording.csv> [seconds]   (default 600)
+*/
+
+#include "bmp280_reader.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static const double MAX_ERROR_M = 0.02;  // series vs. pow(), inside RATIO_MIN..RATIO_MAX
+static const uint8_t ADDR = 0x76;
+
+static double secondsSince(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// The formula in double (reference)
+static double altitudeRef(double p_pa, double slp_hPa) {
+  return 44330.0 * (1.0 - pow(p_pa / (slp_hPa * 100.0), 0.1903));
+}
+
+// Adafruit_BMP280::readAltitude() after readPressure()
+static float altitudeLibrary(float p_pa, float slp_hPa) {
+  float hpa = p_pa;
+  hpa /= 100;
+  return 44330 * (1.0 - pow(hpa / slp_hPa, 0.1903));
+}
+
+// ---- Recording ----
+struct RawSample {
+  uint32_t t_ms;
+  int32_t adcT, adcP;
+};
+
+struct Recording {
+  Bmp280Calib calib;
+  std::vector<RawSample> samples;
+};
+
+// Datasheet 3.12 example calibration
+static const Bmp280Calib EXAMPLE_CALIB = { 27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000 };
+
+static bool loadRecording(const char *path, Recording &rec) {
+  FILE *f = fopen(path, "r");
+  if (!f) return false;
+  char line[256];
+  bool calib = false;
+  while (fgets(line, sizeof(line), f)) {
+    int v[12];
+    RawSample s;
+    if (sscanf(line, "# bmp280 calib %d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5],
+               &v[6], &v[7], &v[8], &v[9], &v[10], &v[11]) == 12) {
+      rec.calib = { (uint16_t)v[0], (int16_t)v[1], (int16_t)v[2], (uint16_t)v[3], (int16_t)v[4], (int16_t)v[5],
+                    (int16_t)v[6], (int16_t)v[7], (int16_t)v[8], (int16_t)v[9], (int16_t)v[10], (int16_t)v[11] };
+      calib = true;
+    } else if (sscanf(line, "%u,%d,%d", &s.t_ms, &s.adcT, &s.adcP) == 3) {
+      rec.samples.push_back(s);
+    }
+  }
+  fclose(f);
+  return calib && !rec.samples.empty();
+}
+
+// Raw values that compensate to t_c / p_pa (both monotonic: bisection)
+static int32_t adcForTemperature(const Bmp280Calib &c, double t_c) {
+  int32_t lo = 0, hi = 0xFFFFF;
+  while (lo < hi) {
+    const int32_t mid = (lo + hi) / 2;
+    if (bmp280TFine(c, mid) / 5120.0 < t_c) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+static int32_t adcForPressure(const Bmp280Calib &c, int32_t tFine, double p_pa) {
+  int32_t lo = 0, hi = 0xFFFFF;  // pressure falls as adc_P rises
+  while (lo < hi) {
+    const int32_t mid = (lo + hi) / 2;
+    if (bmp280PressureQ8(c, mid, tFine) / 256.0 > p_pa) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+// Synthetic trip: desk, stairs, a drive up to 1800 m and down, a flight
+// cabin (2400 m), desk; ~1.5 Pa sensor noise
+static Recording synthRecording(uint32_t seconds) {
+  struct Leg {
+    double until;  // fraction of the recording
+    double alt_m;  // at its end
+  };
+  static const Leg legs[] = { { 0.10, 50 }, { 0.15, 65 }, { 0.20, 65 }, { 0.45, 1800 }, { 0.55, 1800 },
+                              { 0.65, 50 }, { 0.72, 2400 }, { 0.85, 2400 }, { 0.93, 50 }, { 1.00, 50 } };
+  Recording rec;
+  rec.calib = EXAMPLE_CALIB;
+  const uint32_t period_ms = 38;  // Precise, typical
+  uint32_t seed = 12345;
+  double from_alt = 50, from_t = 0;
+  size_t leg = 0;
+  for (uint32_t t_ms = 0; t_ms < seconds * 1000; t_ms += period_ms) {
+    const double f = t_ms / (seconds * 1000.0);
+    while (f > legs[leg].until) {
+      from_alt = legs[leg].alt_m;
+      from_t = legs[leg].until;
+      ++leg;
+    }
+    const double alt = from_alt + (legs[leg].alt_m - from_alt) * (f - from_t) / (legs[leg].until - from_t);
+    double noise = 0.0;
+    for (int i = 0; i < 4; ++i) {
+      seed = seed * 1664525u + 1013904223u;
+      noise += (seed >> 8) / 16777216.0 - 0.5;
+    }
+    const double p = 101325.0 * pow(1.0 - alt / 44330.0, 1.0 / 0.1903) + 1.5 * noise;
+    const double t_c = 22.0 + 3.0 * sin(t_ms * 1e-5) - alt * 0.0065;
+    RawSample s;
+    s.t_ms = t_ms;
+    s.adcT = adcForTemperature(rec.calib, t_c);
+    s.adcP = adcForPressure(rec.calib, bmp280TFine(rec.calib, s.adcT), p);
+    rec.samples.push_back(s);
+  }
+  return rec;
+}
+
+static bool writeRecording(const char *path, const Recording &rec) {
+  FILE *f = fopen(path, "w");
+  if (!f) return false;
+  const Bmp280Calib &c = rec.calib;
+  fprintf(f, "# bmp280 calib %d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", c.T1, c.T2, c.T3, c.P1, c.P2, c.P3, c.P4, c.P5,
+          c.P6, c.P7, c.P8, c.P9);
+  for (const RawSample &s : rec.samples) fprintf(f, "%u,%d,%d\n", s.t_ms, s.adcT, s.adcP);
+  fclose(f);
+  return true;
+}
+
+// ---- Simulated sensor behind a TwoWire-like bus ----
+// I2C bits of a register read: START, address + register, repeated
+// START, address + n bytes, STOP (9 bits a byte with ACK)
+static uint32_t readBits(size_t n) { return 1 + 9 * 2 + 1 + 9 * (1 + (uint32_t)n) + 1; }
+
+class SimBmp280 {
+public:
+  SimBmp280(const Recording &rec, uint32_t period_us) : rec_(rec), period_us_(period_us) {
+    memset(regs_, 0, sizeof(regs_));
+    regs_[BMP280_REG_ID] = BMP280_CHIP_ID;
+    const Bmp280Calib &c = rec.calib;
+    const uint16_t w[12] = { c.T1, (uint16_t)c.T2, (uint16_t)c.T3, c.P1, (uint16_t)c.P2, (uint16_t)c.P3,
+                             (uint16_t)c.P4, (uint16_t)c.P5, (uint16_t)c.P6, (uint16_t)c.P7, (uint16_t)c.P8, (uint16_t)c.P9 };
+    for (int i = 0; i < 12; ++i) {
+      regs_[BMP280_REG_CALIB + 2 * i] = (uint8_t)w[i];
+      regs_[BMP280_REG_CALIB + 2 * i + 1] = (uint8_t)(w[i] >> 8);
+    }
+  }
+
+  // Virtual time: the data registers hold the last sample completed by
+  // now (one every period_us after normal mode was entered)
+  void setTimeUs(uint64_t t) { now_us_ = t; }
+
+  // TwoWire subset
+  void beginTransmission(uint8_t a) {
+    tx_.clear();
+    txAddr_ = a;
+  }
+  size_t write(uint8_t b) {
+    tx_.push_back(b);
+    return 1;
+  }
+  uint8_t endTransmission(bool stop = true) {
+    bits += 1 + 9 * (1 + (uint32_t)tx_.size()) + (stop ? 1 : 0);
+    if (txAddr_ != ADDR || tx_.empty()) return 2;  // address NACK
+    ptr_ = tx_[0];
+    for (size_t i = 1; i < tx_.size(); ++i) {
+      const uint8_t r = (uint8_t)(ptr_ + i - 1);
+      if (r == BMP280_REG_CTRL_MEAS && (tx_[i] & 0x03) == 0x03 && (regs_[r] & 0x03) != 0x03) normal_us_ = now_us_;
+      regs_[r] = tx_[i];
+    }
+    return 0;
+  }
+  uint8_t requestFrom(uint8_t a, uint8_t n) {
+    bits += 1 + 9 * (1 + (uint32_t)n) + 1;
+    ++transactions;
+    if (a != ADDR) return 0;
+    latch();
+    if (ptr_ == BMP280_REG_DATA) {
+      if (done_ && done_ == lastRead_) ++sameSample;
+      lastRead_ = done_;
+    }
+    rx_.assign(regs_ + ptr_, regs_ + ptr_ + n);
+    rxPos_ = 0;
+    return n;
+  }
+  int read() { return rxPos_ < rx_.size() ? rx_[rxPos_++] : -1; }
+
+  uint8_t reg(uint8_t r) const { return regs_[r]; }
+  uint32_t samplesDone() const { return done_; }
+
+  uint64_t bits = 0;
+  uint32_t transactions = 0;
+  uint32_t sameSample = 0;  // data bursts of a sample read before
+
+private:
+  void latch() {
+    if ((regs_[BMP280_REG_CTRL_MEAS] & 0x03) != 0x03 || now_us_ < normal_us_ + period_us_) return;
+    const uint64_t k = (now_us_ - normal_us_) / period_us_;  // samples completed
+    done_ = (uint32_t)(k < rec_.samples.size() ? k : rec_.samples.size());
+    const RawSample &s = rec_.samples[done_ - 1];
+    const int32_t v[2] = { s.adcP, s.adcT };
+    for (int i = 0; i < 2; ++i) {
+      regs_[BMP280_REG_DATA + 3 * i] = (uint8_t)(v[i] >> 12);
+      regs_[BMP280_REG_DATA + 3 * i + 1] = (uint8_t)(v[i] >> 4);
+      regs_[BMP280_REG_DATA + 3 * i + 2] = (uint8_t)((v[i] & 0x0F) << 4);
+    }
+  }
+
+  const Recording &rec_;
+  uint32_t period_us_;
+  uint8_t regs_[256 + 32];  // a burst may run past 0xFF
+  std::vector<uint8_t> tx_, rx_;
+  size_t rxPos_ = 0;
+  uint8_t txAddr_ = 0, ptr_ = 0;
+  uint64_t now_us_ = 0, normal_us_ = 0;
+  uint32_t done_ = 0, lastRead_ = 0;
+};
+
+// Typical sample period (datasheet: 1 + 2 * T + 2 * P + 0.5 ms + standby)
+static uint32_t typicalPeriodUs(uint32_t osrsT, uint32_t osrsP, uint32_t standby_us) {
+  return 1000 + 2000 * osrsT + 2000 * osrsP + 500 + standby_us;
+}
+
+int main(int argc, char **argv) {
+  if (argc >= 3 && !strcmp(argv[1], "--synth")) {
+    const uint32_t seconds = argc >= 4 ? (uint32_t)atoi(argv[3]) : 600;
+    const Recording rec = synthRecording(seconds);
+    if (!writeRecording(argv[2], rec)) {
+      fprintf(stderr, "cannot write %s\n", argv[2]);
+      return 1;
+    }
+    printf("wrote %s (%zu samples)\n", argv[2], rec.samples.size());
+    return 0;
+  }
+  Recording rec;
+  if (argc >= 2) {
+    if (!loadRecording(argv[1], rec)) {
+      fprintf(stderr, "cannot read %s (calibration line and t_ms,adc_T,adc_P samples)\n", argv[1]);
+      return 1;
+    }
+  } else {
+    rec = synthRecording(600);
+  }
+  bool ok = true;
+
+  // ---- Compensation: datasheet 3.12 worked example ----
+  {
+    const int32_t tFine = bmp280TFine(EXAMPLE_CALIB, 519888);
+    const double t = ((tFine * 5 + 128) >> 8) / 100.0, p = bmp280PressureQ8(EXAMPLE_CALIB, 415148, tFine) / 256.0;
+    const bool pass = t == 25.08 && fabs(p - 100653.27) < 0.05;  // .27: the datasheet's double version
+    printf("compensation (datasheet example): %.2f C %.2f Pa  %s\n", t, p, pass ? "PASS" : "FAIL");
+    ok &= pass;
+  }
+
+  // ---- Reader against the simulated sensor ----
+  const Bmp280Profile profile = Bmp280Profile::Precise;
+  const Bmp280Setup setup = bmp280Setup(profile);
+  SimBmp280 sensor(rec, typicalPeriodUs(1u << (setup.osrs_t - 1), 1u << (setup.osrs_p - 1), 500));
+  Bmp280Reader<SimBmp280> reader;
+  const bool begun = reader.begin(sensor, ADDR, profile);
+  const bool regsOk = sensor.reg(BMP280_REG_CTRL_MEAS) == ((setup.osrs_t << 5) | (setup.osrs_p << 2) | 0x03) &&
+                      sensor.reg(BMP280_REG_CONFIG) == ((setup.t_sb << 5) | (setup.filter << 2));
+  printf("reader: begin %s, ctrl_meas 0x%02X config 0x%02X  %s\n", begun ? "ok" : "FAILED",
+         sensor.reg(BMP280_REG_CTRL_MEAS), sensor.reg(BMP280_REG_CONFIG), begun && regsOk ? "PASS" : "FAIL");
+  ok &= begun && regsOk;
+
+  const uint64_t bitsBegin = sensor.bits;
+  const uint32_t transBegin = sensor.transactions, sameBegin = sensor.sameSample, period_ms = reader.periodMs();
+  const uint64_t span_us = (uint64_t)rec.samples.size() * typicalPeriodUs(1u << (setup.osrs_t - 1), 1u << (setup.osrs_p - 1), 500);
+  double maxErr = 0.0, sumErr = 0.0;
+  uint32_t seed = 99, passes = 0;
+  for (uint64_t t_us = 0; t_us < span_us;) {
+    sensor.setTimeUs(t_us);
+    ++passes;
+    if (reader.read()) {
+      const Bmp280Calib &c = reader.calib();
+      const double ref = altitudeRef(bmp280PressureQ8(c, reader.rawPressure(), bmp280TFine(c, reader.rawTemperature())) / 256.0, 1013.25);
+      const double e = fabs(reader.altitudeM(1013.25f) - ref);
+      if (e > maxErr) maxErr = e;
+      sumErr += e;
+    }
+    // The physics task wakes at the deadline or a little later (GNSS frames)
+    seed = seed * 1664525u + 1013904223u;
+    t_us += period_ms * 1000 + (seed >> 16) % 3000;
+  }
+  const Bmp280Reader<SimBmp280>::Stats &st = reader.stats;
+  const double seconds = span_us / 1e6;
+  const bool readsOk = st.reads > 0 && sensor.sameSample == 0 && st.errors == 0 && maxErr <= MAX_ERROR_M;
+  printf("reader: %s profile, every %lu ms: %lu reads (%.1f/s) of %lu samples, %lu read twice, %lu unchanged, %lu errors  %s\n",
+         bmp280ProfileName(profile), (unsigned long)period_ms, (unsigned long)st.reads, st.reads / seconds,
+         (unsigned long)sensor.samplesDone(), (unsigned long)sensor.sameSample, (unsigned long)st.unchanged,
+         (unsigned long)st.errors, readsOk ? "PASS" : "FAIL");
+  printf("reader: altitude vs. pow() over the recording: max %.4f m, mean %.4f m\n", maxErr, st.reads ? sumErr / st.reads : 0.0);
+  ok &= readsOk;
+
+  // ---- Bus: reader vs. library path ----
+  {
+    const double bitUs = 1e6 / 400000.0;
+    const double readerTrans = (sensor.transactions - transBegin) / (double)passes;
+    const double readerUs = (sensor.bits - bitsBegin) * bitUs / passes;
+    // Library: readAltitude() every 40 ms, temperature and pressure read
+    // separately; sensor at x16 / x16, no filter, 0.5 ms standby
+    const uint32_t libPeriodUs = typicalPeriodUs(16, 16, 500);
+    uint32_t libReads = 0, libRepeats = 0;
+    uint64_t last = 0;
+    for (uint64_t t_us = 0; t_us < span_us; t_us += 40000, ++libReads) {
+      const uint64_t k = t_us / libPeriodUs;
+      if (libReads && k == last) ++libRepeats;
+      last = k;
+    }
+    const double libUs = 2 * readBits(3) * bitUs;
+    printf("\n%-22s %9s %11s %11s %9s %9s\n", "bus (400 kHz)", "reads/s", "read twice", "trans/read", "us/read", "bus ms/s");
+    printf("%-22s %9.1f %10.1f%% %11.1f %9.0f %9.2f\n", "library, 40 ms", libReads / seconds, 100.0 * libRepeats / libReads,
+           2.0, libUs, libReads / seconds * libUs / 1000.0);
+    printf("%-22s %9.1f %10.1f%% %11.1f %9.0f %9.2f\n", "reader, burst", passes / seconds,
+           100.0 * (sensor.sameSample - sameBegin) / passes, readerTrans, readerUs, passes / seconds * readerUs / 1000.0);
+  }
+
+  // ---- Accuracy sweep ----
+  {
+    printf("\n%-12s %16s %16s %16s\n", "slp hPa", "series max m", "powf max m", "library max m");
+    double worst = 0.0;
+    const float slps[] = { 950.0f, 1013.25f, 1050.0f };
+    BaroAltitude alt;
+    for (float slp : slps) {
+      double inMax = 0.0, outMax = 0.0, libMax = 0.0;
+      for (double r = 0.30; r <= 1.15; r += 1e-5) {
+        const float p = (float)(r * slp * 100.0);
+        const double ref = altitudeRef(p, slp);
+        const double e = fabs(alt.metres(p, slp) - ref);
+        const float rf = p / (slp * 100.0f);
+        if (rf >= BaroAltitude::RATIO_MIN && rf <= BaroAltitude::RATIO_MAX) inMax = e > inMax ? e : inMax;
+        else outMax = e > outMax ? e : outMax;
+        const double el = fabs(altitudeLibrary(p, slp) - ref);
+        libMax = el > libMax ? el : libMax;
+      }
+      printf("%-12.2f %16.4f %16.4f %16.4f\n", slp, inMax, outMax, libMax);
+      worst = inMax > worst ? inMax : worst;
+    }
+    const bool pass = worst <= MAX_ERROR_M;
+    printf("series max error %.4f m (bound %.2f m, p/p0 %.2f .. %.2f)  %s\n", worst, MAX_ERROR_M,
+           BaroAltitude::RATIO_MIN, BaroAltitude::RATIO_MAX, pass ? "PASS" : "FAIL");
+    ok &= pass;
+  }
+
+  // ---- Timing ----
+  {
+    const int N = 2000000;
+    std::vector<float> p(4096);
+    std::vector<RawSample> raw(4096);
+    for (size_t i = 0; i < p.size(); ++i) {
+      p[i] = 60000.0f + 45000.0f * i / p.size();
+      raw[i] = rec.samples[i % rec.samples.size()];
+    }
+    BaroAltitude alt;
+    volatile float sinkF = 0.0f;
+    volatile uint32_t sinkU = 0;
+    float acc = 0.0f;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; ++i) acc += altitudeLibrary(p[i & 4095], 1013.25f);
+    const double tLib = secondsSince(t0);
+    sinkF = acc;
+
+    acc = 0.0f;
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; ++i) acc += 44330.0f * (1.0f - powf(p[i & 4095] / 101325.0f, 0.1903f));
+    const double tPowf = secondsSince(t0);
+    sinkF = acc;
+
+    acc = 0.0f;
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; ++i) acc += alt.metres(p[i & 4095], 1013.25f);
+    const double tSeries = secondsSince(t0);
+    sinkF = acc;
+
+    uint32_t accU = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; ++i) {
+      const RawSample &s = raw[i & 4095];
+      accU += bmp280PressureQ8(rec.calib, s.adcP, bmp280TFine(rec.calib, s.adcT));
+    }
+    const double tComp = secondsSince(t0);
+    sinkU = accU;
+
+    const int R = 200000;
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < R; ++i) {
+      sensor.setTimeUs(span_us);
+      reader.read();
+      acc += reader.altitudeM(1013.25f);
+    }
+    const double tRead = secondsSince(t0);
+    sinkF = acc;
+    (void)sinkF;
+    (void)sinkU;
+
+    printf("\n%-34s %10s\n", "per call (host)", "ns");
+    printf("%-34s %10.1f\n", "altitude, library (pow, double)", tLib * 1e9 / N);
+    printf("%-34s %10.1f\n", "altitude, powf", tPowf * 1e9 / N);
+    printf("%-34s %10.1f\n", "altitude, series", tSeries * 1e9 / N);
+    printf("%-34s %10.1f\n", "compensation (T + P)", tComp * 1e9 / N);
+    printf("%-34s %10.1f\n", "read() + altitude (sim bus)", tRead * 1e9 / R);
+  }
+
+  printf("\n%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
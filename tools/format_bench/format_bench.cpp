@@ -0,0 +1,161 @@
+/*
+  format_bench.cpp  —  Host check and benchmark for hud_format.h
+  -------------------------------------------------------------
+  - Agreement: hudFormatFixed vs. snprintf("%.*f" / "%+.*f") for random
+    floats (the HUD's inputs) and doubles over the HUD's value ranges and
+    wide magnitudes, 0..7 decimals, exact ties (x.5 at every decimal), zero
+    and negative zero; hudFormatInt vs. "%*ld"
+  - Time per call: hudFormatFixed, snprintf, and the old label path
+    (dtostrf + String + unit), with the heap allocations each makes
+  - Exit code 0 if every string matched
+
+  Build (from the repository root):
+    g++ -O2 -std=c++11 -I. -Itools/host tools/format_bench/format_bench.cpp -o format_bench
+
+  Run:
+    ./format_bench [samples]   (default 2,000,000)
+*/
+
+#include "hud_format.h"
+#include "Arduino.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+
+// ---- Heap allocation counter ----
+static uint64_t g_allocs = 0;
+
+void *operator new(size_t n) {
+  ++g_allocs;
+  void *p = malloc(n ? n : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void *operator new[](size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+static double secondsSince(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// ---- Agreement ----
+struct Check {
+  uint64_t compared = 0, mismatches = 0;
+
+  void fixed(double v, int decimals, bool plus) {
+    char ref[64], got[64];
+    snprintf(ref, sizeof(ref), plus ? "%+.*f" : "%.*f", decimals, v);
+    hudFormatFixed(got, sizeof(got), v, decimals, plus);
+    ++compared;
+    if (strcmp(ref, got) != 0) {
+      if (mismatches < 10) printf("  MISMATCH %.17g %d%s: \"%s\" vs \"%s\"\n", v, decimals, plus ? "+" : "", got, ref);
+      ++mismatches;
+    }
+  }
+
+  void integer(long v, int width) {
+    char ref[64], got[64];
+    snprintf(ref, sizeof(ref), "%*ld", width, v);
+    hudFormatInt(got, sizeof(got), v, width);
+    ++compared;
+    if (strcmp(ref, got) != 0) {
+      if (mismatches < 10) printf("  MISMATCH %ld width %d: \"%s\" vs \"%s\"\n", v, width, got, ref);
+      ++mismatches;
+    }
+  }
+};
+
+static void checkAll(Check &c, uint64_t samples, std::mt19937_64 &rng) {
+  std::uniform_real_distribution<double> unit(-1.0, 1.0), exp10(-6.0, 12.0);
+  // HUD ranges: ns/h, altitude m, km/h, g, latitude, session offset ns
+  static const double RANGES[] = { 20.0, 10000.0, 3000.0, 10.0, 90.0, 1.0e6 };
+  for (uint64_t i = 0; i < samples; ++i) {
+    const int decimals = (int)(i % 8);
+    const bool plus = (i / 8) % 2;
+    double v;
+    if (i % 3 == 2) v = unit(rng) * pow(10.0, exp10(rng));  // any magnitude below 9e15
+    else v = unit(rng) * RANGES[(i / 16) % 6];
+    if (i % 2) v = (float)v;  // what the widgets pass
+    if (fabs(v) * pow(10.0, decimals) >= 9.0e15) continue;
+    c.fixed(v, decimals, plus);
+  }
+  // Exact ties at every decimal (ties to even), and both zeros
+  for (int decimals = 0; decimals <= 7; ++decimals) {
+    const double step = pow(10.0, -decimals);
+    for (int k = -2000; k <= 2000; ++k) {
+      c.fixed((k + 0.5) * step, decimals, false);
+      c.fixed((float)((k + 0.5) * step), decimals, true);
+    }
+    for (double q = 0.0; q < 4096.0; q += 0.125) c.fixed(q, decimals, false);
+    c.fixed(0.0, decimals, false);
+    c.fixed(-0.0, decimals, true);
+  }
+  std::uniform_int_distribution<long> ints(-2000000000L, 2000000000L);
+  for (uint64_t i = 0; i < samples / 8; ++i) c.integer(i % 2 ? ints(rng) : (long)(i % 2001) - 1000, (int)(i % 6));
+}
+
+// ---- Speed ----
+static volatile size_t g_sink;
+
+template <typename F>
+static void bench(const char *name, const float *values, int n, int reps, F fmt) {
+  const uint64_t a0 = g_allocs;
+  const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < reps; ++r)
+    for (int i = 0; i < n; ++i) g_sink = g_sink + fmt(values[i], i);
+  const double s = secondsSince(t0);
+  const double calls = (double)n * reps;
+  printf("%-28s %8.1f ns/call %8.2f allocations/call\n", name, s / calls * 1e9, (g_allocs - a0) / calls);
+}
+
+int main(int argc, char **argv) {
+  const uint64_t samples = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000ull;
+  std::mt19937_64 rng(42);
+
+  Check c;
+  checkAll(c, samples, rng);
+  printf("agreement with snprintf: %llu strings, %llu mismatches\n",
+         (unsigned long long)c.compared, (unsigned long long)c.mismatches);
+
+  // Gauge-label-like values, decimals as the widgets use them (1, 3, 5, 6)
+  static const int N = 4096;
+  static float values[N];
+  std::uniform_real_distribution<double> u(-3000.0, 3000.0);
+  for (int i = 0; i < N; ++i) values[i] = (float)u(rng);
+  static const int DECIMALS[4] = { 1, 3, 5, 6 };
+  const int reps = (int)(samples / N / 4) + 1;
+
+  bench("hudFormatFixed", values, N, reps, [](float v, int i) {
+    char buf[24];
+    return hudFormatFixed(buf, sizeof(buf), v, DECIMALS[i & 3]);
+  });
+  bench("snprintf %.*f", values, N, reps, [](float v, int i) {
+    char buf[24];
+    return (size_t)snprintf(buf, sizeof(buf), "%.*f", DECIMALS[i & 3], v);
+  });
+  bench("hudFormatFixed + unit", values, N, reps, [](float v, int i) {
+    char buf[24];
+    hudFormatFixed(buf, sizeof(buf), v, DECIMALS[i & 3]);
+    return hudFormatAppend(buf, sizeof(buf), " km/h");
+  });
+  bench("dtostrf + String + unit", values, N, reps, [](float v, int i) {
+    char buf[24];
+    dtostrf(v, 1, DECIMALS[i & 3], buf);
+    const String s = String(buf) + " km/h";
+    return s.length();
+  });
+  bench("hudFormatInt", values, N, reps, [](float v, int) {
+    char buf[24];
+    return hudFormatInt(buf, sizeof(buf), (long)v, 3);
+  });
+
+  printf("%s\n", c.mismatches ? "FAIL" : "PASS");
+  return c.mismatches ? 1 : 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+/*
+  Arduino.h  —  Minimal host stand-in for the Arduino core (tools/ only)
+  --------------------------------------------------------------------
+  - Just what the portable sketch headers, the HUD and TinyGPSPlus use:
+    millis(), delay(), byte, PROGMEM, the math macros, String, dtostrf,
+    strlcpy, and a HardwareSerial that discards writes (headers that
+    take a serial port compile, nothing is sent)
+  - millis() is a virtual clock the tool advances (hostSetMillis), so a
+    replay ages fixes on the capture's timeline, not the host's
+
+  Build: add -Itools/host (and -DARDUINO=100 for TinyGPSPlus)
+*/
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+typedef uint8_t byte;
+
+#define PROGMEM
+
+#ifndef TWO_PI
+#define TWO_PI 6.283185307179586476925286766559
+#endif
+#define radians(deg) ((deg) * 0.017453292519943295769236907684886)
+#define degrees(rad) ((rad) * 57.295779513082320876798154814105)
+#define sq(x) ((x) * (x))
+#ifndef DEG_TO_RAD
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+#endif
+
+// ---- Strings ----
+// Non-empty Strings live on the heap, as in the Arduino core (no
+// small-string buffer), so allocation counts match the device
+class String : public std::string {
+public:
+  String() {}
+  String(const char *s) { heap(s); }
+  String(const std::string &s) { heap(s.c_str()); }
+
+private:
+  void heap(const char *s) {
+    if (*s) reserve(std::string().capacity() + 1);
+    assign(s);
+  }
+};
+
+inline char *dtostrf(double v, signed char width, unsigned char prec, char *out) {
+  sprintf(out, "%*.*f", width, prec, v);
+  return out;
+}
+
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+inline size_t strlcpy(char *dst, const char *src, size_t size) {
+  const size_t n = strlen(src);
+  if (size) {
+    const size_t c = (n < size - 1) ? n : size - 1;
+    memcpy(dst, src, c);
+    dst[c] = 0;
+  }
+  return n;
+}
+#endif
+
+// ---- Virtual clock ----
+inline uint32_t &hostMillisRef() {
+  static uint32_t ms = 0;
+  return ms;
+}
+inline void hostSetMillis(uint32_t ms) { hostMillisRef() = ms; }
+inline uint32_t millis() { return hostMillisRef(); }
+inline void delay(uint32_t ms) { hostMillisRef() += ms; }
+
+// ---- Serial port: writes are discarded ----
+class HardwareSerial {
+public:
+  size_t write(uint8_t) { return 1; }
+  size_t write(const uint8_t *, size_t n) { return n; }
+  int available() { return 0; }
+  int read() { return -1; }
+  void flush() {}
+  void updateBaudRate(uint32_t) {}
+};
@@ -0,0 +1,53 @@
+#pragma once
+/*
+  M5Unified.h  —  Host stand-in for M5Unified / M5GFX (tools/ only)
+  ----------------------------------------------------------------
+  - M5Canvas and M5.Display (M5GFX) backed by the software renderer in
+    host_gfx.h
+  - TFT_* / named colors as RGB565 ints, like LovyanGFX
+  - Power and Touch report fixed values (battery level is settable)
+
+  One translation unit per tool (M5 is a static object here).
+*/
+
+#include "Arduino.h"
+#include "host_gfx.h"
+
+typedef HostCanvas M5Canvas;
+typedef HostDisplay M5GFX;
+
+static constexpr int TFT_BLACK = 0x0000;
+static constexpr int TFT_NAVY = 0x000F;
+static constexpr int TFT_DARKGREEN = 0x03E0;
+static constexpr int TFT_DARKGREY = 0x7BEF;
+static constexpr int TFT_BLUE = 0x001F;
+static constexpr int TFT_GREEN = 0x07E0;
+static constexpr int TFT_CYAN = 0x07FF;
+static constexpr int TFT_RED = 0xF800;
+static constexpr int TFT_MAGENTA = 0xF81F;
+static constexpr int TFT_YELLOW = 0xFFE0;
+static constexpr int TFT_WHITE = 0xFFFF;
+static constexpr int TFT_ORANGE = 0xFDA0;
+static constexpr int TFT_TRANSPARENT = 0x0120;
+
+static constexpr int BLACK = TFT_BLACK;
+static constexpr int BLUE = TFT_BLUE;
+static constexpr int GREEN = TFT_GREEN;
+static constexpr int RED = TFT_RED;
+static constexpr int YELLOW = TFT_YELLOW;
+static constexpr int WHITE = TFT_WHITE;
+static constexpr int ORANGE = TFT_ORANGE;
+
+struct HostPower {
+  int level = 100;
+  int32_t getBatteryLevel() const { return level; }
+  void setExtPower(bool) {}
+};
+
+struct HostM5 {
+  HostDisplay Display;
+  HostPower Power;
+  void update() {}
+};
+
+static HostM5 M5;
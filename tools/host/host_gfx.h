@@ -0,0 +1,703 @@
+#pragma once
+/*
+  host_gfx.h  —  Software M5Canvas / display for rendering the HUD on a host
+  -------------------------------------------------------------------------
+  - The subset of the LovyanGFX canvas API used by relativistic_clock_hud.h
+    and hud_gauges.h: rectangles, round rects, circles, triangles, lines,
+    fillArc, drawGradientHLine, setClipRect, VLW smooth fonts (loadFont or
+    setFont with a shared lgfx::VLWfont, drawString / drawFloat /
+    drawNumber, datums, text size) and pushSprite with a transparent key
+  - Sprites store pixels at their color depth (32: ARGB8888, 24: RGB888,
+    16: RGB565, 8: RGB332); 32-bit sprites start fully transparent and
+    alpha-blend on push, like LovyanGFX ARGB8888 sprites
+  - 8-bit palette sprites (createPalette / setPaletteColor): indices are
+    written through getBuffer() and the transparent key of a push is an
+    index, as in LovyanGFX; drawing primitives into them is not emulated
+  - Color arguments follow LovyanGFX: uint32_t is RGB888 (color888),
+    uint16_t / int are RGB565 (color565, TFT_*), uint8_t is RGB332
+  - HostDisplay is the 320x240 RGB565 panel; it counts pushed pixels and
+    transactions (what the SPI bus would carry). pushImageDMA copies at
+    once (no bus to wait for): one address window per call
+  - Deterministic (integer rasterizers, fixed blend rounding), so frames
+    can be golden-image compared; geometry matches LovyanGFX closely but
+    is not guaranteed bit-identical to the device
+
+  Not a full LovyanGFX: only what the HUD calls.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ---- Text datums (LovyanGFX values) ----
+enum textdatum_t : uint8_t {
+  top_left = 0, top_center = 1, top_right = 2,
+  middle_left = 4, middle_center = 5, middle_right = 6,
+  bottom_left = 8, bottom_center = 9, bottom_right = 10,
+  baseline_left = 16, baseline_center = 17, baseline_right = 18
+};
+static constexpr textdatum_t TL_DATUM = top_left;
+static constexpr textdatum_t TC_DATUM = top_center;
+static constexpr textdatum_t TR_DATUM = top_right;
+static constexpr textdatum_t ML_DATUM = middle_left;
+static constexpr textdatum_t MC_DATUM = middle_center;
+static constexpr textdatum_t MR_DATUM = middle_right;
+static constexpr textdatum_t BL_DATUM = bottom_left;
+static constexpr textdatum_t BC_DATUM = bottom_center;
+static constexpr textdatum_t BR_DATUM = bottom_right;
+
+// ---- Colors: internal form is ARGB8888 ----
+static inline uint32_t hostArgb(uint32_t rgb888) { return 0xFF000000u | (rgb888 & 0xFFFFFFu); }
+static inline uint32_t hostArgbFrom565(uint16_t c) {
+  const uint32_t r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+  return 0xFF000000u | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+}
+static inline uint32_t hostArgbFrom332(uint8_t c) {
+  const uint32_t r = c >> 5, g = (c >> 2) & 7, b = c & 3;
+  return 0xFF000000u | (((r << 5) | (r << 2) | (r >> 1)) << 16) | (((g << 5) | (g << 2) | (g >> 1)) << 8) | (b * 0x55);
+}
+static inline uint16_t host565(uint32_t argb) {
+  return (uint16_t)(((argb >> 8) & 0xF800) | ((argb >> 5) & 0x07E0) | ((argb >> 3) & 0x001F));
+}
+static inline uint8_t host332(uint32_t argb) {
+  return (uint8_t)(((argb >> 16) & 0xE0) | ((argb >> 11) & 0x1C) | ((argb >> 6) & 0x03));
+}
+
+static inline uint32_t hostColor(uint32_t c) { return hostArgb(c); }
+static inline uint32_t hostColor(uint16_t c) { return hostArgbFrom565(c); }
+static inline uint32_t hostColor(int c) { return hostArgbFrom565((uint16_t)c); }
+static inline uint32_t hostColor(uint8_t c) { return hostArgbFrom332(c); }
+
+// a: 0..255 weight of f
+static inline uint32_t hostBlend(uint32_t f, uint32_t b, uint32_t a) {
+  const uint32_t na = 255 - a;
+  const uint32_t r = (((f >> 16) & 0xFF) * a + ((b >> 16) & 0xFF) * na + 127) / 255;
+  const uint32_t g = (((f >> 8) & 0xFF) * a + ((b >> 8) & 0xFF) * na + 127) / 255;
+  const uint32_t bl = ((f & 0xFF) * a + (b & 0xFF) * na + 127) / 255;
+  return 0xFF000000u | (r << 16) | (g << 8) | bl;
+}
+
+// ---- VLW smooth font (Processing format, as in assets/fonts) ----
+struct HostVlwFont {
+  struct Glyph {
+    uint32_t code;
+    int16_t height, width, xAdvance, dY, dX;
+    const uint8_t *bitmap;
+  };
+  std::vector<Glyph> glyphs;
+  int ascent = 0, descent = 0, maxAscent = 0, maxDescent = 0, yAdvance = 0, spaceWidth = 0;
+
+  static int32_t be32(const uint8_t *p) { return (int32_t)((uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3]); }
+
+  void load(const uint8_t *data) {
+    const int count = be32(data);
+    ascent = be32(data + 16);
+    descent = be32(data + 20);
+    maxAscent = ascent;
+    maxDescent = descent;
+    glyphs.resize(count);
+    const uint8_t *meta = data + 24;
+    const uint8_t *bmp = meta + 28 * count;
+    for (int i = 0; i < count; ++i, meta += 28) {
+      Glyph &g = glyphs[i];
+      g.code = (uint32_t)be32(meta);
+      g.height = (int16_t)be32(meta + 4);
+      g.width = (int16_t)be32(meta + 8);
+      g.xAdvance = (int16_t)be32(meta + 12);
+      g.dY = (int16_t)be32(meta + 16);
+      g.dX = (int16_t)be32(meta + 20);
+      g.bitmap = bmp;
+      bmp += g.width * g.height;
+      // Metrics skip Latin-1 symbols / NBSP, which carry odd extents
+      if ((g.code > 0x20 && g.code < 0xA0 && g.code != 0x7F) || g.code > 0xFF) {
+        if (g.dY > maxAscent) maxAscent = g.dY;
+        if (g.height - g.dY > maxDescent) maxDescent = g.height - g.dY;
+      }
+    }
+    yAdvance = maxAscent + maxDescent;
+    spaceWidth = (ascent + descent) * 2 / 7;
+  }
+
+  const Glyph *find(uint32_t code) const {
+    size_t lo = 0, hi = glyphs.size();  // sorted by code
+    while (lo < hi) {
+      const size_t mid = (lo + hi) / 2;
+      if (glyphs[mid].code < code) lo = mid + 1;
+      else hi = mid;
+    }
+    return (lo < glyphs.size() && glyphs[lo].code == code) ? &glyphs[lo] : nullptr;
+  }
+};
+
+// ---- Font objects for setFont (LovyanGFX names) ----
+namespace lgfx {
+struct IFont {
+  virtual ~IFont() {}
+};
+struct DataWrapper {
+  virtual ~DataWrapper() {}
+};
+struct PointerWrapper : public DataWrapper {
+  const uint8_t *ptr = nullptr;
+  void set(const uint8_t *src, uint32_t = ~0u) { ptr = src; }
+};
+// A raw pixel of a 16-bit sprite, in the sprite's byte order (the device
+// stores RGB565 byte-swapped for the bus; the host stores it native)
+struct swap565_t {
+  uint16_t raw;
+};
+struct VLWfont : public IFont {
+  HostVlwFont vlw;
+  bool loadFont(DataWrapper *data) {
+    const PointerWrapper *p = static_cast<const PointerWrapper *>(data);
+    if (!p || !p->ptr) return false;
+    vlw.load(p->ptr);
+    return true;
+  }
+};
+}  // namespace lgfx
+
+// ---- Drawing surface ----
+class HostGfx {
+public:
+  HostGfx() : w_(0), h_(0), depth_(16), clipX0_(0), clipY0_(0), clipX1_(0), clipY1_(0),
+              font_(nullptr), runtime_(nullptr), fore_(0xFFFFFFFFu), back_(0xFFFFFFFFu), datum_(top_left), textSize_(1.0f) {}
+  virtual ~HostGfx() { delete runtime_; }
+  HostGfx(const HostGfx &) = delete;
+  HostGfx &operator=(const HostGfx &) = delete;
+
+  int32_t width() const { return w_; }
+  int32_t height() const { return h_; }
+  uint8_t getColorDepth() const { return (uint8_t)depth_; }
+  size_t bufferLength() const { return buf_.size(); }
+  uint32_t getPaletteCount() const { return (uint32_t)palette_.size(); }
+  const uint8_t *getBuffer() const { return buf_.data(); }
+  void *getBuffer() { return buf_.data(); }
+
+  // Drawing and pushes onto this surface stay inside the clip rectangle
+  void setClipRect(int32_t x, int32_t y, int32_t w, int32_t h) {
+    clipX0_ = x < 0 ? 0 : x;
+    clipY0_ = y < 0 ? 0 : y;
+    clipX1_ = x + w > w_ ? w_ : x + w;
+    clipY1_ = y + h > h_ ? h_ : y + h;
+  }
+  void clearClipRect() { setClipRect(0, 0, w_, h_); }
+
+  static uint16_t color565(uint8_t r, uint8_t g, uint8_t b) { return (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)); }
+  static uint32_t color888(uint8_t r, uint8_t g, uint8_t b) { return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b; }
+
+  // ---- Primitives ----
+  template <class T> void fillScreen(const T &c) { fillRectArgb(0, 0, w_, h_, hostColor(c)); }
+  template <class T> void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, const T &c) { fillRectArgb(x, y, w, h, hostColor(c)); }
+  template <class T> void drawPixel(int32_t x, int32_t y, const T &c) { spanArgb(x, y, 1, hostColor(c)); }
+  template <class T> void drawFastHLine(int32_t x, int32_t y, int32_t w, const T &c) { spanArgb(x, y, w, hostColor(c)); }
+  template <class T> void drawFastVLine(int32_t x, int32_t y, int32_t h, const T &c) { fillRectArgb(x, y, 1, h, hostColor(c)); }
+
+  template <class T> void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, const T &c) {
+    const uint32_t a = hostColor(c);
+    if (w <= 0 || h <= 0) return;
+    spanArgb(x, y, w, a);
+    if (h > 1) spanArgb(x, y + h - 1, w, a);
+    if (h > 2) {
+      fillRectArgb(x, y + 1, 1, h - 2, a);
+      if (w > 1) fillRectArgb(x + w - 1, y + 1, 1, h - 2, a);
+    }
+  }
+
+  template <class T> void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, const T &c) {
+    lineArgb(x0, y0, x1, y1, hostColor(c));
+  }
+
+  template <class T> void fillCircle(int32_t x0, int32_t y0, int32_t r, const T &c) {
+    const uint32_t a = hostColor(c);
+    fillRectArgb(x0, y0 - r, 1, 2 * r + 1, a);
+    circleHelper(x0, y0, r, 3, 0, a);
+  }
+
+  template <class T> void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, const T &c) {
+    const uint32_t a = hostColor(c);
+    const int32_t maxr = ((w < h) ? w : h) / 2;
+    if (r > maxr) r = maxr;
+    fillRectArgb(x + r, y, w - 2 * r, h, a);
+    circleHelper(x + w - r - 1, y + r, r, 1, h - 2 * r - 1, a);
+    circleHelper(x + r, y + r, r, 2, h - 2 * r - 1, a);
+  }
+
+  template <class T> void fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const T &c) {
+    triangleArgb(x0, y0, x1, y1, x2, y2, hostColor(c));
+  }
+
+  // Ring sector between radii r0 and r1 (either order), angles in degrees
+  // clockwise from 3 o'clock; a span of 360 or more is the whole ring
+  template <class T> void fillArc(int32_t x, int32_t y, int32_t r0, int32_t r1, float angle0, float angle1, const T &c) {
+    arcArgb(x, y, r0, r1, angle0, angle1, hostColor(c));
+  }
+
+  // Horizontal line, color interpolated from c0 (left) to c1 (right)
+  template <class T1, class T2> void drawGradientHLine(int32_t x, int32_t y, int32_t w, const T1 &c0, const T2 &c1) {
+    const uint32_t a = hostColor(c0), b = hostColor(c1);
+    const int32_t d = (w > 1) ? w - 1 : 1;
+    for (int32_t i = 0; i < w; ++i) {
+      const uint32_t r = ((a >> 16) & 0xFF) + ((int32_t)((b >> 16) & 0xFF) - (int32_t)((a >> 16) & 0xFF)) * i / d;
+      const uint32_t g = ((a >> 8) & 0xFF) + ((int32_t)((b >> 8) & 0xFF) - (int32_t)((a >> 8) & 0xFF)) * i / d;
+      const uint32_t bl = (a & 0xFF) + ((int32_t)(b & 0xFF) - (int32_t)(a & 0xFF)) * i / d;
+      spanArgb(x + i, y, 1, 0xFF000000u | (r << 16) | (g << 8) | bl);
+    }
+  }
+
+  uint32_t readPixelArgb(int32_t x, int32_t y) const {
+    if (x < 0 || y < 0 || x >= w_ || y >= h_) return 0;
+    return loadRaw(rawAt(x, y));
+  }
+  uint16_t readPixel(int32_t x, int32_t y) const { return host565(readPixelArgb(x, y)); }
+
+  // ---- Text ----
+  void loadFont(const uint8_t *vlw) {
+    if (!runtime_) runtime_ = new HostVlwFont;
+    runtime_->load(vlw);  // parsed on every call, as on the device
+    font_ = runtime_;
+  }
+  void unloadFont() {
+    if (font_ == runtime_) font_ = nullptr;
+    delete runtime_;
+    runtime_ = nullptr;
+  }
+  // A font parsed elsewhere (lgfx::VLWfont), shared without copying
+  void setFont(const lgfx::IFont *f) {
+    const lgfx::VLWfont *v = static_cast<const lgfx::VLWfont *>(f);
+    font_ = v ? &v->vlw : nullptr;
+  }
+  template <class T> void setTextColor(const T &fg) { fore_ = back_ = hostColor(fg); }
+  template <class T1, class T2> void setTextColor(const T1 &fg, const T2 &bg) {
+    fore_ = hostColor(fg);
+    back_ = hostColor(bg);
+  }
+  void setTextDatum(textdatum_t d) { datum_ = d; }
+  void setTextDatum(uint8_t d) { datum_ = (textdatum_t)d; }
+  textdatum_t getTextDatum() const { return datum_; }
+  void setTextSize(float s) { textSize_ = s; }
+
+  int32_t fontHeight() const { return font_ ? (int32_t)(font_->yAdvance * textSize_) : (int32_t)(8 * textSize_); }
+
+  int32_t textWidth(const char *s) const {
+    int32_t w = 0;
+    for (uint32_t cp; (cp = nextCodepoint(s)) != 0;) w += advance(cp);
+    return w;
+  }
+
+  size_t drawString(const char *s, int32_t x, int32_t y) {
+    const int32_t w = textWidth(s);
+    const uint8_t d = datum_;
+    if ((d & 3) == 1) x -= w / 2;
+    else if ((d & 3) == 2) x -= w;
+    if (d & 16) y -= font_ ? (int32_t)(font_->maxAscent * textSize_) : 0;
+    else if (d & 8) y -= fontHeight();
+    else if (d & 4) y -= fontHeight() / 2;
+    if (!font_) return (size_t)w;
+
+    const bool fillbg = fore_ != back_;
+    const int32_t sx = (int32_t)(textSize_ < 1.0f ? 1 : textSize_ + 0.5f), sy = sx;
+    for (uint32_t cp; (cp = nextCodepoint(s)) != 0;) {
+      const HostVlwFont::Glyph *g = font_->find(cp);
+      const int32_t adv = advance(cp);
+      if (fillbg) fillRectArgb(x, y, adv, font_->yAdvance * sy, back_);
+      if (g) {
+        const int32_t gx = x + g->dX * sx, gy = y + (font_->maxAscent - g->dY) * sy;
+        const uint8_t *p = g->bitmap;
+        for (int32_t row = 0; row < g->height; ++row) {
+          for (int32_t col = 0; col < g->width; ++col) {
+            const uint32_t a = *p++;
+            if (!a) continue;
+            for (int32_t yy = 0; yy < sy; ++yy) {
+              for (int32_t xx = 0; xx < sx; ++xx) {
+                const int32_t px = gx + col * sx + xx, py = gy + row * sy + yy;
+                if (a == 255) spanArgb(px, py, 1, fore_);
+                else spanArgb(px, py, 1, hostBlend(fore_, fillbg ? back_ : readPixelArgb(px, py), a));
+              }
+            }
+          }
+        }
+      }
+      x += adv;
+    }
+    return (size_t)w;
+  }
+  size_t drawString(const std::string &s, int32_t x, int32_t y) { return drawString(s.c_str(), x, y); }
+
+  size_t drawFloat(float v, uint8_t dp, int32_t x, int32_t y) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", dp > 7 ? 7 : dp, (double)v);
+    return drawString(buf, x, y);
+  }
+  size_t drawNumber(long v, int32_t x, int32_t y) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%ld", v);
+    return drawString(buf, x, y);
+  }
+
+  // ---- Raw pixel access for pushes ----
+  // Copies src onto this surface at (x, y): ARGB alpha blends, pixels equal
+  // to the key (raw, in src's format) are skipped. Returns pixels written.
+  uint32_t blit(const HostGfx &src, int32_t x, int32_t y, bool useKey, uint32_t keyRaw) {
+    uint32_t written = 0, runs = 0;
+    // Source rectangle inside the clip
+    const int32_t sx0 = (clipX0_ - x > 0) ? clipX0_ - x : 0, sx1 = (clipX1_ - x < src.w_) ? clipX1_ - x : src.w_;
+    const int32_t sy0 = (clipY0_ - y > 0) ? clipY0_ - y : 0, sy1 = (clipY1_ - y < src.h_) ? clipY1_ - y : src.h_;
+    const uint64_t read = (sx1 > sx0 && sy1 > sy0) ? (uint64_t)(sx1 - sx0) * (sy1 - sy0) * src.bytesPerPixel() : 0;
+    for (int32_t sy = sy0; sy < sy1; ++sy) {
+      const int32_t dy = y + sy;
+      bool inRun = false;
+      for (int32_t sx = sx0; sx < sx1; ++sx) {
+        const int32_t dx = x + sx;
+        bool drawn = false;
+        const uint32_t raw = src.rawAt(sx, sy);
+        if (!(useKey && raw == keyRaw)) {
+          const uint32_t c = src.loadRaw(raw);
+          const uint32_t a = c >> 24;
+          if (a == 255) storeRaw(dx, dy, toRaw(c));
+          else if (a) storeRaw(dx, dy, toRaw(hostBlend(c, loadRaw(rawAt(dx, dy)), a)));
+          drawn = a != 0;
+        }
+        if (drawn) {
+          ++written;
+          if (!inRun) ++runs;
+        }
+        inRun = drawn;
+      }
+    }
+    onPush(written, runs, read);
+    return written;
+  }
+
+protected:
+  void allocate(int32_t w, int32_t h, int depth) {
+    w_ = w;
+    h_ = h;
+    depth_ = depth;
+    palette_.clear();
+    buf_.assign((size_t)w * h * bytesPerPixel(), 0);
+    clipX0_ = clipY0_ = 0;
+    clipX1_ = w;
+    clipY1_ = h;
+  }
+  void release() {
+    buf_.clear();
+    buf_.shrink_to_fit();
+    palette_.clear();
+    w_ = h_ = 0;
+    clipX1_ = clipY1_ = 0;
+  }
+  virtual void onPush(uint32_t, uint32_t, uint64_t) {}
+
+  int bytesPerPixel() const { return depth_ == 32 ? 4 : depth_ == 24 ? 3 : depth_ == 16 ? 2 : 1; }
+
+  uint32_t toRaw(uint32_t argb) const {
+    switch (depth_) {
+      case 32: return argb;
+      case 24: return argb & 0xFFFFFFu;
+      case 16: return host565(argb);
+      default: return host332(argb);
+    }
+  }
+  uint32_t loadRaw(uint32_t raw) const {
+    if (!palette_.empty()) return palette_[raw & 0xFF];
+    switch (depth_) {
+      case 32: return raw;
+      case 24: return hostArgb(raw);
+      case 16: return hostArgbFrom565((uint16_t)raw);
+      default: return hostArgbFrom332((uint8_t)raw);
+    }
+  }
+  uint32_t rawAt(int32_t x, int32_t y) const {
+    const uint8_t *p = &buf_[((size_t)y * w_ + x) * bytesPerPixel()];
+    switch (depth_) {
+      case 32: { uint32_t v; memcpy(&v, p, 4); return v; }
+      case 24: return (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+      case 16: { uint16_t v; memcpy(&v, p, 2); return v; }
+      default: return *p;
+    }
+  }
+  void storeRaw(int32_t x, int32_t y, uint32_t raw) {
+    uint8_t *p = &buf_[((size_t)y * w_ + x) * bytesPerPixel()];
+    switch (depth_) {
+      case 32: memcpy(p, &raw, 4); break;
+      case 24: p[0] = (uint8_t)(raw >> 16); p[1] = (uint8_t)(raw >> 8); p[2] = (uint8_t)raw; break;
+      case 16: { const uint16_t v = (uint16_t)raw; memcpy(p, &v, 2); break; }
+      default: *p = (uint8_t)raw;
+    }
+  }
+
+  // Clipped horizontal span; everything is drawn through here
+  void spanArgb(int32_t x, int32_t y, int32_t w, uint32_t argb) {
+    if (y < clipY0_ || y >= clipY1_) return;
+    if (x < clipX0_) { w -= clipX0_ - x; x = clipX0_; }
+    if (x + w > clipX1_) w = clipX1_ - x;
+    if (w <= 0) return;
+    const uint32_t raw = toRaw(argb);
+    for (int32_t i = 0; i < w; ++i) storeRaw(x + i, y, raw);
+  }
+  void fillRectArgb(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t argb) {
+    if (h < 0) { y += h + 1; h = -h; }
+    for (int32_t r = 0; r < h; ++r) spanArgb(x, y + r, w, argb);
+  }
+
+  void lineArgb(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t a) {
+    const bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep) { std::swap(x0, y0); std::swap(x1, y1); }
+    if (x0 > x1) { std::swap(x0, x1); std::swap(y0, y1); }
+    const int32_t dx = x1 - x0, dy = abs(y1 - y0), ystep = (y0 < y1) ? 1 : -1;
+    int32_t err = dx / 2;
+    for (; x0 <= x1; ++x0) {
+      if (steep) spanArgb(y0, x0, 1, a);
+      else spanArgb(x0, y0, 1, a);
+      err -= dy;
+      if (err < 0) { y0 += ystep; err += dx; }
+    }
+  }
+
+  // Quarter-circle fill (corners bit 1: right half, bit 2: left half)
+  void circleHelper(int32_t x0, int32_t y0, int32_t r, int corners, int32_t delta, uint32_t a) {
+    int32_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r, px = x, py = y;
+    ++delta;
+    while (x < y) {
+      if (f >= 0) { --y; ddy += 2; f += ddy; }
+      ++x; ddx += 2; f += ddx;
+      if (x < y + 1) {
+        if (corners & 1) fillRectArgb(x0 + x, y0 - y, 1, 2 * y + delta, a);
+        if (corners & 2) fillRectArgb(x0 - x, y0 - y, 1, 2 * y + delta, a);
+      }
+      if (y != py) {
+        if (corners & 1) fillRectArgb(x0 + py, y0 - px, 1, 2 * px + delta, a);
+        if (corners & 2) fillRectArgb(x0 - py, y0 - px, 1, 2 * px + delta, a);
+        py = y;
+      }
+      px = x;
+    }
+  }
+
+  void triangleArgb(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t c) {
+    if (y0 > y1) { std::swap(y0, y1); std::swap(x0, x1); }
+    if (y1 > y2) { std::swap(y2, y1); std::swap(x2, x1); }
+    if (y0 > y1) { std::swap(y0, y1); std::swap(x0, x1); }
+    if (y0 == y2) {
+      int32_t a = x0, b = x0;
+      if (x1 < a) a = x1; else if (x1 > b) b = x1;
+      if (x2 < a) a = x2; else if (x2 > b) b = x2;
+      spanArgb(a, y0, b - a + 1, c);
+      return;
+    }
+    const int32_t dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0, dx12 = x2 - x1, dy12 = y2 - y1;
+    int32_t sa = 0, sb = 0, y;
+    const int32_t last = (y1 == y2) ? y1 : y1 - 1;
+    for (y = y0; y <= last; ++y) {
+      int32_t a = x0 + sa / dy01, b = x0 + sb / dy02;
+      sa += dx01;
+      sb += dx02;
+      if (a > b) std::swap(a, b);
+      spanArgb(a, y, b - a + 1, c);
+    }
+    sa = dx12 * (y - y1);
+    sb = dx02 * (y - y0);
+    for (; y <= y2; ++y) {
+      int32_t a = x1 + sa / dy12, b = x0 + sb / dy02;
+      sa += dx12;
+      sb += dx02;
+      if (a > b) std::swap(a, b);
+      spanArgb(a, y, b - a + 1, c);
+    }
+  }
+
+  void arcArgb(int32_t cx, int32_t cy, int32_t r0, int32_t r1, float angle0, float angle1, uint32_t a) {
+    int32_t ro = r0, ri = r1;
+    if (ro < ri) std::swap(ro, ri);
+    float span = angle1 - angle0;
+    const bool full = span >= 360.0f || span <= -360.0f;
+    float s = fmodf(angle0, 360.0f);
+    if (s < 0) s += 360.0f;
+    span = fmodf(span, 360.0f);
+    if (span < 0) span += 360.0f;
+    if (!full && span == 0.0f) return;
+
+    // Sector edges as unit vectors; bounding box of the sector
+    const float s_rad = s * (float)M_PI / 180.0f, e_rad = (s + span) * (float)M_PI / 180.0f;
+    const float sxv = cosf(s_rad), syv = sinf(s_rad), exv = cosf(e_rad), eyv = sinf(e_rad);
+    int32_t bx0 = -ro, bx1 = ro, by0 = -ro, by1 = ro;
+    if (!full) {
+      float mnx = fminf(fminf(sxv * ro, exv * ro), fminf(sxv * ri, exv * ri));
+      float mxx = fmaxf(fmaxf(sxv * ro, exv * ro), fmaxf(sxv * ri, exv * ri));
+      float mny = fminf(fminf(syv * ro, eyv * ro), fminf(syv * ri, eyv * ri));
+      float mxy = fmaxf(fmaxf(syv * ro, eyv * ro), fmaxf(syv * ri, eyv * ri));
+      for (int q = 0; q < 4; ++q) {  // axis extremes inside the span
+        float rel = fmodf(q * 90.0f - s + 360.0f, 360.0f);
+        if (rel <= span) {
+          if (q == 0) mxx = (float)ro;
+          if (q == 1) mxy = (float)ro;
+          if (q == 2) mnx = (float)-ro;
+          if (q == 3) mny = (float)-ro;
+        }
+      }
+      bx0 = (int32_t)floorf(mnx) - 1; bx1 = (int32_t)ceilf(mxx) + 1;
+      by0 = (int32_t)floorf(mny) - 1; by1 = (int32_t)ceilf(mxy) + 1;
+      if (bx0 < -ro) bx0 = -ro;
+      if (bx1 > ro) bx1 = ro;
+      if (by0 < -ro) by0 = -ro;
+      if (by1 > ro) by1 = ro;
+    }
+    const int32_t ro2 = ro * ro + ro, ri2 = (ri > 0) ? ri * ri - ri : -1;
+    const bool wide = span > 180.0f;
+    for (int32_t dy = by0; dy <= by1; ++dy) {
+      int32_t run = 0, runX = 0;
+      for (int32_t dx = bx0; dx <= bx1 + 1; ++dx) {
+        bool in = false;
+        if (dx <= bx1) {
+          const int32_t d2 = dx * dx + dy * dy;
+          if (d2 <= ro2 && d2 > ri2) {
+            if (full) {
+              in = true;
+            } else {
+              const float cs = sxv * dy - syv * dx;  // >= 0: at/after start edge
+              const float ce = exv * dy - eyv * dx;  // <= 0: at/before end edge
+              in = wide ? (cs >= 0 || ce <= 0) : (cs >= 0 && ce <= 0);
+            }
+          }
+        }
+        if (in) {
+          if (!run) runX = dx;
+          ++run;
+        } else if (run) {
+          spanArgb(cx + runX, cy + dy, run, a);
+          run = 0;
+        }
+      }
+    }
+  }
+
+  static uint32_t nextCodepoint(const char *&s) {
+    const uint8_t c = (uint8_t)*s;
+    if (!c) return 0;
+    ++s;
+    if (c < 0x80 || !*s) return c;
+    if ((c & 0xE0) == 0xC0) return ((uint32_t)(c & 0x1F) << 6) | ((uint8_t)*s++ & 0x3F);
+    if ((c & 0xF0) == 0xE0 && s[1]) {
+      const uint32_t v = ((uint32_t)(c & 0x0F) << 12) | ((uint32_t)((uint8_t)s[0] & 0x3F) << 6) | ((uint8_t)s[1] & 0x3F);
+      s += 2;
+      return v;
+    }
+    return c;
+  }
+
+  int32_t advance(uint32_t cp) const {
+    const int32_t sx = (int32_t)(textSize_ < 1.0f ? 1 : textSize_ + 0.5f);
+    if (!font_) return 6 * sx;
+    const HostVlwFont::Glyph *g = font_->find(cp);
+    return (g ? g->xAdvance : font_->spaceWidth) * sx;
+  }
+
+  std::vector<uint8_t> buf_;
+  std::vector<uint32_t> palette_;  // ARGB; empty: no palette
+  int32_t w_, h_;
+  int depth_;
+  int32_t clipX0_, clipY0_, clipX1_, clipY1_;
+
+  const HostVlwFont *font_;  // current: runtime_ or a shared lgfx::VLWfont
+  HostVlwFont *runtime_;     // owned, from loadFont()
+  uint32_t fore_, back_;
+  textdatum_t datum_;
+  float textSize_;
+};
+
+// ---- The panel: 320x240 RGB565 ----
+struct HostPushStats {
+  uint64_t pushes;     // pushSprite calls
+  uint64_t pixels;     // pixels sent (2 bytes each on the SPI bus)
+  uint64_t runs;       // contiguous runs (one address window each)
+  uint64_t src_bytes;  // sprite memory read by the pushes
+};
+
+class HostDisplay : public HostGfx {
+public:
+  HostDisplay() { allocate(320, 240, 16); memset(&stats, 0, sizeof(stats)); }
+  HostPushStats stats;
+
+  void startWrite() {}
+  void endWrite() {}
+  void waitDMA() {}
+
+  // Raw 16-bit sprite pixels, row-major w x h
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const lgfx::swap565_t *data) {
+    for (int32_t r = 0; r < h; ++r) {
+      for (int32_t c = 0; c < w; ++c) {
+        if (x + c >= 0 && y + r >= 0 && x + c < w_ && y + r < h_) storeRaw(x + c, y + r, data[(size_t)r * w + c].raw);
+      }
+    }
+    onPush((uint32_t)(w * h), 1, (uint64_t)w * h * 2);
+  }
+
+  // RGB888 copy of the panel, row-major
+  void toRgb(std::vector<uint8_t> &out) const {
+    out.resize((size_t)w_ * h_ * 3);
+    for (int32_t y = 0; y < h_; ++y) {
+      for (int32_t x = 0; x < w_; ++x) {
+        const uint32_t c = loadRaw(rawAt(x, y));
+        uint8_t *p = &out[((size_t)y * w_ + x) * 3];
+        p[0] = (uint8_t)(c >> 16);
+        p[1] = (uint8_t)(c >> 8);
+        p[2] = (uint8_t)c;
+      }
+    }
+  }
+
+protected:
+  void onPush(uint32_t pixels, uint32_t runs, uint64_t read) override {
+    ++stats.pushes;
+    stats.pixels += pixels;
+    stats.runs += runs;
+    stats.src_bytes += read;
+  }
+};
+
+// ---- Sprite (M5Canvas) ----
+class HostCanvas : public HostGfx {
+public:
+  explicit HostCanvas(HostGfx *parent = nullptr) : parent_(parent), wantDepth_(16) {}
+
+  void setColorDepth(int bits) { wantDepth_ = (bits == 32 || bits == 24 || bits == 16 || bits == 8) ? bits : 16; }
+  void *createSprite(int32_t w, int32_t h) {
+    allocate(w, h, wantDepth_);
+    return buf_.data();
+  }
+  void deleteSprite() { release(); }
+
+  // 8-bit sprites only: 256 entries, black until set
+  bool createPalette() {
+    if (!w_ || depth_ != 8) return false;
+    palette_.assign(256, 0xFF000000u);
+    return true;
+  }
+  void setPaletteColor(size_t index, uint32_t rgb888) {
+    if (index < palette_.size()) palette_[index] = hostArgb(rgb888);
+  }
+
+  void pushSprite(int32_t x, int32_t y) { if (parent_) parent_->blit(*this, x, y, false, 0); }
+  template <class T> void pushSprite(int32_t x, int32_t y, const T &transp) {
+    if (parent_) parent_->blit(*this, x, y, true, keyRaw(transp));
+  }
+  void pushSprite(HostGfx *dst, int32_t x, int32_t y) { dst->blit(*this, x, y, false, 0); }
+  template <class T> void pushSprite(HostGfx *dst, int32_t x, int32_t y, const T &transp) {
+    dst->blit(*this, x, y, true, keyRaw(transp));
+  }
+
+private:
+  // Palette sprites take the key as an index, others as a color
+  template <class T> uint32_t keyRaw(const T &transp) const {
+    return palette_.empty() ? toRaw(hostColor(transp)) : ((uint32_t)transp & 0xFF);
+  }
+
+  HostGfx *parent_;
+  int wantDepth_;
+};
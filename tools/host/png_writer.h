@@ -0,0 +1,92 @@
+#pragma once
+/*
+  png_writer.h  —  Minimal PNG writer for host frame dumps
+  ---------------------------------------------------------
+  - 8-bit RGB, no filtering, zlib stream of stored (uncompressed) deflate
+    blocks: no compressor needed and the bytes depend only on the pixels,
+    so dumped frames compare byte-for-byte as golden images
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+static inline uint32_t pngCrc(uint32_t crc, const uint8_t *p, size_t n) {
+  static uint32_t table[256];
+  if (!table[1]) {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      table[i] = c;
+    }
+  }
+  crc = ~crc;
+  for (size_t i = 0; i < n; ++i) crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+static inline void pngPut32(std::vector<uint8_t> &v, uint32_t x) {
+  v.push_back((uint8_t)(x >> 24));
+  v.push_back((uint8_t)(x >> 16));
+  v.push_back((uint8_t)(x >> 8));
+  v.push_back((uint8_t)x);
+}
+
+static inline void pngChunk(std::vector<uint8_t> &out, const char *type, const std::vector<uint8_t> &data) {
+  pngPut32(out, (uint32_t)data.size());
+  const size_t at = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  pngPut32(out, pngCrc(0, &out[at], out.size() - at));
+}
+
+// rgb: w*h*3 bytes, row-major. Returns the PNG file bytes.
+static inline std::vector<uint8_t> encodePng(int w, int h, const uint8_t *rgb) {
+  std::vector<uint8_t> out = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+  std::vector<uint8_t> ihdr;
+  pngPut32(ihdr, (uint32_t)w);
+  pngPut32(ihdr, (uint32_t)h);
+  ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 });  // 8-bit RGB, deflate, no filter, no interlace
+  pngChunk(out, "IHDR", ihdr);
+
+  // Raw scanlines: filter byte 0 + RGB
+  std::vector<uint8_t> raw;
+  raw.reserve((size_t)h * (w * 3 + 1));
+  for (int y = 0; y < h; ++y) {
+    raw.push_back(0);
+    raw.insert(raw.end(), rgb + (size_t)y * w * 3, rgb + (size_t)(y + 1) * w * 3);
+  }
+
+  // zlib: header, stored blocks (<= 65535 bytes), Adler-32
+  std::vector<uint8_t> z = { 0x78, 0x01 };
+  uint32_t a = 1, b = 0;
+  for (uint8_t c : raw) {
+    a = (a + c) % 65521;
+    b = (b + a) % 65521;
+  }
+  for (size_t pos = 0; pos < raw.size() || raw.empty();) {
+    const size_t n = (raw.size() - pos < 65535) ? raw.size() - pos : 65535;
+    z.push_back(pos + n == raw.size() ? 1 : 0);
+    z.push_back((uint8_t)n);
+    z.push_back((uint8_t)(n >> 8));
+    z.push_back((uint8_t)~n);
+    z.push_back((uint8_t)(~n >> 8));
+    z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + n);
+    pos += n;
+    if (raw.empty()) break;
+  }
+  pngPut32(z, (b << 16) | a);
+  pngChunk(out, "IDAT", z);
+  pngChunk(out, "IEND", std::vector<uint8_t>());
+  return out;
+}
+
+static inline bool writePng(const char *path, int w, int h, const uint8_t *rgb) {
+  const std::vector<uint8_t> png = encodePng(w, h, rgb);
+  FILE *fp = fopen(path, "wb");
+  if (!fp) return false;
+  const bool ok = fwrite(png.data(), 1, png.size(), fp) == png.size();
+  fclose(fp);
+  return ok;
+}
@@ -0,0 +1,365 @@
+/*
+  hud_render.cpp  —  Headless HUD rendering: per-widget timing and frame dumps
+  --------------------------------------------------------------------------
+  - Builds relativistic_clock_hud.h / hud_gauges.h unchanged against the
+    software canvas in tools/host (M5Unified.h, host_gfx.h)
+  - Setup as in the sketch (compositor, background and static layers,
+    dynamic canvases), then <frames> loop() frames of a synthetic drive at
+    16 ms; the header is redrawn every 200 ms like the sketch
+  - Per widget: host time per call (draw + push), panel pixels and address
+    windows pushed per call, pixels marked dirty; the compositor's flush
+    as its own row. Sprite RAM (pixels and palettes) and sprite bytes read
+    by the panel pushes per frame
+  - --direct: no compositor, every widget pushes straight to the panel
+    (the panel must end up identical)
+  - --schedule: the sketch's frame scheduler (hud_scheduler.h) in virtual
+    time instead of a 16 ms frame: 25 Hz fixes, every widget at its own
+    refresh policy, sleeping to the next deadline or fix; adds achieved
+    vs. target rates and pixels per second. Frames differ from the
+    unscheduled run, so compare --png / --golden dumps only among
+    --schedule runs
+  - --png <dir>: dumps the panel as PNG every --every frames (default 60)
+  - --golden <dir>: renders the same frames and compares them byte-for-byte
+    with an earlier --png dump; exit code 1 on any mismatch
+  - --zoom <level>: dilation chart from the history pyramid (0..3: 1 s,
+    10 s, 1 min, 10 min per column; default -1, one frame per column)
+  - Heap allocations (operator new; the host String allocates like the
+    device's) made inside the widget draws, first frame (caches, fonts,
+    atlases) and later frames separately;
+    --no-alloc: exit code 1 if any frame after the first allocates
+
+  Build (from the repository root):
+    g++ -O2 -std=c++11 -I. -Itools/host tools/hud_render/hud_render.cpp -o hud_render
+
+  Run:
+    ./hud_render [frames] [--png dir | --golden dir] [--every n] [--zoom level] [--no-alloc] [--direct] [--schedule]
+    (default 600 frames; passes with --schedule)
+*/
+
+#include "relativistic_clock_hud.h"
+#include "hud_scheduler.h"
+#include "png_writer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+// ---- Heap allocation counter (armed around the widget draws only) ----
+static bool g_countAllocs = false;
+static uint64_t g_allocs = 0;
+
+void *operator new(size_t n) {
+  if (g_countAllocs) ++g_allocs;
+  void *p = malloc(n ? n : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void *operator new[](size_t n) { return operator new(n); }
+void *operator new(size_t n, const std::nothrow_t &) noexcept {
+  if (g_countAllocs) ++g_allocs;
+  return malloc(n ? n : 1);
+}
+void *operator new[](size_t n, const std::nothrow_t &t) noexcept { return operator new(n, t); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+// ---- Canvas instances (as in the sketch) ----
+M5Canvas canvasBackground(&M5.Display);
+M5Canvas canvasStaticVelocity(&M5.Display);
+M5Canvas canvasStaticAltitude(&M5.Display);
+M5Canvas canvasStaticLatitude(&M5.Display);
+M5Canvas canvasStaticTotalVelocity(&M5.Display);
+M5Canvas canvasStaticLocalGravity(&M5.Display);
+M5Canvas canvasStaticTimeDilation(&M5.Display);
+M5Canvas canvasStaticHeader(&M5.Display);
+M5Canvas canvasStaticLineChart(&M5.Display);
+
+M5Canvas canvasDynamicVelocity(&M5.Display);
+M5Canvas canvasDynamicAltitude(&M5.Display);
+M5Canvas canvasDynamicLatitude(&M5.Display);
+M5Canvas canvasDynamicTotalVelocity(&M5.Display);
+M5Canvas canvasDynamicLocalGravity(&M5.Display);
+M5Canvas canvasDynamicTimeDilation(&M5.Display);
+M5Canvas canvasDynamicHeader(&M5.Display);
+M5Canvas canvasDynamicLineChart(&M5.Display);
+
+HudCompositor hudCompositor;
+
+static M5Canvas *const CANVASES[] = {
+  &canvasBackground, &canvasStaticVelocity, &canvasStaticAltitude, &canvasStaticLatitude,
+  &canvasStaticTotalVelocity, &canvasStaticLocalGravity, &canvasStaticTimeDilation,
+  &canvasStaticHeader, &canvasStaticLineChart,
+  &canvasDynamicVelocity, &canvasDynamicAltitude, &canvasDynamicLatitude, &canvasDynamicTotalVelocity,
+  &canvasDynamicLocalGravity, &canvasDynamicTimeDilation, &canvasDynamicHeader, &canvasDynamicLineChart
+};
+
+typedef std::chrono::steady_clock Clock;
+
+// ---- Synthetic drive: what loop() would pass to the HUD ----
+struct Inputs {
+  double alt_m, az_deg, lat_deg, vrot_kmh, vtot_kmh, g, ns_h, offset_ns, hdop;
+  int batt, sats;
+  bool gpsOK;
+};
+
+static Inputs inputsAt(int frame) {
+  const double t = frame * 0.016;
+  Inputs in;
+  in.alt_m = -300.0 + 9500.0 * (0.5 - 0.5 * cos(t / 8.0));
+  in.az_deg = fmod(t * 20.0, 360.0);
+  in.lat_deg = 40.0 * sin(t / 5.0);
+  in.vrot_kmh = 1674.4 * cos(in.lat_deg * M_PI / 180.0);
+  in.vtot_kmh = in.vrot_kmh + 900.0 * fabs(sin(t / 3.0));
+  in.g = 9.780 + 0.052 * sin(in.lat_deg * M_PI / 180.0) * sin(in.lat_deg * M_PI / 180.0) - 3.086e-6 * in.alt_m;
+  in.ns_h = -4.0 + 5.0 * sin(t / 4.0);
+  in.offset_ns = -1.2 * t;
+  in.hdop = 0.7 + 6.0 * (0.5 + 0.5 * sin(t / 2.0));
+  in.batt = 100 - frame / 40 % 100;
+  in.sats = 8 + frame / 30 % 10;
+  in.gpsOK = (frame / 90) % 5 != 4;  // a dropout now and then (azimuth arc hidden)
+  return in;
+}
+
+// ---- Widgets, in loop() order ----
+struct Widget {
+  const char *name;
+  void (*draw)(const Inputs &);
+  uint32_t period_ms;  // 0: every frame
+  uint32_t events;     // --schedule: events that redraw it (period_ms then a fallback)
+  int task;
+  double ns, max_ns;
+  uint64_t calls, pixels, runs, marked;
+};
+
+static void wAltitude(const Inputs &in) { drawDynamicAltitude(in.alt_m, in.gpsOK ? in.az_deg : -1); }
+static void wLatitude(const Inputs &in) { drawDynamicLatitude(in.lat_deg); }
+static void wVelocity(const Inputs &in) { drawDynamicVelocity(in.vrot_kmh); }
+static void wTotalVelocity(const Inputs &in) { drawDynamicTotalVelocity(in.vtot_kmh); }
+static void wGravity(const Inputs &in) { drawDynamicLocalGravity(in.g); }
+static void wDilation(const Inputs &in) { drawDynamicTimeDilation(in.ns_h, in.offset_ns); }
+static DilationHistory history;
+static int chartLevel = -1;
+static void wChart(const Inputs &in) { drawDynamicLineChart(in.ns_h, &history, chartLevel); }
+static void wHeader(const Inputs &in) { drawDynamicHeader(in.hdop, in.batt, in.sats); }
+
+// Unscheduled: every frame, the header every 200 ms. --schedule: the
+// sketch's policies (HAE altitude, so no barometer events)
+enum : uint32_t { EV_FIX = 1 };
+static const uint32_t FIX_MS = 40;  // 25 Hz navigation
+
+static Widget WIDGETS[] = {
+  { "altitude", wAltitude, 0, 0, -1, 0, 0, 0, 0, 0, 0 },
+  { "latitude", wLatitude, 0, EV_FIX, -1, 0, 0, 0, 0, 0, 0 },
+  { "velocity", wVelocity, 0, EV_FIX, -1, 0, 0, 0, 0, 0, 0 },
+  { "total velocity", wTotalVelocity, 0, EV_FIX, -1, 0, 0, 0, 0, 0, 0 },
+  { "local gravity", wGravity, 0, EV_FIX, -1, 0, 0, 0, 0, 0, 0 },
+  { "time dilation", wDilation, 0, 0, -1, 0, 0, 0, 0, 0, 0 },
+  { "line chart", wChart, 0, EV_FIX, -1, 0, 0, 0, 0, 0, 0 },
+  { "header", wHeader, 200, 0, -1, 0, 0, 0, 0, 0, 0 },
+};
+static const uint32_t SCHEDULE_MS[] = { 33, 0, 0, 0, 0, 100, 1000, 200 };
+static const int NUM_WIDGETS = sizeof(WIDGETS) / sizeof(WIDGETS[0]);
+
+static bool readFile(const std::string &path, std::vector<uint8_t> &out) {
+  FILE *fp = fopen(path.c_str(), "rb");
+  if (!fp) return false;
+  uint8_t buf[65536];
+  size_t n;
+  out.clear();
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) out.insert(out.end(), buf, buf + n);
+  fclose(fp);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  int frames = 600, every = 60;
+  std::string pngDir, goldenDir;
+  bool noAlloc = false, direct = false, schedule = false;
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    if (a == "--png" && i + 1 < argc) pngDir = argv[++i];
+    else if (a == "--golden" && i + 1 < argc) goldenDir = argv[++i];
+    else if (a == "--every" && i + 1 < argc) every = atoi(argv[++i]);
+    else if (a == "--zoom" && i + 1 < argc) chartLevel = atoi(argv[++i]);
+    else if (a == "--no-alloc") noAlloc = true;
+    else if (a == "--direct") direct = true;
+    else if (a == "--schedule") schedule = true;
+    else frames = atoi(argv[i]);
+  }
+  if (every < 1) every = 1;
+
+  // ---- Setup (as in the sketch) ----
+  const Clock::time_point s0 = Clock::now();
+  hudCompositor.begin(M5.Display, !direct);
+  drawBackground();
+  drawStaticHeader();
+  drawStaticLineChart();
+  drawStaticVelocity();
+  drawStaticLocalGravity();
+  drawStaticTimeDilation();
+  drawStaticTotalVelocity();
+  drawStaticAltitude();
+  drawStaticLatitude();
+  createDynamicCanvases();
+  hudCompositor.flush();
+  const double setup_us = std::chrono::duration<double, std::micro>(Clock::now() - s0).count();
+
+  size_t ram = 0;
+  for (M5Canvas *c : CANVASES) ram += c->bufferLength() + 3 * c->getPaletteCount();  // RGB888 entries
+
+  // ---- Frames ----
+  int mismatches = 0, dumped = 0;
+  uint32_t tHeader = 0;
+  std::vector<uint8_t> rgb, golden;
+  double frame_ns = 0, frame_max_ns = 0;
+  Widget flush = { "flush", nullptr, 0, 0, -1, 0, 0, 0, 0, 0, 0 };
+  HudScheduler sched(16);
+  if (schedule) {
+    for (int w = 0; w < NUM_WIDGETS; ++w) WIDGETS[w].task = sched.add(WIDGETS[w].name, SCHEDULE_MS[w], WIDGETS[w].events);
+  }
+  uint32_t now = 0, nextFix = 0;
+  uint64_t allocs_first = 0, allocs_later = 0;
+  int alloc_frames = 0;
+  const uint64_t px0 = M5.Display.stats.pixels;
+  const uint64_t src0 = M5.Display.stats.src_bytes;
+
+  for (int f = 0; f < frames; ++f) {
+    if (!schedule) now = (uint32_t)f * 16;
+    Inputs in = inputsAt(schedule ? (int)(now / 16) : f);
+    if (schedule) {
+      const bool fix = now == nextFix;
+      if (fix) nextFix += FIX_MS;
+      if (fix && in.gpsOK) sched.signal(EV_FIX);
+    } else {
+      history.add(now, (float)in.ns_h);
+    }
+    double this_frame = 0;
+    const uint64_t a0 = g_allocs;
+    g_countAllocs = true;
+
+    for (int w = 0; w < NUM_WIDGETS; ++w) {
+      Widget &wd = WIDGETS[w];
+      if (schedule) {
+        if (!sched.due(wd.task, now)) continue;
+        if (wd.draw == wChart) history.add(now, (float)in.ns_h);  // one point per fix
+      } else if (wd.period_ms) {
+        if (f != 0 && now - tHeader < wd.period_ms) continue;
+        tHeader = now;
+      }
+      const HostPushStats before = M5.Display.stats;
+      const uint64_t marked = hudCompositor.stats.marked;
+      const Clock::time_point t0 = Clock::now();
+      wd.draw(in);
+      const double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+      wd.ns += ns;
+      if (ns > wd.max_ns) wd.max_ns = ns;
+      ++wd.calls;
+      wd.pixels += M5.Display.stats.pixels - before.pixels;
+      wd.runs += M5.Display.stats.runs - before.runs;
+      wd.marked += hudCompositor.stats.marked - marked;
+      this_frame += ns;
+    }
+    {
+      const HostPushStats before = M5.Display.stats;
+      const Clock::time_point t0 = Clock::now();
+      hudCompositor.flush();
+      const double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+      flush.ns += ns;
+      if (ns > flush.max_ns) flush.max_ns = ns;
+      ++flush.calls;
+      flush.pixels += M5.Display.stats.pixels - before.pixels;
+      flush.runs += M5.Display.stats.runs - before.runs;
+      this_frame += ns;
+    }
+    g_countAllocs = false;
+    if (f == 0) {
+      allocs_first = g_allocs - a0;
+    } else if (g_allocs != a0) {
+      allocs_later += g_allocs - a0;
+      ++alloc_frames;
+    }
+    frame_ns += this_frame;
+    if (this_frame > frame_max_ns) frame_max_ns = this_frame;
+    if (schedule && f + 1 < frames) {
+      // Sleep to the next deadline, or wake on the next fix
+      const uint32_t wait = sched.sleepMs(now);
+      if (wait) {
+        const uint32_t wake = now + wait;
+        sched.slept(nextFix < wake);
+        now = (nextFix < wake) ? nextFix : wake;
+      }
+    }
+
+    if ((!pngDir.empty() || !goldenDir.empty()) && f % every == 0) {
+      M5.Display.toRgb(rgb);
+      const std::vector<uint8_t> png = encodePng(M5.Display.width(), M5.Display.height(), rgb.data());
+      char name[32];
+      snprintf(name, sizeof(name), "/frame_%05d.png", f);
+      if (!pngDir.empty()) {
+        const std::string path = pngDir + name;
+        FILE *fp = fopen(path.c_str(), "wb");
+        if (!fp || fwrite(png.data(), 1, png.size(), fp) != png.size()) {
+          fprintf(stderr, "cannot write %s\n", path.c_str());
+          return 2;
+        }
+        fclose(fp);
+      } else if (!readFile(goldenDir + name, golden) || golden != png) {
+        printf("MISMATCH %s%s\n", goldenDir.c_str(), name);
+        ++mismatches;
+      }
+      ++dumped;
+    }
+  }
+
+  // ---- Report ----
+  printf("setup (static layers + canvases): %.0f us, sprite RAM %zu bytes\n", setup_us, ram);
+  printf("%-16s %8s %10s %10s %10s %8s %10s\n", "widget", "calls", "us/call", "max us", "px/call", "windows", "dirty px");
+  for (int w = 0; w <= NUM_WIDGETS; ++w) {
+    const Widget &wd = (w < NUM_WIDGETS) ? WIDGETS[w] : flush;
+    if (!wd.calls) continue;
+    printf("%-16s %8llu %10.2f %10.2f %10.0f %8.1f %10.0f\n", wd.name, (unsigned long long)wd.calls,
+           wd.ns / wd.calls * 1e-3, wd.max_ns * 1e-3, (double)wd.pixels / wd.calls, (double)wd.runs / wd.calls,
+           (double)wd.marked / wd.calls);
+  }
+  if (hudCompositor.compositing()) {
+    const HudCompositor::Stats &cs = hudCompositor.stats;
+    printf("compositor: %.2f windows, %.2f DMA transfers per flush\n",
+           (double)cs.rects / cs.frames, (double)cs.chunks / cs.frames);
+  }
+  printf("frame: %.2f us mean, %.2f us max, %.0f px pushed (%.0f SPI bytes), %.0f sprite bytes read per frame\n",
+         frame_ns / frames * 1e-3, frame_max_ns * 1e-3,
+         (double)(M5.Display.stats.pixels - px0) / frames, 2.0 * (M5.Display.stats.pixels - px0) / frames,
+         (double)(M5.Display.stats.src_bytes - src0) / frames);
+  if (schedule) {
+    const uint32_t span = now ? now : 1;
+    printf("schedule: %d passes over %.2f s (%.1f per s), %.0f px pushed per s, %lu sleeps cut short by a fix\n",
+           frames, span * 1e-3, frames * 1000.0 / span, (double)(M5.Display.stats.pixels - px0) * 1000.0 / span,
+           (unsigned long)sched.stats.woken);
+    printf("%-16s %10s %10s %8s\n", "widget", "achieved", "target", "late");
+    for (int w = 0; w < NUM_WIDGETS; ++w) {
+      const int id = WIDGETS[w].task;
+      printf("%-16s %7.1f Hz %7.1f Hz %8lu\n", WIDGETS[w].name, sched.achievedHz(id, now), sched.targetHz(id, now),
+             (unsigned long)sched.task(id).late);
+    }
+  }
+  printf("heap allocations: %llu in frame 0 (caches), %llu in %d later frames\n",
+         (unsigned long long)allocs_first, (unsigned long long)allocs_later, alloc_frames);
+
+  if (!pngDir.empty()) printf("wrote %d frames to %s\n", dumped, pngDir.c_str());
+  if (!goldenDir.empty()) {
+    printf("golden: %d frames compared, %d mismatches\n", dumped, mismatches);
+    printf("%s\n", mismatches ? "FAIL" : "PASS");
+    if (mismatches) return 1;
+  }
+  if (noAlloc) {
+    printf("no-alloc: %s\n", allocs_later ? "FAIL" : "PASS");
+    if (allocs_later) return 1;
+  }
+  return 0;
+}
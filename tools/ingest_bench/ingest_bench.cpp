@@ -0,0 +1,268 @@
+/*
+  ingest_bench.cpp  —  Host stress run for the GNSS ingest ring and framers
+  ------------------------------------------------------------------------
+  - Producer thread plays the UART: a synthetic receiver stream paced at a
+    multiple of 460800 baud (default 10x), delivered in 64-byte bursts
+    through FrameIngest::produce()
+      nmea: GGA/RMC/VTG + a numbered TXT sentence per 25 Hz epoch
+      ubx:  one NAV-PVT per epoch (iTOW numbers it) + NAV-CLOCK
+  - The stream also carries corrupted frames (bad checksum), overlong
+    frames and the other protocol's bytes between frames
+  - Consumer thread plays loop(): drains the ring with random stalls like
+    slow HUD frames, re-frames the bytes and checks every frame
+  - Verifies: every delivered frame is whole and valid, numbered frames
+    arrive in order (and NAV-PVT fields decode to what was sent), and
+      sent = delivered + dropped, corrupted = bad_sum, overlong = overlong
+  - Also prints UART bytes per fix for each protocol
+  - Exit code 0 on success
+
+  Build (from the repository root):
+    g++ -O2 -std=c++11 -pthread -I. tools/ingest_bench/ingest_bench.cpp -o ingest_bench
+
+  Run:
+    ./ingest_bench [seconds] [rate multiple] [nmea|ubx|both]   (default 5 s, 10x, both)
+*/
+
+#include "nmea_framer.h"
+#include "ubx_decoder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr size_t RING = 8192;  // same as GNSS_INGEST_RING
+
+struct Stream {
+  std::vector<uint8_t> bytes;
+  uint32_t sent = 0;       // valid frames
+  uint32_t numbered = 0;   // epochs (numbered frames)
+  uint32_t corrupted = 0;  // frames with a flipped byte
+  uint32_t overlong = 0;   // frames longer than the framer accepts
+};
+
+// ---- NMEA ----
+static std::string withChecksum(const std::string &body) {
+  uint8_t x = 0;
+  for (char c : body) x ^= (uint8_t)c;
+  char tail[8];
+  snprintf(tail, sizeof(tail), "*%02X\r\n", x);
+  return "$" + body + tail;
+}
+
+static const uint8_t UBX_ACK[] = { 0xB5, 0x62, 0x05, 0x01, 0x02, 0x00, 0x06, 0x08, 0x16, 0x3F };
+
+static void appendNmeaEpoch(Stream &s, std::mt19937 &rng) {
+  char body[160];
+  snprintf(body, sizeof(body), "GNGGA,123519.%02u,4807.038,N,01131.000,E,1,12,0.6,545.4,M,46.9,M,,", s.numbered % 100);
+  std::string out = withChecksum(body);
+  out += withChecksum("GNRMC,123519.00,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W,A");
+  out += withChecksum("GNVTG,084.4,T,,M,022.4,N,041.5,K,A");
+  snprintf(body, sizeof(body), "GNTXT,01,01,02,SEQ=%010u", s.numbered);
+  out += withChecksum(body);
+  s.sent += 4;
+  s.numbered++;
+
+  const uint32_t r = rng() % 1000;
+  if (r < 5) {
+    std::string bad = withChecksum("GNGSA,A,3,01,02,03,04,05,06,07,08,09,10,11,12,1.0,0.6,0.8,1");
+    bad[10] ^= 0x01;
+    out += bad;
+    s.corrupted++;
+  } else if (r < 8) {
+    // '$' then garbage with no LF, longer than NMEA_MAX_SENTENCE
+    out += "$GNGSV";
+    out += std::string(NMEA_MAX_SENTENCE + 10, 'x');
+    s.overlong++;
+  } else if (r < 20) {
+    out.append((const char *)UBX_ACK, sizeof(UBX_ACK));
+  }
+  s.bytes.insert(s.bytes.end(), out.begin(), out.end());
+}
+
+static int64_t nmeaSeq(const NmeaFramer &f) {
+  unsigned seq;
+  return sscanf(f.sentence(), "$GNTXT,01,01,02,SEQ=%u", &seq) == 1 ? (int64_t)seq : -1;
+}
+
+// ---- UBX ----
+static void appendUbx(std::vector<uint8_t> &out, uint8_t cls, uint8_t id, const void *payload, uint16_t len) {
+  const size_t at = out.size();
+  const uint8_t hdr[6] = { UBX_SYNC1, UBX_SYNC2, cls, id, (uint8_t)(len & 0xFF), (uint8_t)(len >> 8) };
+  out.insert(out.end(), hdr, hdr + 6);
+  out.insert(out.end(), (const uint8_t *)payload, (const uint8_t *)payload + len);
+  uint8_t a = 0, b = 0;
+  for (size_t i = at + 2; i < out.size(); ++i) ubxFletcher(a, b, out[i]);
+  out.push_back(a);
+  out.push_back(b);
+}
+
+static UbxNavPvt pvtFor(uint32_t seq) {
+  UbxNavPvt p;
+  memset(&p, 0, sizeof(p));
+  p.iTOW = seq * 40;
+  p.year = 2025;
+  p.month = 6;
+  p.day = 1;
+  p.hour = 12;
+  p.valid = UBX_PVT_VALID_DATE | UBX_PVT_VALID_TIME;
+  p.fixType = 3;
+  p.flags = UBX_PVT_GNSS_FIX_OK;
+  p.numSV = 12;
+  p.lat = -235000000 + (int32_t)seq;
+  p.lon = -466000000 - (int32_t)seq;
+  p.height = 760000 + (int32_t)(seq % 1000);
+  p.hMSL = 765000;
+  p.gSpeed = 27778;
+  p.headMot = 9000000;
+  p.pDOP = 120;
+  return p;
+}
+
+static void appendUbxEpoch(Stream &s, std::mt19937 &rng) {
+  const UbxNavPvt pvt = pvtFor(s.numbered);
+  appendUbx(s.bytes, UBX_CLASS_NAV, UBX_NAV_PVT, &pvt, sizeof(pvt));
+  const UbxNavClock clk = { pvt.iTOW, 1000, 5, 20, 300 };
+  appendUbx(s.bytes, UBX_CLASS_NAV, UBX_NAV_CLOCK, &clk, sizeof(clk));
+  s.sent += 2;
+  s.numbered++;
+
+  const uint32_t r = rng() % 1000;
+  if (r < 5) {
+    std::vector<uint8_t> bad;
+    appendUbx(bad, UBX_CLASS_NAV, UBX_NAV_CLOCK, &clk, sizeof(clk));
+    bad[10] ^= 0x01;
+    s.bytes.insert(s.bytes.end(), bad.begin(), bad.end());
+    s.corrupted++;
+  } else if (r < 8) {
+    // Header announcing a payload above UBX_MAX_PAYLOAD (payload is zeros)
+    std::vector<uint8_t> big(UBX_MAX_PAYLOAD + 40, 0);
+    appendUbx(s.bytes, 0x0A, 0x04, big.data(), (uint16_t)big.size());
+    s.overlong++;
+  } else if (r < 20) {
+    const std::string txt = withChecksum("GNTXT,01,01,02,ANTSTATUS=OK");
+    s.bytes.insert(s.bytes.end(), txt.begin(), txt.end());
+  }
+}
+
+static int64_t ubxSeq(const UbxDecoder &d) {
+  const UbxNavPvt *p = d.navPvt();
+  if (!p) return -1;
+  const uint32_t seq = p->iTOW / 40;
+  GnssFix fix;
+  ubxNavPvtToFix(*p, fix);
+  // Fields must decode to what was sent
+  const UbxNavPvt want = pvtFor(seq);
+  const bool ok = fix.fix_ok && fix.time_valid && fix.num_sv == 12 &&
+                  fabs(fix.lat_deg - want.lat * 1e-7) < 1e-12 &&
+                  fabs(fix.lon_deg - want.lon * 1e-7) < 1e-12 &&
+                  fabs(fix.hae_m - want.height * 1e-3) < 1e-9 &&
+                  fabs(fix.speed_kmh - 100.0008) < 1e-9 &&
+                  fabs(fix.heading_deg - 90.0) < 1e-12;
+  return ok ? (int64_t)seq : -2;
+}
+
+// ---- One run ----
+template <class Framer>
+static bool run(const char *name, const Stream &s, double bytes_per_s, double multiple,
+                int64_t (*seqOf)(const Framer &)) {
+  FrameIngest<Framer, RING> ingest;
+  std::atomic<bool> done(false);
+
+  // Producer: paced 64-byte bursts (UART RX FIFO threshold)
+  std::thread producer([&]() {
+    const auto t0 = std::chrono::steady_clock::now();
+    size_t pos = 0;
+    while (pos < s.bytes.size()) {
+      const size_t n = std::min<size_t>(64, s.bytes.size() - pos);
+      const auto due = t0 + std::chrono::duration<double>((pos + n) / bytes_per_s);
+      std::this_thread::sleep_until(due);
+      ingest.produce(&s.bytes[pos], n);
+      pos += n;
+    }
+    done.store(true);
+  });
+
+  // Consumer: random stalls, re-frame and check
+  uint32_t delivered = 0, invalid = 0, order_errors = 0, decode_errors = 0, numbered_seen = 0;
+  int64_t last_seq = -1;
+  size_t max_pending = 0;
+  std::mt19937 stall(777);
+  Framer check;
+  uint8_t buf[256];
+  for (;;) {
+    const bool finished = done.load();
+    const size_t pending = ingest.pending();
+    if (pending > max_pending) max_pending = pending;
+
+    size_t n;
+    while ((n = ingest.consume(buf, sizeof(buf))) > 0) {
+      for (size_t i = 0; i < n; ++i) {
+        const FrameStatus f = check.push(buf[i]);
+        if (f == FrameStatus::None) continue;
+        if (f != FrameStatus::Complete) {
+          ++invalid;
+          continue;
+        }
+        ++delivered;
+        const int64_t seq = seqOf(check);
+        if (seq == -2) ++decode_errors;
+        if (seq < 0) continue;
+        ++numbered_seen;
+        if (seq <= last_seq) ++order_errors;
+        last_seq = seq;
+      }
+    }
+    if (finished && ingest.pending() == 0) break;
+
+    // Frame time: usually 16 ms, sometimes a slow 40..120 ms frame
+    const int ms = (stall() % 10 == 0) ? 40 + (int)(stall() % 81) : 16;
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  }
+  producer.join();
+
+  const IngestStats &st = ingest.stats;
+  const bool ok = invalid == 0 && order_errors == 0 && decode_errors == 0 && check.stray() == 0 &&
+                  s.sent == delivered + st.dropped.load() &&
+                  s.corrupted == st.bad_sum.load() &&
+                  s.overlong == st.overlong.load() &&
+                  st.frames.load() == delivered;
+
+  printf("%s: %.0f B/s (%.0fx 460800 baud), %zu bytes, %.1f s, %.0f bytes/fix\n",
+         name, bytes_per_s, multiple, s.bytes.size(), s.bytes.size() / bytes_per_s,
+         (double)s.bytes.size() / s.numbered);
+  printf("  sent %u  delivered %u  dropped %u  bad_sum %u (injected %u)  overlong %u (injected %u)  stray %u\n",
+         s.sent, delivered, st.dropped.load(), st.bad_sum.load(), s.corrupted,
+         st.overlong.load(), s.overlong, st.stray.load());
+  printf("  numbered %u/%u in order  decode errors %u  max ring fill %zu/%zu  invalid at consumer %u\n",
+         numbered_seen, s.numbered, decode_errors, max_pending, RING, invalid);
+  printf("  %s\n\n", ok ? "PASS" : "FAIL");
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  const double seconds = (argc > 1) ? atof(argv[1]) : 5.0;
+  const double multiple = (argc > 2) ? atof(argv[2]) : 10.0;
+  const std::string which = (argc > 3) ? argv[3] : "both";
+  const double bytes_per_s = 460800.0 / 10.0 * multiple;  // 8N1: 10 bits per byte
+
+  bool ok = true;
+  if (which == "nmea" || which == "both") {
+    std::mt19937 rng(12345);
+    Stream s;
+    while (s.bytes.size() < bytes_per_s * seconds) appendNmeaEpoch(s, rng);
+    ok &= run<NmeaFramer>("nmea", s, bytes_per_s, multiple, nmeaSeq);
+  }
+  if (which == "ubx" || which == "both") {
+    std::mt19937 rng(12345);
+    Stream s;
+    while (s.bytes.size() < bytes_per_s * seconds) appendUbxEpoch(s, rng);
+    ok &= run<UbxDecoder>("ubx", s, bytes_per_s, multiple, ubxSeq);
+  }
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+/*
+  physics_bench.cpp  —  Host benchmark for the physics core
+  ---------------------------------------------------------
+  - Fixes/second for the scalar reference and each supported SIMD ISA
+  - Max ULP distance of every SIMD output vs. the scalar reference; ns/s and
+    total speed also as absolute error, since they cross zero (SR vs. GR,
+    westward motion cancelling rotation) where ULPs are meaningless
+  - DoubleFloat (float FPU) path vs. the double path: max error over a grid
+    covering the whole lat/alt/speed/azimuth envelope, and time per call.
+    On a host both run in hardware, so the timing only shows the float
+    path's op count; the device cycle counts come from the sketch
+    (PHYSICS_CYCLE_REPORT in relativistic_clock.ino)
+  - Checks both against the bounds documented in
+    relativistic_clock_physics_simd.h and relativistic_clock_physics_df.h;
+    exit code 0 if every path is within them
+
+  Build (from the repository root):
+    g++ -O2 -std=c++11 -I. tools/physics_bench/physics_bench.cpp -o physics_bench
+
+  Run:
+    ./physics_bench [fixes]        (default 4,000,000)
+*/
+
+#include "relativistic_clock_physics_simd.h"
+#include "relativistic_clock_physics_df.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// SIMD vs. scalar reference (relativistic_clock_physics_simd.h)
+static const int64_t SIMD_MAX_ULP_GRAVITY = 3;
+static const int64_t SIMD_MAX_ULP_RADIUS_ROT = 4;
+static const double SIMD_MAX_TOT = 1e-12;   // m/s
+static const double SIMD_MAX_NS_H = 2e-12;  // ns/h
+// DoubleFloat vs. double path (relativistic_clock_physics_df.h)
+static const double DF_MAX_NS_H = 1e-10;    // ns/h
+static const double DF_MAX_SPEED = 1e-10;   // m/s, rotation and total
+static const double DF_MAX_GRAVITY = 1e-6;  // m/s²
+
+static double secondsSince(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static int64_t ulpDistance(double a, double b) {
+  if (a == b) return 0;
+  if (isnan(a) || isnan(b)) return INT64_MAX;
+  int64_t ia, ib;
+  memcpy(&ia, &a, sizeof(ia));
+  memcpy(&ib, &b, sizeof(ib));
+  if (ia < 0) ia = INT64_MIN - ia;
+  if (ib < 0) ib = INT64_MIN - ib;
+  return ia > ib ? ia - ib : ib - ia;
+}
+
+static int64_t maxUlp(const std::vector<double> &a, const std::vector<double> &b) {
+  int64_t m = 0;
+  for (size_t i = 0; i < a.size(); ++i) {
+    const int64_t d = ulpDistance(a[i], b[i]);
+    if (d > m) m = d;
+  }
+  return m;
+}
+
+static double maxAbs(const std::vector<double> &a, const std::vector<double> &b, double scale = 1.0) {
+  double m = 0.0;
+  for (size_t i = 0; i < a.size(); ++i) {
+    const double d = fabs(a[i] - b[i]) * scale;
+    if (d > m) m = d;
+  }
+  return m;
+}
+
+struct Track {
+  std::vector<double> lat, alt, vel, az;
+  explicit Track(size_t n) : lat(n), alt(n), vel(n), az(n) {
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    auto next = [&x]() {
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      return double(x >> 11) * (1.0 / 9007199254740992.0);
+    };
+    for (size_t i = 0; i < n; ++i) {
+      lat[i] = -90.0 + 180.0 * next();
+      alt[i] = -500.0 + 20500.0 * next();
+      vel[i] = 3000.0 * next();
+      az[i] = 360.0 * next();
+    }
+  }
+};
+
+struct Outputs {
+  std::vector<double> ns, g, rot, tot;
+  explicit Outputs(size_t n) : ns(n), g(n), rot(n), tot(n) {}
+  DilationBatchOut view() { return DilationBatchOut{ ns.data(), g.data(), rot.data(), tot.data() }; }
+};
+
+int main(int argc, char **argv) {
+  const size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 4000000;
+  Track trk(n);
+  const DilationBatchIn in = { trk.lat.data(), trk.alt.data(), trk.vel.data(), trk.az.data() };
+
+  printf("fixes: %zu, best ISA: %s\n\n", n, simdIsaName(simdBestIsa()));
+  bool ok = true;
+
+  const SimdIsa isas[] = { SimdIsa::Scalar, SimdIsa::Avx2, SimdIsa::Avx512 };
+
+  for (int grMode = 0; grMode <= 2; ++grMode) {
+    Outputs ref(n);
+    printf("calcTimeDilation, GR mode %d\n", grMode);
+    printf("  %-8s %12s %10s %8s %8s %12s %12s\n", "ISA", "Mfixes/s", "speedup", "ulp g", "ulp rot", "|d| m/s tot", "|d| ns/h");
+    double t_scalar = 0.0;
+    for (SimdIsa isa : isas) {
+      if (!simdIsaSupported(isa)) {
+        printf("  %-8s %12s\n", simdIsaName(isa), "unsupported");
+        continue;
+      }
+      Outputs out(n);
+      const auto t0 = std::chrono::steady_clock::now();
+      calcTimeDilationBatchSimd(in, out.view(), n, grMode, isa);
+      const double t = secondsSince(t0);
+      if (isa == SimdIsa::Scalar) {
+        t_scalar = t;
+        ref = out;
+      }
+      const int64_t ulpG = maxUlp(out.g, ref.g), ulpRot = maxUlp(out.rot, ref.rot);
+      const double dTot = maxAbs(out.tot, ref.tot), dNs = maxAbs(out.ns, ref.ns, 3600.0);
+      const bool pass = ulpG <= SIMD_MAX_ULP_GRAVITY && ulpRot <= SIMD_MAX_ULP_RADIUS_ROT && dTot <= SIMD_MAX_TOT &&
+                        dNs <= SIMD_MAX_NS_H;
+      printf("  %-8s %12.1f %9.2fx %8lld %8lld %12.1e %12.1e  %s\n",
+             simdIsaName(isa), n / t / 1e6, t_scalar / t, (long long)ulpG, (long long)ulpRot, dTot, dNs,
+             pass ? "PASS" : "FAIL");
+      ok &= pass;
+    }
+    printf("\n");
+  }
+
+  // Individual geodesy kernels
+  typedef void (*GeoBatchFn)(const double *, const double *, double *, size_t, SimdIsa);
+  const struct {
+    const char *name;
+    GeoBatchFn fn;
+    int64_t max_ulp;
+  } geo[] = {
+    { "geocentric_radius_m", geocentric_radius_m_batch, SIMD_MAX_ULP_RADIUS_ROT },
+    { "calcEarthRotationSpeed", calcEarthRotationSpeedBatch, SIMD_MAX_ULP_RADIUS_ROT },
+    { "calcLocalGravity", calcLocalGravityBatch, SIMD_MAX_ULP_GRAVITY },
+  };
+  for (const auto &k : geo) {
+    std::vector<double> ref(n);
+    printf("%s\n", k.name);
+    double t_scalar = 0.0;
+    for (SimdIsa isa : isas) {
+      if (!simdIsaSupported(isa)) continue;
+      std::vector<double> out(n);
+      const auto t0 = std::chrono::steady_clock::now();
+      k.fn(trk.lat.data(), trk.alt.data(), out.data(), n, isa);
+      const double t = secondsSince(t0);
+      if (isa == SimdIsa::Scalar) {
+        t_scalar = t;
+        ref = out;
+      }
+      const int64_t ulp = maxUlp(out, ref);
+      printf("  %-8s %12.1f Mfixes/s %7.2fx  max %lld ulp  %s\n",
+             simdIsaName(isa), n / t / 1e6, t_scalar / t, (long long)ulp, ulp <= k.max_ulp ? "PASS" : "FAIL");
+      ok &= ulp <= k.max_ulp;
+    }
+    printf("\n");
+  }
+
+  // DoubleFloat path over the envelope grid
+  printf("calcTimeDilationDF vs calcTimeDilation (grid: lat 1°, alt 250 m, speed 100 km/h, az 15°)\n");
+  printf("  %-6s %12s %12s %12s %12s\n", "GR", "|d| ns/h", "|d| g", "|d| vRot", "|d| vTot");
+  for (int grMode = 0; grMode <= 2; ++grMode) {
+    double e_ns = 0.0, e_g = 0.0, e_rot = 0.0, e_tot = 0.0;
+    for (double lat = -90.0; lat <= 90.0; lat += 1.0) {
+      for (double alt = -500.0; alt <= 20000.0; alt += 250.0) {
+        for (double vel = 0.0; vel <= 3000.0; vel += 100.0) {
+          for (double az = 0.0; az < 360.0; az += 15.0) {
+            double g0, r0, t0, g1, r1, t1;
+            const double a = calcTimeDilation(vel, az, lat + 0.123456789, alt, g0, r0, t0, grMode);
+            const double b = calcTimeDilationDF(vel, az, lat + 0.123456789, alt, g1, r1, t1, grMode);
+            e_ns = fmax(e_ns, fabs(a - b) * 3600.0);
+            e_g = fmax(e_g, fabs(g0 - g1));
+            e_rot = fmax(e_rot, fabs(r0 - r1));
+            e_tot = fmax(e_tot, fabs(t0 - t1));
+          }
+        }
+      }
+    }
+    const bool pass = e_ns <= DF_MAX_NS_H && e_g <= DF_MAX_GRAVITY && e_rot <= DF_MAX_SPEED && e_tot <= DF_MAX_SPEED;
+    printf("  %-6d %12.1e %12.1e %12.1e %12.1e  %s\n", grMode, e_ns, e_g, e_rot, e_tot, pass ? "PASS" : "FAIL");
+    ok &= pass;
+  }
+
+  const size_t m = n < 1000000 ? n : 1000000;
+  volatile double sink = 0.0;
+  double g, rot, tot;
+  auto t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < m; ++i) sink = sink + calcTimeDilation(trk.vel[i], trk.az[i], trk.lat[i], trk.alt[i], g, rot, tot, 1);
+  const double t_double = secondsSince(t0);
+  t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < m; ++i) sink = sink + calcTimeDilationDF(trk.vel[i], trk.az[i], trk.lat[i], trk.alt[i], g, rot, tot, 1);
+  const double t_df = secondsSince(t0);
+  printf("  host time/call: double %.1f ns, DoubleFloat %.1f ns\n", t_double / m * 1e9, t_df / m * 1e9);
+
+  printf("\n%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,783 @@
+/*
+  replay.cpp  —  GNSS + barometer log replay through the sketch's loop() path
+  -------------------------------------------------------------------------
+  - Reads a captured raw GNSS byte stream (UBX or NMEA, as the receiver
+    sent it on UART1) and optionally a barometer trace, and runs them
+    through the same code as loop(): FrameIngest (what the ingest task
+    does), ClockCore (parser, freshness, TinyGPSHaeHelper, lpf /
+    smooth_heading_deg, physics pipeline, clock offset)
+  - Timeline: the loop runs every <frame> ms of virtual time (millis() of
+    tools/host/Arduino.h); each epoch's bytes become available at its GNSS
+    time (NAV-PVT iTOW, or the GGA/RMC time), relative to the first one
+  - As fast as possible (default) or in real time (--realtime)
+  - Reports sentences/s, fixes/s, replay speed and per-stage host time
+    (one steady_clock read per stage: stages near ~40 ns are mostly the
+    timer); used as the throughput regression benchmark
+  - --synth writes a synthetic drive (capture + barometer trace) so the
+    benchmark runs without a recorded log; the "trip" shape (1200 s at
+    full length) is a desk, a walk, a drive with a red light, a taxi, a
+    flight, the landing and the desk again, for the rate governor;
+    "outage" adds 30 s of NAV-PVT (or GGA / RMC) without a fix from the
+    middle of the run (time valid, no position: the receiver lost lock)
+  - --expect-gap <s>: fails (exit code 1) unless a fix outage of about s
+    seconds is handled: the raw position / speed / heading go NaN once
+    the last fix is 3 s old, and the clock offset does not integrate the
+    outage (integrated time <= first to last fix minus the outage)
+  - --governor: runs nav_rate_governor.h on the replayed fixes (no IMU;
+    battery from --battery, default 100 %) and reports its switches and
+    the time spent at each rate (the capture keeps its own rate: this
+    checks the decisions). --expect 10,2,10,25,10,2 fails (exit code 1)
+    unless the rates it picks, from the boot level on, are exactly these.
+    Without a fix it gets no speed and holds its level: the trip with an
+    outage (30 s in the cruise) must pick the same rates
+  - --split: the sketch's dual-core layout with std::threads, paced at
+    --speed x real time (default 1): an ingest thread (bytes at their
+    epoch times), the physics thread (ClockProducer, as the core 0 task)
+    and a HUD thread (the sketch's HudScheduler policies drawing into a
+    stub display) reading ClockState snapshots (relativistic_clock_state.h);
+    task notifications are condition variables. Every snapshot the HUD
+    reads is checked against the one the physics thread published under
+    that version (exit code 1 on a torn read); reports snapshot reads and
+    retries, fix-to-draw latency and achieved vs. target widget rates.
+    Build with -pthread (add -fsanitize=thread to check the exchange)
+
+  Files:
+    capture:    raw bytes, e.g. a u-center log or `cat /dev/ttyUSB0 > drive.ubx`
+    baro trace: CSV "t_ms,altitude_m" per line (t relative to the first
+                epoch; '#' lines skipped), e.g. readAltitude() logged on Serial
+
+  Build (from the repository root; TinyGPSPlus from the Arduino libraries folder):
+    g++ -O2 -std=c++11 -pthread -DARDUINO=100 -I. -Itools/host -I<TinyGPSPlus>/src \
+        tools/replay/replay.cpp <TinyGPSPlus>/src/TinyGPS++.cpp -o replay
+
+  Run:
+    ./replay <capture> [baro.csv] [--realtime] [--double] [--hae] [--gr 0|1|2] [--frame ms]
+             [--governor [--battery %] [--expect hz,hz,...]] [--expect-gap s]
+    ./replay <capture> [baro.csv] --split [--speed x] [--double] [--hae] [--gr 0|1|2]
+    ./replay --synth <prefix> [seconds] [ubx|nmea] [drive|trip] [outage]   (default 600 s, ubx, drive)
+        → <prefix>.ubx or <prefix>.nmea, and <prefix>.baro.csv
+    e.g. ./replay --synth trip 1200 ubx trip && ./replay trip.ubx --governor --expect 10,2,10,25,10,2
+         ./replay --synth lost 600 ubx drive outage && ./replay lost.ubx --expect-gap 30
+         ./replay --synth lost 1200 ubx trip outage && ./replay lost.ubx --governor --expect 10,2,10,25,10,2 --expect-gap 30
+*/
+
+#include "relativistic_clock_core.h"
+#include "relativistic_clock_state.h"
+#include "hud_scheduler.h"
+#include "nav_rate_governor.h"
+#include "nmea_framer.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static constexpr size_t RING = 8192;  // same as GNSS_INGEST_RING
+
+// ---- Capture: bytes cut into epochs ----
+struct Chunk {
+  uint32_t t_ms;  // virtual time the bytes become available
+  size_t end;     // bytes [previous end, end)
+};
+
+struct Capture {
+  std::vector<uint8_t> bytes;
+  std::vector<Chunk> chunks;
+  bool ubx;
+};
+
+// GNSS time of an epoch-starting frame (ms of week / day), -1 otherwise
+static int64_t epochTime(const UbxDecoder &d) {
+  const UbxNavPvt *pvt = d.navPvt();
+  return pvt ? (int64_t)pvt->iTOW : -1;
+}
+
+static int64_t epochTime(const NmeaFramer &f) {
+  const char *s = f.sentence();
+  if (f.length() < 14 || (strncmp(s + 3, "GGA,", 4) != 0 && strncmp(s + 3, "RMC,", 4) != 0)) return -1;
+  unsigned hh, mm;
+  double ss;
+  if (sscanf(s + 7, "%2u%2u%lf", &hh, &mm, &ss) != 3) return -1;
+  return (int64_t)((hh * 3600 + mm * 60) * 1000.0 + ss * 1000.0 + 0.5);
+}
+
+// A new epoch starts at each frame whose GNSS time differs from the last
+// one; bytes before it (trailing NAV-CLOCK, GSV, ...) stay with the epoch
+// before. Time wraps (week / day) are unwrapped.
+template <class Framer>
+static void cutEpochs(Capture &cap, int64_t period_ms) {
+  Framer f;
+  int64_t last = -1, rel = 0;
+  size_t start = 0;
+  for (size_t i = 0; i < cap.bytes.size(); ++i) {
+    if (f.push(cap.bytes[i]) != FrameStatus::Complete) continue;
+    const int64_t t = epochTime(f);
+    if (t < 0 || t == last) continue;
+    const size_t frameStart = i + 1 - f.length();
+    if (last >= 0) {
+      int64_t d = t - last;
+      if (d < -period_ms / 2) d += period_ms;
+      if (d < 0) d = 0;
+      cap.chunks.push_back({ (uint32_t)rel, frameStart });
+      rel += d;
+    } else if (frameStart > start) {
+      cap.chunks.push_back({ 0, frameStart });  // bytes before the first epoch
+    }
+    start = frameStart;
+    last = t;
+  }
+  cap.chunks.push_back({ (uint32_t)rel, cap.bytes.size() });
+}
+
+static bool loadCapture(const char *path, Capture &cap, int forceUbx) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp) return false;
+  uint8_t buf[65536];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) cap.bytes.insert(cap.bytes.end(), buf, buf + n);
+  fclose(fp);
+
+  // Protocol: whichever frame start appears first
+  cap.ubx = false;
+  for (size_t i = 0; i + 1 < cap.bytes.size(); ++i) {
+    if (cap.bytes[i] == '$') break;
+    if (cap.bytes[i] == UBX_SYNC1 && cap.bytes[i + 1] == UBX_SYNC2) {
+      cap.ubx = true;
+      break;
+    }
+  }
+  if (forceUbx >= 0) cap.ubx = forceUbx != 0;
+
+  if (cap.ubx) {
+    cutEpochs<UbxDecoder>(cap, 604800000LL);
+  } else {
+    cutEpochs<NmeaFramer>(cap, 86400000LL);
+  }
+  return true;
+}
+
+// ---- Barometer trace ----
+struct BaroSample {
+  uint32_t t_ms;
+  double alt_m;
+};
+
+static bool loadBaro(const char *path, std::vector<BaroSample> &out) {
+  FILE *fp = fopen(path, "r");
+  if (!fp) return false;
+  char line[128];
+  while (fgets(line, sizeof(line), fp)) {
+    if (line[0] == '#') continue;
+    unsigned long t;
+    double a;
+    if (sscanf(line, "%lu,%lf", &t, &a) == 2) out.push_back({ (uint32_t)t, a });
+  }
+  fclose(fp);
+  return true;
+}
+
+// ---- Replay ----
+struct Options {
+  bool realtime = false;
+  bool df = true;
+  bool hae = false;
+  int gr = 1;
+  uint32_t frame_ms = 16;  // loop(): delay(16)
+  bool split = false;
+  double speed = 1.0;      // --split: virtual ms per real ms
+  bool governor = false;
+  int battery = 100;       // --governor: %
+  std::vector<int> expect; // --governor: rates (Hz) it must pick, in order
+  double expect_gap_s = 0; // --expect-gap: fix outage (s) that must be handled
+};
+
+static constexpr double OUTAGE_S = 30.0;  // --synth ... outage
+
+// Fix outage handling: stale raw readings and the offset's gaps
+struct GapCheck {
+  uint32_t stale_ms = 0;                       // no raw reading (after the first fix)
+  double first_fix_s = NAN, last_fix_s = NAN;  // GNSS time
+
+  template <class Core>
+  void update(const Core &core, uint32_t frame_ms) {
+    if (core.gpsOK && !isnan(core.fix_time_s)) {
+      if (isnan(first_fix_s)) first_fix_s = core.fix_time_s;
+      last_fix_s = core.fix_time_s;
+    }
+    if (!isnan(first_fix_s) && isnan(core.raw_lat) && isnan(core.raw_lon) && isnan(core.raw_vel_kmh) &&
+        isnan(core.raw_az_deg)) {
+      stale_ms += frame_ms;
+    }
+  }
+
+  // 0, or 1 if an outage of gap_s was not handled
+  int report(const ClockOffsetIntegrator &off, double gap_s) const {
+    const double span = last_fix_s - first_fix_s;
+    printf("fix outage: raw readings NaN %.1f s, offset gaps %u, integrated %.1f of %.1f s between fixes\n",
+           stale_ms * 1e-3, off.gaps, off.elapsed_s(), span);
+    if (!(gap_s > 0.0)) return 0;
+    // Raw readings go NaN 3 s into the outage and return with the next fix
+    const bool ok = stale_ms * 1e-3 >= gap_s - 3.0 - 0.5 && off.gaps >= 1 && off.elapsed_s() <= span - gap_s + 0.5;
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+  }
+};
+
+enum Stage { INGEST, PARSE, GNSS, BARO, SMOOTH, PHYSICS, STAGES };
+static const char *const STAGE_NAMES[STAGES] = {
+  "ingest (framing)", "parse", "gnss (freshness, HAE)", "baro", "smooth (UI)", "physics + offset"
+};
+
+// Rate governor on the replayed fixes
+struct GovernorRun {
+  struct Switch {
+    uint32_t t_ms;
+    NavRateGovernor::Level level;
+    double kmh;
+  };
+  NavRateGovernor governor;
+  std::vector<Switch> switches;
+  uint32_t fix_ms = 0, last_ms = 0;
+  uint32_t nofix_ms = 0;  // no speed (after the first fix): level held
+
+  void update(uint32_t now, bool fix, double kmh, int battery) {
+    if (fix) fix_ms = now;
+    if (fix_ms && isnan(kmh)) nofix_ms += now - last_ms;
+    last_ms = now;
+    if (switches.empty()) switches.push_back({ now, governor.level(), kmh });
+    const NavRateGovernor::Level l = governor.update(now, fix_ms, kmh / 3.6, NAN, battery);
+    if (l != switches.back().level) switches.push_back({ now, l, kmh });
+  }
+
+  // 0, or 1 if the rates differ from expect
+  int report(const std::vector<int> &expect) const {
+    const NavRateGovernor::Stats &st = governor.stats;
+    printf("governor: %u switches, battery cap %.1f s, no fix %.1f s\n", st.switches, st.capped_ms * 1e-3,
+           nofix_ms * 1e-3);
+    printf("%10s %12s %6s %12s\n", "t s", "level", "Hz", "speed km/h");
+    for (const Switch &s : switches) {
+      printf("%10.1f %12s %6u %12.1f\n", s.t_ms * 1e-3, NavRateGovernor::name(s.level), NavRateGovernor::hz(s.level),
+             s.kmh);
+    }
+    uint32_t total = 0;
+    for (int l = 0; l < NavRateGovernor::LEVELS; ++l) total += st.time_ms[l];
+    for (int l = 0; l < NavRateGovernor::LEVELS; ++l) {
+      const NavRateGovernor::Level lv = (NavRateGovernor::Level)l;
+      printf("time at %2u Hz (%s): %.1f s, %.1f %%\n", NavRateGovernor::hz(lv), NavRateGovernor::name(lv),
+             st.time_ms[l] * 1e-3, total ? 100.0 * st.time_ms[l] / total : 0.0);
+    }
+    if (expect.empty()) return 0;
+    bool ok = expect.size() == switches.size();
+    for (size_t i = 0; ok && i < expect.size(); ++i) ok = expect[i] == NavRateGovernor::hz(switches[i].level);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+  }
+};
+
+template <bool Ubx, bool DF>
+static int replay(const Capture &cap, const std::vector<BaroSample> &baro, const Options &o) {
+  typedef typename std::conditional<Ubx, UbxIngest<RING>, NmeaIngest<RING>>::type Ingest;
+  std::unique_ptr<Ingest> ingest(new Ingest);
+  std::unique_ptr<ClockCore<Ubx, DF>> core(new ClockCore<Ubx, DF>);
+  core->setSimLocation(0.0, 0.0);
+  core->setMode({ (GrMode)o.gr, o.hae ? AltSource::Hae : AltSource::Baro, false });
+
+  GovernorRun gov;
+  GapCheck gap;
+  double stage_ns[STAGES] = {};
+  size_t pos = 0, ci = 0, bi = 0;
+  uint32_t frames = 0;
+  uint8_t buf[256];
+  const Clock::time_point start = Clock::now();
+
+  for (uint32_t now = 0; ci < cap.chunks.size() || ingest->pending(); now += o.frame_ms, ++frames) {
+    hostSetMillis(now);
+    if (o.realtime) std::this_thread::sleep_until(start + std::chrono::milliseconds(now));
+
+    // UART + ingest task: every epoch that has arrived by now
+    Clock::time_point t0 = Clock::now();
+    while (ci < cap.chunks.size() && cap.chunks[ci].t_ms <= now) {
+      ingest->produce(cap.bytes.data() + pos, cap.chunks[ci].end - pos);
+      pos = cap.chunks[ci++].end;
+    }
+    Clock::time_point t1 = Clock::now();
+    stage_ns[INGEST] += std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+    // loop()
+    t0 = t1;
+    core->beginFrame();
+    size_t n;
+    while ((n = ingest->consume(buf, sizeof(buf))) > 0) core->feedGnss(buf, n);
+    t1 = Clock::now();
+    stage_ns[PARSE] += std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+    t0 = t1;
+    core->endGnss();
+    t1 = Clock::now();
+    stage_ns[GNSS] += std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+    t0 = t1;
+    if (core->wantsBaro() && !baro.empty()) {
+      while (bi + 1 < baro.size() && baro[bi + 1].t_ms <= now) ++bi;
+      if (baro[bi].t_ms <= now) core->setBaroAltitude(baro[bi].alt_m);
+    }
+    t1 = Clock::now();
+    stage_ns[BARO] += std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+    t0 = t1;
+    core->smooth();
+    t1 = Clock::now();
+    stage_ns[SMOOTH] += std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+    t0 = t1;
+    core->evaluate();
+    t1 = Clock::now();
+    stage_ns[PHYSICS] += std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+    if (o.governor) gov.update(now, core->gpsOK, core->raw_vel_kmh, o.battery);
+    gap.update(*core, o.frame_ms);
+  }
+
+  const double wall_s = std::chrono::duration<double>(Clock::now() - start).count();
+  const double virt_s = frames * o.frame_ms * 1e-3;
+  const uint32_t sentences = ingest->stats.frames.load();
+
+  printf("capture: %zu bytes, %s, %zu epochs, %.1f s (%u loop frames of %u ms), %s physics\n",
+         cap.bytes.size(), Ubx ? "UBX" : "NMEA", cap.chunks.size(), virt_s, frames, o.frame_ms,
+         DF ? "DoubleFloat" : "double");
+  printf("wall %.3f s, %.1fx real time%s\n", wall_s, virt_s / wall_s, o.realtime ? " (paced)" : "");
+  printf("%s/s %.0f, fixes/s %.0f, loop frames/s %.0f\n",
+         Ubx ? "frames" : "sentences", sentences / wall_s, core->fixes / wall_s, frames / wall_s);
+
+  double total = 0.0;
+  for (int s = 0; s < STAGES; ++s) total += stage_ns[s];
+  printf("%-24s %10s %10s %6s\n", "stage", "total ms", "ns/frame", "%");
+  for (int s = 0; s < STAGES; ++s) {
+    printf("%-24s %10.2f %10.1f %6.1f\n", STAGE_NAMES[s], stage_ns[s] * 1e-6, stage_ns[s] / frames,
+           100.0 * stage_ns[s] / total);
+  }
+  printf("%-24s %10.2f %10.1f\n", "loop total", total * 1e-6, total / frames);
+
+  const IngestStats &is = ingest->stats;
+  printf("ingest: frames %u dropped %u bad %u overlong %u\n", is.frames.load(), is.dropped.load(),
+         is.bad_sum.load(), is.overlong.load());
+  const PipelineStats &st = core->physics.stats;
+  printf("pipeline: position eval %u skip %u | motion eval %u skip %u\n",
+         st.position_evals, st.position_skips, st.motion_evals, st.motion_skips);
+  const ClockOffsetIntegrator &off = core->offset;
+  printf("result: fixes %u, offset %.6f ns over %.1f s, ns/h min %.6f max %.6f mean %.6f\n",
+         core->fixes, off.offset_ns(), off.elapsed_s(), off.min_ns_per_s() * 3600.0,
+         off.max_ns_per_s() * 3600.0, off.mean_ns_per_s() * 3600.0);
+  int rc = gap.report(off, o.expect_gap_s);
+  if (o.governor) rc |= gov.report(o.expect);
+  return rc;
+}
+
+// ---- Split replay: ingest, physics and HUD threads ----
+// xTaskNotifyGive / ulTaskNotifyTake(pdTRUE, timeout)
+class HostNotify {
+public:
+  void give() {
+    {
+      std::lock_guard<std::mutex> l(m_);
+      given_ = true;
+    }
+    cv_.notify_one();
+  }
+
+  // True if given before the timeout
+  bool take(std::chrono::microseconds timeout) {
+    std::unique_lock<std::mutex> l(m_);
+    const bool r = cv_.wait_for(l, timeout, [this] { return given_; });
+    given_ = false;
+    return r;
+  }
+
+private:
+  std::mutex m_;
+  std::condition_variable cv_;
+  bool given_ = false;
+};
+
+static uint64_t stateHash(const ClockState &s) {
+  uint64_t h = 1469598103934665603ull;  // FNV-1a
+  const uint8_t *p = (const uint8_t *)&s;
+  for (size_t i = 0; i < sizeof(s); ++i) h = (h ^ p[i]) * 1099511628211ull;
+  return h | 1;  // 0: not published yet
+}
+
+// What the HUD's draws received (stands in for the display)
+struct StubHud {
+  uint64_t draws[16];
+  double last[16];
+};
+
+template <bool Ubx, bool DF>
+static int splitReplay(const Capture &cap, const std::vector<BaroSample> &baro, const Options &o) {
+  typedef typename std::conditional<Ubx, UbxIngest<RING>, NmeaIngest<RING>>::type Ingest;
+  typedef ClockCore<Ubx, DF> Core;
+  std::unique_ptr<Ingest> ingest(new Ingest);
+  std::unique_ptr<Core> core(new Core);
+  SeqlockSnapshot<ClockState> state;
+  SeqlockSnapshot<ClockMode> modeRequest;
+  ClockProducer<Core, Ingest> producer(*core, *ingest, state, modeRequest);
+  core->setSimLocation(0.0, 0.0);
+  core->setMode({ (GrMode)o.gr, o.hae ? AltSource::Hae : AltSource::Baro, false });
+
+  const uint32_t end_ms = cap.chunks.empty() ? 0 : cap.chunks.back().t_ms + 1000;
+  // Hash of every published state by version (the physics thread's passes
+  // are bounded by one per virtual ms plus one per epoch)
+  std::vector<std::atomic<uint64_t>> published(2 * (size_t)end_ms + 2 * cap.chunks.size() + 16);
+  for (std::atomic<uint64_t> &h : published) h.store(0, std::memory_order_relaxed);
+
+  HostNotify physicsWake, hudWake;
+  std::atomic<bool> done(false);
+  const Clock::time_point start = Clock::now();
+  auto virtualNow = [&]() {
+    return (uint32_t)(std::chrono::duration<double, std::milli>(Clock::now() - start).count() * o.speed);
+  };
+  auto realDelay = [&](uint32_t virtual_ms) {
+    return std::chrono::microseconds((int64_t)(virtual_ms * 1000.0 / o.speed));
+  };
+
+  // UART + ingest task
+  std::thread ingestThread([&]() {
+    size_t pos = 0;
+    for (const Chunk &c : cap.chunks) {
+      std::this_thread::sleep_until(start + realDelay(c.t_ms));
+      ingest->produce(cap.bytes.data() + pos, c.end - pos);
+      pos = c.end;
+      physicsWake.give();
+    }
+  });
+
+  // Physics task (core 0); the only thread using millis()
+  uint32_t passes = 0, unchecked = 0;
+  std::thread physicsThread([&]() {
+    size_t bi = 0;
+    while (!done.load(std::memory_order_relaxed)) {
+      const uint32_t now = virtualNow();
+      hostSetMillis(now);
+      const bool fix = producer.pass(now, [&]() {
+        if (baro.empty()) return (double)NAN;
+        while (bi + 1 < baro.size() && baro[bi + 1].t_ms <= now) ++bi;
+        return baro[bi].t_ms <= now ? baro[bi].alt_m : (double)NAN;
+      });
+      ClockState own;
+      const uint32_t v = state.read(own);
+      if (v < published.size()) published[v].store(stateHash(own), std::memory_order_release);
+      else ++unchecked;
+      ++passes;
+      if (fix) hudWake.give();
+      const uint32_t wait = producer.sleepMs(virtualNow());
+      if (wait) physicsWake.take(realDelay(wait));
+    }
+  });
+
+  // HUD (core 1): the sketch's refresh policies, stub draws
+  enum : uint32_t { EV_FIX = 1, EV_BARO = 2 };
+  HudScheduler sched(16);
+  static const char *const NAMES[] = { "altitude", "latitude", "velocity", "total velocity",
+                                       "local gravity", "time dilation", "line chart", "header" };
+  const int tasks[8] = {
+    sched.add(NAMES[0], 33), sched.add(NAMES[1], 0, EV_FIX), sched.add(NAMES[2], 0, EV_FIX),
+    sched.add(NAMES[3], 0, EV_FIX), sched.add(NAMES[4], 0, EV_FIX | EV_BARO), sched.add(NAMES[5], 100),
+    sched.add(NAMES[6], 1000, EV_FIX), sched.add(NAMES[7], 200)
+  };
+  StubHud hud;
+  memset(&hud, 0, sizeof(hud));
+  uint64_t reads = 0, torn = 0, latency_sum = 0;
+  uint32_t retries = 0, latency_max = 0, latency_n = 0, seenFixes = 0, seenBaro = 0;
+  uint32_t hudNow = 0;
+  while ((hudNow = virtualNow()) < end_ms) {
+    sched.beginPass(0);
+    ClockState st;
+    const uint32_t v = state.read(st, &retries);
+    ++reads;
+    if (v) {
+      // The physics thread stores each version's hash right after publishing it
+      uint64_t h;
+      while ((h = published[v].load(std::memory_order_acquire)) == 0) std::this_thread::yield();
+      if (h != stateHash(st) || st.seq != v) ++torn;
+    }
+    if (st.fixes != seenFixes) {
+      sched.signal(EV_FIX);
+      const uint32_t lat = hudNow - st.fix_ms;
+      latency_sum += lat;
+      if (lat > latency_max) latency_max = lat;
+      ++latency_n;
+    }
+    if (st.baro_reads != seenBaro) sched.signal(EV_BARO);
+    seenFixes = st.fixes;
+    seenBaro = st.baro_reads;
+
+    const double values[8] = { st.alt_m, st.lat_deg, st.vRot * 3.6, st.vTot * 3.6,
+                               st.gravity, st.ns_per_h, st.ns_per_h, st.hdop };
+    for (int w = 0; w < 8; ++w) {
+      if (!sched.due(tasks[w], hudNow)) continue;
+      ++hud.draws[w];
+      hud.last[w] = values[w];
+    }
+    sched.endPass(0);
+    const uint32_t wait = sched.sleepMs(virtualNow());
+    if (wait) sched.slept(hudWake.take(realDelay(wait)));
+  }
+  done.store(true);
+  physicsWake.give();
+  ingestThread.join();
+  physicsThread.join();
+
+  const double wall_s = std::chrono::duration<double>(Clock::now() - start).count();
+  printf("capture: %zu bytes, %s, %zu epochs, %.1f s at %.1fx (%.1f s wall), %s physics, split threads\n",
+         cap.bytes.size(), Ubx ? "UBX" : "NMEA", cap.chunks.size(), end_ms * 1e-3, o.speed, wall_s,
+         DF ? "DoubleFloat" : "double");
+  printf("physics: %u passes (%.0f per virtual s), fixes %u, offset %.6f ns\n", passes, passes * 1000.0 / end_ms,
+         core->fixes, core->offset.offset_ns());
+  printf("snapshots: %llu HUD reads, %u retries, %llu torn, %u unchecked\n", (unsigned long long)reads, retries,
+         (unsigned long long)torn, unchecked);
+  printf("fix to HUD: %.1f ms mean, %u ms max (virtual)\n", latency_n ? (double)latency_sum / latency_n : 0.0,
+         latency_max);
+  printf("HUD: %u passes, %u sleeps, %u woken by a fix\n", sched.stats.passes, sched.stats.sleeps, sched.stats.woken);
+  printf("%-16s %10s %10s %8s %14s\n", "widget", "achieved", "target", "late", "last value");
+  for (int w = 0; w < 8; ++w) {
+    printf("%-16s %7.1f Hz %7.1f Hz %8u %14.6f\n", NAMES[w], sched.achievedHz(tasks[w], hudNow),
+           sched.targetHz(tasks[w], hudNow), sched.task(tasks[w]).late, hud.last[w]);
+  }
+  printf("%s\n", torn ? "FAIL" : "PASS");
+  return torn ? 1 : 0;
+}
+
+// ---- Synthetic drive ----
+// 25 Hz: speed ramps 0 → 120 km/h, slow turns, 0 → 800 m climb and back
+struct DriveState {
+  double lat, lon, hae, hmsl, kmh, heading;
+};
+
+static DriveState driveAt(double t, double seconds) {
+  DriveState d;
+  d.kmh = 120.0 * (t < 60.0 ? t / 60.0 : 1.0);
+  d.heading = fmod(360.0 + 45.0 * sin(t / 90.0) + 10.0, 360.0);
+  d.hmsl = 400.0 * (1.0 - cos(2.0 * M_PI * t / seconds));
+  d.hae = d.hmsl - 5.6;  // geoid separation N = -5.6 m
+  const double dist_m = d.kmh / 3.6 * t * 0.5;
+  d.lat = -23.55 + dist_m * cos(d.heading * M_PI / 180.0) / 111320.0;
+  d.lon = -46.63 + dist_m * sin(d.heading * M_PI / 180.0) / 102000.0;
+  return d;
+}
+
+// Trip at full length (1200 s; shorter runs are scaled down): desk, walk,
+// drive with a 30 s red light, taxi, take-off, cruise, landing, taxi, desk.
+// Position is integrated by the caller.
+static DriveState tripAt(double t, double seconds) {
+  const double s = t * 1200.0 / seconds;
+  const double noise = 0.05 * (1.0 + sin(t * 7.3));  // GNSS speed noise while still, km/h
+  DriveState d;
+  d.hmsl = 760.0;
+  if (s < 120.0 || s >= 1080.0) {
+    d.kmh = noise;                                        // desk
+  } else if (s < 240.0) {
+    d.kmh = 5.0 + 1.0 * sin(t * 2.0);                     // walk
+  } else if (s < 420.0) {
+    if (s < 250.0) d.kmh = 6.0 * (s - 240.0);             // drive at 60 km/h
+    else if (s < 320.0) d.kmh = 60.0;
+    else if (s < 330.0) d.kmh = 6.0 * (330.0 - s);
+    else if (s < 360.0) d.kmh = noise;                    // red light
+    else if (s < 370.0) d.kmh = 6.0 * (s - 360.0);
+    else d.kmh = 60.0;
+  } else if (s < 480.0 || s >= 990.0) {
+    d.kmh = (s < 480.0) ? 30.0 : 20.0;                    // taxi
+  } else {
+    if (s < 510.0) d.kmh = 30.0 + 250.0 * (s - 480.0) / 30.0;  // take-off roll
+    else if (s < 570.0) d.kmh = 280.0 + 520.0 * (s - 510.0) / 60.0;
+    else if (s < 900.0) d.kmh = 800.0;                         // cruise
+    else if (s < 960.0) d.kmh = 800.0 - 550.0 * (s - 900.0) / 60.0;
+    else d.kmh = 250.0 - 230.0 * (s - 960.0) / 30.0;           // landing roll
+    const double up = (s - 510.0) / 120.0, down = (960.0 - s) / 120.0;
+    d.hmsl += 10000.0 * fmax(0.0, fmin(1.0, fmin(up, down)));
+  }
+  d.heading = fmod(360.0 + 30.0 * sin(t / 120.0) + 90.0, 360.0);
+  d.hae = d.hmsl - 5.6;
+  d.lat = d.lon = 0.0;
+  return d;
+}
+
+static void appendUbx(std::vector<uint8_t> &out, uint8_t cls, uint8_t id, const void *payload, uint16_t len) {
+  const size_t at = out.size();
+  const uint8_t hdr[6] = { UBX_SYNC1, UBX_SYNC2, cls, id, (uint8_t)(len & 0xFF), (uint8_t)(len >> 8) };
+  out.insert(out.end(), hdr, hdr + 6);
+  out.insert(out.end(), (const uint8_t *)payload, (const uint8_t *)payload + len);
+  uint8_t a = 0, b = 0;
+  for (size_t i = at + 2; i < out.size(); ++i) ubxFletcher(a, b, out[i]);
+  out.push_back(a);
+  out.push_back(b);
+}
+
+static void appendNmea(std::vector<uint8_t> &out, const char *body) {
+  uint8_t x = 0;
+  for (const char *p = body; *p; ++p) x ^= (uint8_t)*p;
+  char line[160];
+  const int n = snprintf(line, sizeof(line), "$%s*%02X\r\n", body, x);
+  out.insert(out.end(), line, line + n);
+}
+
+static void nmeaCoord(char *out, size_t len, double deg, bool lat) {
+  const double a = fabs(deg);
+  const int d = (int)a;
+  snprintf(out, len, lat ? "%02d%08.5f,%c" : "%03d%08.5f,%c", d, (a - d) * 60.0,
+           lat ? (deg < 0 ? 'S' : 'N') : (deg < 0 ? 'W' : 'E'));
+}
+
+static int synth(const std::string &prefix, double seconds, bool ubx, bool trip, bool outage) {
+  std::vector<uint8_t> bytes;
+  const std::string capPath = prefix + (ubx ? ".ubx" : ".nmea");
+  const std::string baroPath = prefix + ".baro.csv";
+  FILE *fb = fopen(baroPath.c_str(), "w");
+  if (!fb) return 1;
+  fprintf(fb, "# t_ms,altitude_m\n");
+
+  const uint32_t epochs = (uint32_t)(seconds * 25.0);
+  const uint32_t tod0_ms = 12 * 3600000;  // 2025-06-01 12:00:00 UTC
+  double north_m = 0.0, east_m = 0.0;
+  for (uint32_t e = 0; e < epochs; ++e) {
+    const uint32_t t_ms = e * 40;
+    const bool lost = outage && t_ms * 1e-3 >= seconds * 0.5 && t_ms * 1e-3 < seconds * 0.5 + OUTAGE_S;
+    DriveState d = trip ? tripAt(t_ms * 1e-3, seconds) : driveAt(t_ms * 1e-3, seconds);
+    if (trip) {
+      north_m += d.kmh / 3.6 * 0.04 * cos(d.heading * M_PI / 180.0);
+      east_m += d.kmh / 3.6 * 0.04 * sin(d.heading * M_PI / 180.0);
+      d.lat = -23.55 + north_m / 111320.0;
+      d.lon = -46.63 + east_m / 102000.0;
+    }
+    const uint32_t tod = tod0_ms + t_ms;
+    const unsigned hh = tod / 3600000, mm = tod / 60000 % 60, ss = tod / 1000 % 60, cs = tod / 10 % 100;
+
+    if (ubx) {
+      UbxNavPvt p;
+      memset(&p, 0, sizeof(p));
+      p.iTOW = tod;  // Sunday of the GPS week
+      p.year = 2025;
+      p.month = 6;
+      p.day = 1;
+      p.hour = hh;
+      p.min = mm;
+      p.sec = ss;
+      p.nano = (int32_t)(tod % 1000) * 1000000;
+      p.valid = UBX_PVT_VALID_DATE | UBX_PVT_VALID_TIME;
+      p.fixType = lost ? 0 : 3;
+      p.flags = lost ? 0 : UBX_PVT_GNSS_FIX_OK;
+      p.numSV = lost ? 2 : 14;
+      if (!lost) {  // without a fix the receiver reports zeros
+        p.lat = (int32_t)lround(d.lat * 1e7);
+        p.lon = (int32_t)lround(d.lon * 1e7);
+        p.height = (int32_t)lround(d.hae * 1e3);
+        p.hMSL = (int32_t)lround(d.hmsl * 1e3);
+        p.gSpeed = (int32_t)lround(d.kmh / 3.6 * 1e3);
+        p.headMot = (int32_t)lround(d.heading * 1e5);
+      }
+      p.pDOP = lost ? 9999 : 110;
+      appendUbx(bytes, UBX_CLASS_NAV, UBX_NAV_PVT, &p, sizeof(p));
+      const UbxNavClock clk = { p.iTOW, 1000, 5, 20, 300 };
+      appendUbx(bytes, UBX_CLASS_NAV, UBX_NAV_CLOCK, &clk, sizeof(clk));
+    } else if (lost) {
+      char body[160];
+      snprintf(body, sizeof(body), "GNGGA,%02u%02u%02u.%02u,,,,,0,02,99.9,,,,,,", hh, mm, ss, cs);
+      appendNmea(bytes, body);
+      snprintf(body, sizeof(body), "GNRMC,%02u%02u%02u.%02u,V,,,,,,,010625,,,N", hh, mm, ss, cs);
+      appendNmea(bytes, body);
+    } else {
+      char lat[24], lon[24], body[160];
+      nmeaCoord(lat, sizeof(lat), d.lat, true);
+      nmeaCoord(lon, sizeof(lon), d.lon, false);
+      snprintf(body, sizeof(body), "GNGGA,%02u%02u%02u.%02u,%s,%s,1,14,0.8,%.1f,M,-5.6,M,,",
+               hh, mm, ss, cs, lat, lon, d.hmsl);
+      appendNmea(bytes, body);
+      snprintf(body, sizeof(body), "GNRMC,%02u%02u%02u.%02u,A,%s,%s,%.3f,%.2f,010625,,,A",
+               hh, mm, ss, cs, lat, lon, d.kmh / 1.852, d.heading);
+      appendNmea(bytes, body);
+      snprintf(body, sizeof(body), "GNVTG,%.2f,T,,M,%.3f,N,%.3f,K,A", d.heading, d.kmh / 1.852, d.kmh);
+      appendNmea(bytes, body);
+      if (e % 25 == 0) appendNmea(bytes, "GNGSA,A,3,01,02,03,04,05,06,07,08,09,10,11,12,1.4,0.8,1.1,1");
+    }
+    fprintf(fb, "%u,%.2f\n", t_ms, d.hmsl + 0.3 * sin(t_ms * 0.01));  // baro ~ MSL + noise
+  }
+  fclose(fb);
+
+  FILE *fc = fopen(capPath.c_str(), "wb");
+  if (!fc) return 1;
+  fwrite(bytes.data(), 1, bytes.size(), fc);
+  fclose(fc);
+  printf("wrote %s (%zu bytes, %u epochs) and %s\n", capPath.c_str(), bytes.size(), epochs, baroPath.c_str());
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc >= 3 && strcmp(argv[1], "--synth") == 0) {
+    const double seconds = (argc > 3) ? atof(argv[3]) : 600.0;
+    const bool ubx = !(argc > 4 && strcmp(argv[4], "nmea") == 0);
+    const bool trip = argc > 5 && strcmp(argv[5], "trip") == 0;
+    const bool outage = argc > 6 && strcmp(argv[6], "outage") == 0;
+    return synth(argv[2], seconds, ubx, trip, outage);
+  }
+
+  const char *capPath = nullptr, *baroPath = nullptr;
+  Options o;
+  int forceUbx = -1;
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    if (a == "--realtime") o.realtime = true;
+    else if (a == "--double") o.df = false;
+    else if (a == "--hae") o.hae = true;
+    else if (a == "--ubx") forceUbx = 1;
+    else if (a == "--nmea") forceUbx = 0;
+    else if (a == "--gr" && i + 1 < argc) o.gr = atoi(argv[++i]) % 3;
+    else if (a == "--frame" && i + 1 < argc) o.frame_ms = (uint32_t)atoi(argv[++i]);
+    else if (a == "--split") o.split = true;
+    else if (a == "--speed" && i + 1 < argc) o.speed = atof(argv[++i]);
+    else if (a == "--governor") o.governor = true;
+    else if (a == "--battery" && i + 1 < argc) o.battery = atoi(argv[++i]);
+    else if (a == "--expect-gap" && i + 1 < argc) o.expect_gap_s = atof(argv[++i]);
+    else if (a == "--expect" && i + 1 < argc) {
+      for (const char *p = argv[++i]; *p;) {
+        o.expect.push_back((int)strtol(p, const_cast<char **>(&p), 10));
+        if (*p == ',') ++p;
+        else break;
+      }
+    }
+    else if (!capPath) capPath = argv[i];
+    else if (!baroPath) baroPath = argv[i];
+  }
+  if (!capPath || o.frame_ms == 0 || !(o.speed > 0.0)) {
+    fprintf(stderr, "usage: %s <capture> [baro.csv] [--realtime] [--double] [--hae] [--gr 0|1|2] [--frame ms]\n"
+                    "                [--governor [--battery %%] [--expect hz,hz,...]] [--expect-gap s]\n"
+                    "       %s <capture> [baro.csv] --split [--speed x] [--double] [--hae] [--gr 0|1|2]\n"
+                    "       %s --synth <prefix> [seconds] [ubx|nmea] [drive|trip] [outage]\n", argv[0], argv[0], argv[0]);
+    return 2;
+  }
+
+  Capture cap;
+  if (!loadCapture(capPath, cap, forceUbx)) {
+    fprintf(stderr, "cannot read %s\n", capPath);
+    return 1;
+  }
+  std::vector<BaroSample> baro;
+  if (baroPath && !loadBaro(baroPath, baro)) {
+    fprintf(stderr, "cannot read %s\n", baroPath);
+    return 1;
+  }
+
+  if (o.split) {
+    if (cap.ubx) return o.df ? splitReplay<true, true>(cap, baro, o) : splitReplay<true, false>(cap, baro, o);
+    return o.df ? splitReplay<false, true>(cap, baro, o) : splitReplay<false, false>(cap, baro, o);
+  }
+  if (cap.ubx) return o.df ? replay<true, true>(cap, baro, o) : replay<true, false>(cap, baro, o);
+  return o.df ? replay<false, true>(cap, baro, o) : replay<false, false>(cap, baro, o);
+}
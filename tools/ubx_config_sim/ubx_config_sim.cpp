@@ -0,0 +1,370 @@
+/*
+  ubx_config_sim.cpp  —  ubx_config.h against a simulated u-blox receiver
+  ----------------------------------------------------------------------
+  - SimReceiver plays the UART and an M9 receiver in virtual time: it
+    parses the UBX frames the configurator writes, keeps the items of
+    CFG-VALSET per layer (RAM, BBR, Flash), answers CFG-VALGET with them,
+    ACK-ACKs / ACK-NAKs after a few ms (NAK for unknown keys, as the
+    receiver does), changes its baud when the RAM baud item changes (ACK
+    still at the old rate), and streams NMEA at 25 Hz in between. Bytes
+    sent at a rate the other side is not using are lost (garbled)
+  - Scenarios: receiver already at the target baud, at the factory
+    38400 baud or at 9600 (baud hunt), a lost ACK, a NAKed command, a
+    read-back that differs (an item the receiver ignores), no receiver,
+    saving to BBR + Flash, and a profile switch at runtime (its output
+    in between must still reach the sink); each checks the final state,
+    the per-command results and the receiver's RAM items
+  - Prints per scenario the time to Done / Failed against the fixed
+    delay()s of the blocking setup it replaces
+  - Exit code 0 if every scenario ended as expected
+
+  Build (from the repository root):
+    g++ -O2 -std=c++11 -I. tools/ubx_config_sim/ubx_config_sim.cpp -o ubx_config_sim
+
+  Run:
+    ./ubx_config_sim [-v]   (-v: per-command results)
+*/
+
+#include "ubx_config.h"
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <vector>
+
+// delay()s of the blocking setup: GNSSSerial.begin() settle, CFG-PRT,
+// host baud, CFG-RATE, 2 x CFG-MSG, NAV-PVT CFG-MSG + CFG-PRT
+static const uint32_t BLOCKING_MS = 200 + 200 + 150 + 100 + 50 + 10 + 10 + 10 + 50;
+
+// ---- Simulated receiver on the other end of the UART ----
+class SimReceiver {
+public:
+  struct Behaviour {
+    uint32_t baud = 460800;  // receiver's UART1 rate at power-up
+    bool dead = false;       // no receiver
+    uint8_t nakCls = 0, nakId = 0;   // NAK this command (0/0: none)
+    uint8_t dropCls = 0, dropId = 0; // lose the first ACK of this command
+    uint32_t ignoreKey = 0;          // ACK but do not apply this item
+    uint32_t latency_ms = 6;         // command to answer
+  };
+
+  explicit SimReceiver(const Behaviour &b) : b_(b), rxBaud_(b.baud) {
+    // Defaults of the items the clock sets (every layer reads through to them)
+    const uint32_t keys[] = { UBX_KEY_UART1_BAUDRATE, UBX_KEY_UART1INPROT_UBX, UBX_KEY_UART1OUTPROT_UBX,
+                              UBX_KEY_UART1OUTPROT_NMEA, UBX_KEY_RATE_MEAS, UBX_KEY_RATE_NAV,
+                              UBX_KEY_NAVSPG_DYNMODEL, UBX_KEY_MSGOUT_NAV_PVT_UART1,
+                              UBX_KEY_MSGOUT_NMEA_GGA_UART1, UBX_KEY_MSGOUT_NMEA_RMC_UART1,
+                              UBX_KEY_MSGOUT_NMEA_VTG_UART1, UBX_KEY_MSGOUT_NMEA_GSA_UART1,
+                              UBX_KEY_MSGOUT_NMEA_GSV_UART1, UBX_KEY_MSGOUT_NMEA_GLL_UART1 };
+    for (uint32_t k : keys) defaults_[k] = 1;
+    defaults_[UBX_KEY_UART1_BAUDRATE] = b.baud;
+    defaults_[UBX_KEY_RATE_MEAS] = 1000;
+    defaults_[UBX_KEY_NAVSPG_DYNMODEL] = UBX_DYN_PORTABLE;
+    defaults_[UBX_KEY_MSGOUT_NAV_PVT_UART1] = 0;
+  }
+
+  void setNow(uint32_t ms) {
+    now_ = ms;
+    // NMEA chatter at 25 Hz (skipped by the configurator's decoder)
+    while (nextNmea_ <= now_) {
+      if (!b_.dead) queue(nextNmea_, "$GNGGA,120000.00,2333.00000,S,04637.80000,W,1,14,0.8,760.0,M,-5.6,M,,*7B\r\n");
+      nextNmea_ += 40;
+    }
+  }
+
+  // ---- HardwareSerial subset used by UbxConfigurator ----
+  size_t write(const uint8_t *p, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      if (b_.dead || hostBaud_ != rxBaud_) {
+        ++garbled_;
+        continue;
+      }
+      if (dec_.push(p[i]) == FrameStatus::Complete) handle();
+    }
+    return n;
+  }
+
+  int available() {
+    while (!out_.empty() && out_.front().t_ms <= now_) {
+      if (out_.front().baud == hostBaud_) {
+        rx_.push_back(out_.front().byte);
+        ++sent_;
+      } else {
+        ++garbled_;
+      }
+      out_.pop_front();
+    }
+    return (int)rx_.size();
+  }
+
+  int read() {
+    if (rx_.empty()) return -1;
+    const int c = rx_.front();
+    rx_.pop_front();
+    return c;
+  }
+
+  void updateBaudRate(uint32_t baud) { hostBaud_ = baud; }
+
+  void begin(uint32_t baud) { hostBaud_ = baud; }
+  uint32_t receiverBaud() const { return rxBaud_; }
+  uint32_t garbled() const { return garbled_; }
+  uint32_t commands() const { return commands_; }
+  uint64_t value(uint32_t key, int layer = 0) const { return get(layer, key); }
+  uint32_t sent() const { return sent_; }  // bytes that reached the host
+
+private:
+  struct Byte {
+    uint32_t t_ms, baud;
+    uint8_t byte;
+  };
+
+  void queue(uint32_t t, const char *s) {
+    for (; *s; ++s) out_.push_back({ t, rxBaud_, (uint8_t)*s });
+  }
+
+  void queueUbx(uint32_t t, uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t len) {
+    uint8_t hdr[6] = { UBX_SYNC1, UBX_SYNC2, cls, id, (uint8_t)len, (uint8_t)(len >> 8) };
+    uint8_t a = 0, b = 0;
+    for (int i = 2; i < 6; ++i) ubxFletcher(a, b, hdr[i]);
+    for (uint16_t i = 0; i < len; ++i) ubxFletcher(a, b, payload[i]);
+    for (int i = 0; i < 6; ++i) out_.push_back({ t, rxBaud_, hdr[i] });
+    for (uint16_t i = 0; i < len; ++i) out_.push_back({ t, rxBaud_, payload[i] });
+    out_.push_back({ t, rxBaud_, a });
+    out_.push_back({ t, rxBaud_, b });
+  }
+
+  void ack(uint8_t cls, uint8_t id, bool ok) {
+    const uint8_t p[2] = { cls, id };
+    queueUbx(now_ + b_.latency_ms, UBX_CLASS_ACK, ok ? UBX_ACK_ACK : UBX_ACK_NAK, p, 2);
+  }
+
+  uint64_t get(int layer, uint32_t key) const {
+    for (int l = layer; l < 3; ++l) {  // RAM reads through BBR and Flash to the default
+      const auto it = layers_[l].find(key);
+      if (it != layers_[l].end()) return it->second;
+    }
+    const auto it = defaults_.find(key);
+    return it == defaults_.end() ? 0 : it->second;
+  }
+
+  void handle() {
+    ++commands_;
+    const uint8_t cls = dec_.msgClass(), id = dec_.msgId();
+    const uint8_t *p = dec_.payload();
+    const uint16_t len = dec_.payloadLength();
+    if (cls != UBX_CLASS_CFG) return;
+
+    if (cls == b_.nakCls && id == b_.nakId) {
+      ack(cls, id, false);
+      return;
+    }
+    if (cls == b_.dropCls && id == b_.dropId && !dropped_) {
+      dropped_ = true;
+      return;
+    }
+    if (len < UbxValset::HEADER) {
+      ack(cls, id, false);
+      return;
+    }
+
+    if (id == UBX_CFG_VALGET) {  // items of one layer, then ACK
+      const int layer = p[1];
+      uint8_t out[UBX_MAX_PAYLOAD] = { 0x01, p[1], 0, 0 };
+      size_t n = UbxValset::HEADER;
+      for (size_t i = UbxValset::HEADER; i + 4 <= len; i += 4) {
+        const uint32_t key = ubxGetU32(p + i);
+        const size_t sz = ubxKeySize(key);
+        if (layer > 2 || !defaults_.count(key) || n + 4 + sz > sizeof(out)) {
+          ack(cls, id, false);
+          return;
+        }
+        const uint64_t v = get(layer, key);
+        memcpy(out + n, p + i, 4);
+        for (size_t k = 0; k < sz; ++k) out[n + 4 + k] = (uint8_t)(v >> (8 * k));
+        n += 4 + sz;
+      }
+      queueUbx(now_ + b_.latency_ms, UBX_CLASS_CFG, UBX_CFG_VALGET, out, (uint16_t)n);
+      ack(cls, id, true);
+      return;
+    }
+
+    if (id == UBX_CFG_VALSET) {  // all items or none
+      std::map<uint32_t, uint64_t> items;
+      for (size_t i = UbxValset::HEADER; i < len;) {
+        const uint32_t key = i + 4 <= len ? ubxGetU32(p + i) : 0;
+        const size_t sz = ubxKeySize(key);
+        if (!sz || i + 4 + sz > len || !defaults_.count(key)) {
+          ack(cls, id, false);
+          return;
+        }
+        uint64_t v = 0;
+        for (size_t k = 0; k < sz; ++k) v |= (uint64_t)p[i + 4 + k] << (8 * k);
+        if (key != b_.ignoreKey) items[key] = v;
+        i += 4 + sz;
+      }
+      const uint32_t baudWas = (uint32_t)get(0, UBX_KEY_UART1_BAUDRATE);
+      for (int l = 0; l < 3; ++l) {
+        if (p[1] & (1 << l)) {
+          for (const auto &it : items) layers_[l][it.first] = it.second;
+        }
+      }
+      ack(cls, id, true);
+      // New baud once the ACK is out
+      if ((p[1] & UBX_LAYER_RAM) && get(0, UBX_KEY_UART1_BAUDRATE) != baudWas) {
+        rxBaud_ = (uint32_t)get(0, UBX_KEY_UART1_BAUDRATE);
+      }
+      return;
+    }
+    ack(cls, id, false);  // legacy CFG messages are not expected any more
+  }
+
+  Behaviour b_;
+  uint32_t now_ = 0, nextNmea_ = 0;
+  uint32_t rxBaud_, hostBaud_ = 0;
+  UbxDecoder dec_;
+  std::deque<Byte> out_;
+  std::deque<uint8_t> rx_;
+  uint32_t garbled_ = 0, commands_ = 0;
+  bool dropped_ = false;
+  std::map<uint32_t, uint64_t> defaults_, layers_[3];  // RAM, BBR, Flash
+  uint32_t sent_ = 0;
+};
+
+// ---- Scenarios ----
+struct Scenario {
+  const char *name;
+  SimReceiver::Behaviour rx;
+  uint8_t layers;
+  UbxConfigState expect;
+  const char *expectCmd;  // command that must end with expectStatus (nullptr: none)
+  UbxCmdStatus expectStatus;
+  bool switchProfile;     // then switch to Flight25Hz at runtime
+};
+
+// Polls until the run ends; returns the final state
+static UbxConfigState runToEnd(UbxConfigurator<SimReceiver> &cfg, SimReceiver &rx, uint32_t &now, size_t &forwarded) {
+  UbxConfigState st = UbxConfigState::Running;
+  const uint32_t until = now + 20000;
+  for (; now < until && st == UbxConfigState::Running; ++now) {
+    rx.setNow(now);
+    st = cfg.poll(now, [&](const uint8_t *, size_t n) { forwarded += n; });
+  }
+  return st;
+}
+
+static bool checkCmd(const UbxConfigurator<SimReceiver> &cfg, const char *name, UbxCmdStatus status) {
+  bool found = false;
+  for (int i = 0; i < cfg.count(); ++i) {
+    if (strcmp(cfg.command(i).name, name) == 0) found = cfg.command(i).status == status;
+  }
+  return found;
+}
+
+static void printCmds(const UbxConfigurator<SimReceiver> &cfg) {
+  for (int i = 0; i < cfg.count(); ++i) {
+    const UbxCommand &c = cfg.command(i);
+    printf("    %-20s %-8s attempts %u, answer %u ms, %u bytes\n", c.name, ubxCmdStatusName(c.status), c.attempts,
+           c.answer_ms, c.len + 8u);
+  }
+}
+
+static bool run(const Scenario &sc, bool verbose) {
+  static const uint32_t BAUD = 460800;
+  SimReceiver rx(sc.rx);
+  rx.begin(BAUD);
+  UbxConfigurator<SimReceiver> cfg;
+  cfg.begin(rx, BAUD);
+  ubxQueueProfile(cfg, UbxProfile::Portable25Hz, BAUD, true, sc.layers);
+  cfg.start();
+
+  uint32_t now = 1500;  // after M5.begin() and the sensors
+  size_t forwarded = 0;
+  const UbxConfigState st = runToEnd(cfg, rx, now, forwarded);
+
+  bool ok = st == sc.expect;
+  if (ok && st == UbxConfigState::Done) {
+    ok = rx.receiverBaud() == BAUD && cfg.baud() == BAUD && rx.value(UBX_KEY_RATE_MEAS) == 40 &&
+         rx.value(UBX_KEY_MSGOUT_NAV_PVT_UART1) == 1 && rx.value(UBX_KEY_UART1OUTPROT_NMEA) == 0;
+    if (sc.layers & UBX_LAYER_FLASH) ok = ok && rx.value(UBX_KEY_RATE_MEAS, UBX_VALGET_FLASH) == 40;
+  }
+  if (sc.expectCmd) ok = ok && checkCmd(cfg, sc.expectCmd, sc.expectStatus);
+
+  printf("%-26s %-6s %5u ms (blocking setup %u ms), %2d commands, %u retries, %u bytes garbled  %s\n", sc.name,
+         st == UbxConfigState::Done ? "done" : "FAILED", cfg.elapsedMs(), BLOCKING_MS, cfg.count(), cfg.retries(),
+         rx.garbled(), ok ? "ok" : "UNEXPECTED");
+  if (verbose || !ok) printCmds(cfg);
+
+  if (sc.switchProfile && ok) {
+    // Runtime switch: queued once the boot run has finished, no probe
+    now += 5000;
+    rx.setNow(now);
+    cfg.clear();
+    ubxQueueProfile(cfg, UbxProfile::Flight25Hz, BAUD, true, UBX_LAYER_RAM);
+    cfg.start();
+    forwarded = 0;
+    const uint32_t sentBefore = rx.sent();
+    const UbxConfigState st2 = runToEnd(cfg, rx, now, forwarded);
+    const bool ok2 = st2 == UbxConfigState::Done && rx.value(UBX_KEY_NAVSPG_DYNMODEL) == UBX_DYN_AIRBORNE_1G &&
+                     forwarded == rx.sent() - sentBefore && forwarded > 0;
+    printf("%-26s %-6s %5u ms, %2d commands, %zu bytes passed on to the parser  %s\n", "  then flight 25 Hz",
+           st2 == UbxConfigState::Done ? "done" : "FAILED", cfg.elapsedMs(), cfg.count(), forwarded,
+           ok2 ? "ok" : "UNEXPECTED");
+    if (verbose || !ok2) printCmds(cfg);
+    ok = ok2;
+  }
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  const bool verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+
+  std::vector<Scenario> scenarios;
+  {
+    Scenario s = { "at target baud", {}, UBX_LAYER_RAM, UbxConfigState::Done, "CFG-VALGET read-back", UbxCmdStatus::Acked, true };
+    scenarios.push_back(s);
+  }
+  {
+    Scenario s = { "factory 38400 baud", {}, UBX_LAYER_RAM, UbxConfigState::Done, "VALSET baud", UbxCmdStatus::Sent, false };
+    s.rx.baud = 38400;
+    scenarios.push_back(s);
+  }
+  {
+    Scenario s = { "9600 baud", {}, UBX_LAYER_RAM, UbxConfigState::Done, "probe at baud", UbxCmdStatus::Acked, false };
+    s.rx.baud = 9600;
+    scenarios.push_back(s);
+  }
+  {
+    Scenario s = { "lost ACK (VALSET)", {}, UBX_LAYER_RAM, UbxConfigState::Done, "CFG-VALSET profile", UbxCmdStatus::Acked, false };
+    s.rx.dropCls = UBX_CLASS_CFG;
+    s.rx.dropId = UBX_CFG_VALSET;
+    scenarios.push_back(s);
+  }
+  {
+    Scenario s = { "NAK (VALSET)", {}, UBX_LAYER_RAM, UbxConfigState::Failed, "CFG-VALSET profile", UbxCmdStatus::Nacked, false };
+    s.rx.nakCls = UBX_CLASS_CFG;
+    s.rx.nakId = UBX_CFG_VALSET;
+    scenarios.push_back(s);
+  }
+  {
+    Scenario s = { "read-back differs", {}, UBX_LAYER_RAM, UbxConfigState::Failed, "CFG-VALGET read-back", UbxCmdStatus::Mismatch, false };
+    s.rx.ignoreKey = UBX_KEY_RATE_MEAS;
+    scenarios.push_back(s);
+  }
+  {
+    Scenario s = { "no receiver", {}, UBX_LAYER_RAM, UbxConfigState::Failed, "probe", UbxCmdStatus::TimedOut, false };
+    s.rx.dead = true;
+    scenarios.push_back(s);
+  }
+  {
+    Scenario s = { "save to BBR + Flash", {}, UBX_LAYER_RAM | UBX_LAYER_BBR | UBX_LAYER_FLASH, UbxConfigState::Done,
+                   "CFG-VALGET read-back", UbxCmdStatus::Acked, false };
+    scenarios.push_back(s);
+  }
+
+  int failures = 0;
+  for (const Scenario &s : scenarios) failures += run(s, verbose) ? 0 : 1;
+  printf("%s\n", failures ? "FAIL" : "PASS");
+  return failures ? 1 : 0;
+}
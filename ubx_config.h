@@ -0,0 +1,367 @@
+#pragma once
+/*
+  ubx_config.h  —  Non-blocking u-blox configuration with ACK/NAK checks
+  ---------------------------------------------------------------------
+  - Commands are queued, then poll() sends them one at a time and reads
+    the receiver's answers as they arrive: UBX-ACK-ACK moves on to the
+    next command, UBX-ACK-NAK marks it rejected, no answer within its
+    timeout resends it (MAX_ATTEMPTS in all). No delay(), no flush(): a
+    frame goes into the UART's TX buffer and poll() returns
+  - begin() probes the link first (CFG-VALGET of the UART1 baud, which
+    the receiver answers and ACKs). If the probe stays unanswered at the
+    target baud, the other usual rates are tried (38400 is the M9N
+    default); once the receiver answers, a CFG-VALSET moves it to the
+    target baud (its ACK would arrive at the old rate, so none is
+    expected: the host UART follows once the frame has left and the probe
+    is repeated at the new rate)
+  - A READBACK command (CFG-VALGET) must be answered with the values of
+    the CFG-VALSET it checks before its ACK counts (ubx_valset.h)
+  - Ends Done (every command ACKed) or Failed (a NAK, a read-back that
+    differs, or no answer after all attempts); each command keeps its
+    status, attempts and ACK time, for the boot report
+  - Ownership: the task that queues commands (begin() / clear(), add())
+    hands the run over with start(); poll() runs it in the task that owns
+    the UART (the ingest task) and hands it back when it has finished.
+    finished() / failed() / the results may be read from any task once
+    the atomic state says so; a new run (e.g. a profile switch at
+    runtime) may be queued then
+  - poll(now, sink) passes every byte it read on to sink, so the receiver's
+    output between the answers still reaches the parser
+  - Portable: Serial is HardwareSerial on the device, the simulated
+    receiver in tools/ubx_config_sim on the host; time is passed in
+
+  Usage:
+    UbxConfigurator<HardwareSerial> config;
+    config.begin(GNSSSerial, 460800);
+    ubxQueueProfile(config, UbxProfile::Portable25Hz, 460800, UBX_MODE, UBX_LAYER_RAM);
+    config.start();
+    while (config.poll(millis()) == UbxConfigState::Running) vTaskDelay(1);
+    // later, once config.finished():
+    config.clear();  ubxQueueProfile(config, UbxProfile::Flight25Hz, ...);  config.start();
+*/
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include "ubx_decoder.h"
+#include "ubx_valset.h"
+
+static constexpr uint8_t UBX_CLASS_ACK = 0x05;
+static constexpr uint8_t UBX_ACK_NAK = 0x00;
+static constexpr uint8_t UBX_ACK_ACK = 0x01;
+static constexpr uint8_t UBX_CLASS_CFG = 0x06;
+
+static constexpr size_t UBX_CFG_MAX_PAYLOAD = UbxValset::MAX_PAYLOAD;
+static_assert(UBX_CFG_MAX_PAYLOAD <= UBX_MAX_PAYLOAD, "read-back answers must fit the decoder");
+
+enum class UbxConfigState : uint8_t { Idle, Running, Done, Failed };
+
+enum class UbxCmdStatus : uint8_t {
+  Queued,
+  Acked,
+  Nacked,    // the receiver rejected it
+  TimedOut,  // no answer after all attempts
+  Sent,      // no ACK expected (baud change)
+  Skipped,   // not needed (already at the target baud)
+  Mismatch   // read back with other values (or not at all)
+};
+
+inline const char *ubxCmdStatusName(UbxCmdStatus s) {
+  switch (s) {
+    case UbxCmdStatus::Queued: return "queued";
+    case UbxCmdStatus::Acked: return "ACK";
+    case UbxCmdStatus::Nacked: return "NAK";
+    case UbxCmdStatus::TimedOut: return "timeout";
+    case UbxCmdStatus::Sent: return "sent";
+    case UbxCmdStatus::Mismatch: return "differs";
+    default: return "skipped";
+  }
+}
+
+struct UbxCommand {
+  const char *name;
+  uint8_t cls, id;
+  uint8_t len;
+  uint8_t payload[UBX_CFG_MAX_PAYLOAD];
+  uint8_t flags;
+  uint32_t baud;        // SET_BAUD: host UART rate after the frame has left
+  uint16_t timeout_ms;  // per attempt
+  int8_t expect;        // READBACK: index of the CFG-VALSET it checks
+  // ---- Result ----
+  UbxCmdStatus status;
+  uint8_t attempts;
+  uint16_t answer_ms;   // send (last attempt) to ACK/NAK
+};
+
+template <class Serial>
+class UbxConfigurator {
+public:
+  static const int MAX_COMMANDS = 16;
+  static const uint8_t MAX_ATTEMPTS = 3;
+  static const uint16_t ACK_TIMEOUT_MS = 150;  // CFG answers take ~10-50 ms
+  static const uint32_t SETTLE_MS = 20;        // receiver switching its baud
+
+  // Command flags
+  static const uint8_t NO_ACK = 0x01;          // none expected
+  static const uint8_t SET_BAUD = 0x02;        // then switch the host UART to cmd.baud
+  static const uint8_t PROBE = 0x04;           // on timeout, try the next baud
+  static const uint8_t LINK = 0x08;            // no answer ends the configuration
+  static const uint8_t ONLY_OFF_TARGET = 0x10; // skipped if the probe found the target baud
+  static const uint8_t READBACK = 0x20;        // answer must match command `expect`
+
+  // A new configuration at `baud`: probe, and the baud switch in case the
+  // receiver answers at another rate
+  void begin(Serial &ser, uint32_t baud) {
+    ser_ = &ser;
+    target_ = current_ = baud;
+    clear();
+
+    UbxValset probe(UBX_LAYER_RAM), prt(UBX_LAYER_RAM);
+    probe.set(UBX_KEY_UART1_BAUDRATE, 0);
+    prt.set(UBX_KEY_UART1_BAUDRATE, baud);
+    uint8_t poll[8];
+    const size_t n = probe.valget(poll, sizeof(poll), UBX_VALGET_RAM);
+    add("probe", UBX_CLASS_CFG, UBX_CFG_VALGET, poll, n, PROBE | LINK);
+    add("VALSET baud", UBX_CLASS_CFG, UBX_CFG_VALSET, prt.payload(), prt.length(), NO_ACK | SET_BAUD | ONLY_OFF_TARGET, baud);
+    add("probe at baud", UBX_CLASS_CFG, UBX_CFG_VALGET, poll, n, LINK | ONLY_OFF_TARGET);
+  }
+
+  // Empties the queue for a new run on the same port and baud (only while
+  // not running)
+  void clear() {
+    hunt_ = 0;
+    offTarget_ = false;
+    count_ = 0;
+    pos_ = 0;
+    phase_ = SEND;
+    retries_ = 0;
+    start_ms_ = done_ms_ = resume_ms_ = 0;
+    started_ = false;
+    state_.store(UbxConfigState::Idle, std::memory_order_relaxed);
+  }
+
+  // Hands the queued commands to the task that polls
+  void start() { state_.store(UbxConfigState::Running, std::memory_order_release); }
+
+  // Queues one command; false if the queue is full or the payload too long
+  bool add(const char *name, uint8_t cls, uint8_t id, const uint8_t *payload, size_t len, uint8_t flags = 0,
+           uint32_t baud = 0, uint16_t timeout_ms = ACK_TIMEOUT_MS, int8_t expect = -1) {
+    if (count_ == MAX_COMMANDS || len > UBX_CFG_MAX_PAYLOAD) return false;
+    UbxCommand &c = cmds_[count_++];
+    memset(&c, 0, sizeof(c));
+    c.name = name;
+    c.cls = cls;
+    c.id = id;
+    c.len = (uint8_t)len;
+    if (len) memcpy(c.payload, payload, len);
+    c.flags = flags;
+    c.baud = baud;
+    c.timeout_ms = timeout_ms;
+    c.expect = expect;
+    c.status = UbxCmdStatus::Queued;
+    return true;
+  }
+
+  // Reads answers, sends / resends; call until it returns Done or Failed
+  UbxConfigState poll(uint32_t now_ms) {
+    return poll(now_ms, [](const uint8_t *, size_t) {});
+  }
+
+  // Same; every byte read is passed on to sink(const uint8_t *, size_t)
+  template <class Sink>
+  UbxConfigState poll(uint32_t now_ms, Sink sink) {
+    const UbxConfigState st = state_.load(std::memory_order_acquire);
+    if (st != UbxConfigState::Running) return st;
+    if (!started_) {
+      started_ = true;
+      start_ms_ = now_ms;
+    }
+
+    // Answers (NMEA and other UBX output in between go to sink only)
+    int answer = -1;
+    uint8_t buf[64];
+    size_t n = 0;
+    while (ser_->available() > 0) {
+      const int b = ser_->read();
+      if (b < 0) break;
+      buf[n++] = (uint8_t)b;
+      if (n == sizeof(buf)) {
+        sink(buf, n);
+        n = 0;
+      }
+      if (dec_.push((uint8_t)b) != FrameStatus::Complete || pos_ >= count_ || phase_ != WAIT_ACK) continue;
+      const UbxCommand &c = cmds_[pos_];
+      const uint8_t *p = dec_.payload();
+      if (dec_.msgClass() == UBX_CLASS_ACK && dec_.payloadLength() == 2 && p[0] == c.cls && p[1] == c.id) {
+        answer = dec_.msgId();
+      } else if ((c.flags & READBACK) && dec_.msgClass() == c.cls && dec_.msgId() == c.id) {
+        const UbxCommand &set = cmds_[c.expect];
+        readback_ = ubxValgetMatches(set.payload, set.len, p, dec_.payloadLength()) ? MATCHED : DIFFERS;
+      }
+    }
+    if (n) sink(buf, n);
+
+    while (pos_ < count_) {
+      UbxCommand &c = cmds_[pos_];
+      if (phase_ == SEND) {
+        if ((c.flags & ONLY_OFF_TARGET) && !offTarget_) {
+          c.status = UbxCmdStatus::Skipped;
+          ++pos_;
+          continue;
+        }
+        if ((int32_t)(now_ms - resume_ms_) < 0) break;  // settling after a baud switch
+        send(c);
+        ++c.attempts;
+        readback_ = NONE;
+        sent_ms_ = now_ms;
+        phase_ = (c.flags & NO_ACK) ? DRAIN : WAIT_ACK;
+        break;
+      }
+
+      if (phase_ == DRAIN) {
+        // Frame length at 10 bits per byte, plus a millisecond
+        const uint32_t drain = (8u + c.len) * 10000u / current_ + 1;
+        if (now_ms - sent_ms_ < drain) break;
+        if (c.flags & SET_BAUD) {
+          ser_->updateBaudRate(c.baud);
+          current_ = c.baud;
+        }
+        c.status = UbxCmdStatus::Sent;
+        resume_ms_ = now_ms + SETTLE_MS;
+        next();
+        continue;
+      }
+
+      // WAIT_ACK
+      if (answer == UBX_ACK_ACK || answer == UBX_ACK_NAK) {
+        c.status = (answer == UBX_ACK_ACK) ? UbxCmdStatus::Acked : UbxCmdStatus::Nacked;
+        if (c.status == UbxCmdStatus::Acked && (c.flags & READBACK) && readback_ != MATCHED) {
+          c.status = UbxCmdStatus::Mismatch;
+        }
+        c.answer_ms = (uint16_t)(now_ms - sent_ms_);
+        if (c.flags & PROBE) offTarget_ = current_ != target_;
+        answer = -1;
+        next();
+        continue;
+      }
+      if (now_ms - sent_ms_ < c.timeout_ms) break;
+      if (c.attempts < MAX_ATTEMPTS) {
+        ++retries_;
+        phase_ = SEND;
+        continue;
+      }
+      if ((c.flags & PROBE) && nextBaud()) {
+        // Unanswered at this rate: try the next one from the first attempt
+        c.attempts = 0;
+        ++retries_;
+        phase_ = SEND;
+        resume_ms_ = now_ms + SETTLE_MS;
+        continue;
+      }
+      c.status = UbxCmdStatus::TimedOut;
+      if (c.flags & LINK) {
+        // No receiver (at any rate): nothing else can succeed
+        finish(now_ms, UbxConfigState::Failed);
+        return UbxConfigState::Failed;
+      }
+      next();
+    }
+
+    if (pos_ >= count_) {
+      bool ok = true;
+      for (int i = 0; i < count_; ++i) {
+        const UbxCmdStatus s = cmds_[i].status;
+        if (s == UbxCmdStatus::Nacked || s == UbxCmdStatus::TimedOut || s == UbxCmdStatus::Mismatch) ok = false;
+      }
+      finish(now_ms, ok ? UbxConfigState::Done : UbxConfigState::Failed);
+    }
+    return state_.load(std::memory_order_relaxed);
+  }
+
+  // ---- Results (any task, once finished() is true) ----
+  UbxConfigState state() const { return state_.load(std::memory_order_acquire); }
+  bool finished() const {
+    const UbxConfigState s = state();
+    return s == UbxConfigState::Done || s == UbxConfigState::Failed;
+  }
+  bool failed() const { return state() == UbxConfigState::Failed; }
+  int count() const { return count_; }
+  const UbxCommand &command(int i) const { return cmds_[i]; }
+  uint32_t retries() const { return retries_; }
+  uint32_t baud() const { return current_; }      // host UART rate now
+  uint32_t elapsedMs() const { return done_ms_ - start_ms_; }
+  uint32_t doneMs() const { return done_ms_; }    // poll() time it finished
+
+private:
+  enum Phase : uint8_t { SEND, WAIT_ACK, DRAIN };
+  enum Readback : uint8_t { NONE, MATCHED, DIFFERS };
+
+  void send(const UbxCommand &c) {
+    uint8_t frame[8 + UBX_CFG_MAX_PAYLOAD];
+    frame[0] = UBX_SYNC1;
+    frame[1] = UBX_SYNC2;
+    frame[2] = c.cls;
+    frame[3] = c.id;
+    frame[4] = c.len;
+    frame[5] = 0;
+    memcpy(frame + 6, c.payload, c.len);
+    uint8_t a = 0, b = 0;
+    for (size_t i = 2; i < 6u + c.len; ++i) ubxFletcher(a, b, frame[i]);
+    frame[6 + c.len] = a;
+    frame[7 + c.len] = b;
+    ser_->write(frame, 8u + c.len);
+  }
+
+  void next() {
+    ++pos_;
+    phase_ = SEND;
+  }
+
+  // Host UART to the next rate of the hunt; false when all were tried
+  bool nextBaud() {
+    static const uint32_t BAUDS[] = { 38400, 9600, 115200, 230400, 460800 };
+    while (hunt_ < sizeof(BAUDS) / sizeof(BAUDS[0])) {
+      const uint32_t b = BAUDS[hunt_++];
+      if (b == current_ || b == target_) continue;
+      ser_->updateBaudRate(b);
+      current_ = b;
+      return true;
+    }
+    return false;
+  }
+
+  void finish(uint32_t now_ms, UbxConfigState s) {
+    done_ms_ = now_ms;
+    state_.store(s, std::memory_order_release);
+  }
+
+  Serial *ser_ = nullptr;
+  UbxDecoder dec_;
+  UbxCommand cmds_[MAX_COMMANDS];
+  int count_ = 0, pos_ = 0;
+  Phase phase_ = SEND;
+  uint32_t target_ = 0, current_ = 0;
+  size_t hunt_ = 0;
+  bool offTarget_ = false;  // the probe found the receiver at another rate
+  Readback readback_ = NONE;
+  uint32_t sent_ms_ = 0, resume_ms_ = 0;
+  uint32_t start_ms_ = 0, done_ms_ = 0, retries_ = 0;
+  bool started_ = false;
+  std::atomic<UbxConfigState> state_{ UbxConfigState::Idle };
+};
+
+// ---- The clock's receiver setup ----
+// One CFG-VALSET with every item of the profile (ubx_valset.h) to `layers`
+// (RAM, BBR, Flash), then a CFG-VALGET read-back of the layer written
+template <class Serial>
+inline bool ubxQueueProfile(UbxConfigurator<Serial> &cfg, UbxProfile p, uint32_t baud, bool navPvt, uint8_t layers) {
+  UbxValset v(layers);
+  if (!ubxProfileItems(v, p, baud, navPvt)) return false;
+  uint8_t poll[UBX_CFG_MAX_PAYLOAD];
+  const size_t n = v.valget(poll, sizeof(poll), ubxValgetLayer(layers));
+  const uint16_t timeout = (layers & UBX_LAYER_FLASH) ? 1000 : UbxConfigurator<Serial>::ACK_TIMEOUT_MS;  // flash write
+  const int set = cfg.count();
+  return cfg.add("CFG-VALSET profile", UBX_CLASS_CFG, UBX_CFG_VALSET, v.payload(), v.length(), 0, 0, timeout) &&
+         cfg.add("CFG-VALGET read-back", UBX_CLASS_CFG, UBX_CFG_VALGET, poll, n,
+                 UbxConfigurator<Serial>::READBACK, 0, UbxConfigurator<Serial>::ACK_TIMEOUT_MS, (int8_t)set);
+}
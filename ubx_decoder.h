@@ -0,0 +1,224 @@
+#pragma once
+/*
+  ubx_decoder.h  —  UBX binary frame decoder (NAV-PVT, NAV-CLOCK)
+  --------------------------------------------------------------
+  - Byte-at-a-time framer: sync B5 62, class, id, length, payload and the
+    8-bit Fletcher checksum accumulated as bytes arrive (no second pass)
+  - Zero-copy: the payload stays in the frame buffer and is read through
+    a packed struct with the receiver's exact layout; no text, no strtod
+  - NAV-PVT carries everything the clock needs in ~100 bytes per fix
+    (vs. ~300 for GGA+RMC+VTG+GLL), including height above ellipsoid,
+    so HAE needs no geoid-separation parsing
+  - Same framer interface as NmeaFramer, so it plugs into FrameIngest
+
+  Usage:
+    UbxDecoder ubx;
+    if (ubx.push(byte) == FrameStatus::Complete) {
+      if (const UbxNavPvt *pvt = ubx.navPvt()) ubxNavPvtToFix(*pvt, fix);
+    }
+
+  Notes:
+   - Layouts follow the u-blox M9 interface description (little-endian,
+     like the ESP32 and x86 hosts).
+*/
+
+#include "frame_ingest.h"
+#include "relativistic_clock_offset.h"
+
+static constexpr uint8_t UBX_SYNC1 = 0xB5;
+static constexpr uint8_t UBX_SYNC2 = 0x62;
+static constexpr uint8_t UBX_CLASS_NAV = 0x01;
+static constexpr uint8_t UBX_NAV_PVT = 0x07;
+static constexpr uint8_t UBX_NAV_CLOCK = 0x22;
+
+// Largest payload kept; longer frames are skipped (Overlong)
+static constexpr size_t UBX_MAX_PAYLOAD = 128;
+
+// ---- UBX-NAV-PVT (0x01 0x07), 92 bytes ----
+struct __attribute__((packed, may_alias)) UbxNavPvt {
+  uint32_t iTOW;     // ms, GPS time of week
+  uint16_t year;     // UTC
+  uint8_t month, day, hour, min, sec;
+  uint8_t valid;     // bit0 validDate, bit1 validTime, bit2 fullyResolved
+  uint32_t tAcc;     // ns
+  int32_t nano;      // ns, fraction of second (-1e9..1e9)
+  uint8_t fixType;   // 0 none, 2 2D, 3 3D, 4 GNSS+DR
+  uint8_t flags;     // bit0 gnssFixOK
+  uint8_t flags2;
+  uint8_t numSV;
+  int32_t lon;       // 1e-7 deg
+  int32_t lat;       // 1e-7 deg
+  int32_t height;    // mm above ellipsoid
+  int32_t hMSL;      // mm above mean sea level
+  uint32_t hAcc;     // mm
+  uint32_t vAcc;     // mm
+  int32_t velN;      // mm/s
+  int32_t velE;      // mm/s
+  int32_t velD;      // mm/s
+  int32_t gSpeed;    // mm/s, 2D ground speed
+  int32_t headMot;   // 1e-5 deg, heading of motion
+  uint32_t sAcc;     // mm/s
+  uint32_t headAcc;  // 1e-5 deg
+  uint16_t pDOP;     // 0.01
+  uint16_t flags3;
+  uint8_t reserved0[4];
+  int32_t headVeh;   // 1e-5 deg
+  int16_t magDec;    // 1e-2 deg
+  uint16_t magAcc;   // 1e-2 deg
+};
+static_assert(sizeof(UbxNavPvt) == 92, "UBX-NAV-PVT layout");
+
+// ---- UBX-NAV-CLOCK (0x01 0x22), 20 bytes ----
+struct __attribute__((packed, may_alias)) UbxNavClock {
+  uint32_t iTOW;  // ms
+  int32_t clkB;   // ns, receiver clock bias
+  int32_t clkD;   // ns/s, receiver clock drift
+  uint32_t tAcc;  // ns
+  uint32_t fAcc;  // ps/s
+};
+static_assert(sizeof(UbxNavClock) == 20, "UBX-NAV-CLOCK layout");
+
+static constexpr uint8_t UBX_PVT_VALID_DATE = 0x01;
+static constexpr uint8_t UBX_PVT_VALID_TIME = 0x02;
+static constexpr uint8_t UBX_PVT_GNSS_FIX_OK = 0x01;
+
+// One step of the UBX 8-bit Fletcher checksum
+static inline void ubxFletcher(uint8_t &ckA, uint8_t &ckB, uint8_t c) {
+  ckA += c;
+  ckB += ckA;
+}
+
+class UbxDecoder {
+public:
+  UbxDecoder() : state_(SYNC1), pos_(0), len_(0), ckA_(0), ckB_(0), complete_(false), stray_(0) {}
+
+  // Feeds one byte. Complete: frame()/length() hold the whole frame.
+  FrameStatus push(uint8_t c) {
+    complete_ = false;
+    switch (state_) {
+      case SYNC1:
+        if (c == UBX_SYNC1) {
+          buf_[0] = c;
+          state_ = SYNC2;
+        } else {
+          ++stray_;
+        }
+        return FrameStatus::None;
+
+      case SYNC2:
+        if (c == UBX_SYNC2) {
+          buf_[1] = c;
+          pos_ = 2;
+          ckA_ = ckB_ = 0;
+          state_ = HEADER;
+        } else {
+          stray_ += (c == UBX_SYNC1) ? 1 : 2;
+          state_ = (c == UBX_SYNC1) ? SYNC2 : SYNC1;
+        }
+        return FrameStatus::None;
+
+      case HEADER:  // class, id, length (LE)
+        buf_[pos_++] = c;
+        ubxFletcher(ckA_, ckB_, c);
+        if (pos_ == 6) {
+          len_ = (uint16_t)(buf_[4] | (buf_[5] << 8));
+          if (len_ > UBX_MAX_PAYLOAD) {
+            state_ = SYNC1;
+            return FrameStatus::Overlong;
+          }
+          state_ = len_ ? PAYLOAD : CK_A;
+        }
+        return FrameStatus::None;
+
+      case PAYLOAD:
+        buf_[pos_++] = c;
+        ubxFletcher(ckA_, ckB_, c);
+        if (pos_ == 6u + len_) state_ = CK_A;
+        return FrameStatus::None;
+
+      case CK_A:
+        buf_[pos_++] = c;
+        state_ = CK_B;
+        return FrameStatus::None;
+
+      default:  // CK_B
+        buf_[pos_++] = c;
+        state_ = SYNC1;
+        if (buf_[pos_ - 2] != ckA_ || c != ckB_) return FrameStatus::BadChecksum;
+        complete_ = true;
+        return FrameStatus::Complete;
+    }
+  }
+
+  const uint8_t *frame() const { return buf_; }
+  size_t length() const { return pos_; }
+  uint32_t stray() const { return stray_; }
+
+  // Valid after push() returned Complete, until the next push()
+  uint8_t msgClass() const { return buf_[2]; }
+  uint8_t msgId() const { return buf_[3]; }
+  uint16_t payloadLength() const { return len_; }
+  const uint8_t *payload() const { return buf_ + 6; }
+
+  // Payload as message T, or nullptr if the last frame is not that message
+  template <class T>
+  const T *as(uint8_t cls, uint8_t id) const {
+    if (!complete_ || msgClass() != cls || msgId() != id || len_ != sizeof(T)) return nullptr;
+    return reinterpret_cast<const T *>(payload());
+  }
+
+  const UbxNavPvt *navPvt() const { return as<UbxNavPvt>(UBX_CLASS_NAV, UBX_NAV_PVT); }
+  const UbxNavClock *navClock() const { return as<UbxNavClock>(UBX_CLASS_NAV, UBX_NAV_CLOCK); }
+
+private:
+  enum State : uint8_t { SYNC1, SYNC2, HEADER, PAYLOAD, CK_A, CK_B };
+
+  alignas(4) uint8_t buf_[6 + UBX_MAX_PAYLOAD + 2];
+  State state_;
+  size_t pos_;
+  uint16_t len_;
+  uint8_t ckA_, ckB_;
+  bool complete_;
+  uint32_t stray_;
+};
+
+template <size_t N>
+using UbxIngest = FrameIngest<UbxDecoder, N>;
+
+// ---- NAV-PVT in physical units ----
+struct GnssFix {
+  bool fix_ok;          // gnssFixOK and a 3D (or GNSS+DR) fix
+  bool time_valid;      // UTC date and time valid
+  double lat_deg, lon_deg;
+  double hae_m;         // height above ellipsoid
+  double hmsl_m;        // height above mean sea level
+  double velN_mps, velE_mps, velD_mps;
+  double speed_kmh;     // 2D ground speed
+  double heading_deg;   // heading of motion
+  double hAcc_m, vAcc_m, sAcc_mps;
+  double pdop;
+  int num_sv;
+  double gnss_time_s;   // UTC, seconds since 2000-01-01 (see gnssTimeSeconds)
+  uint32_t iTOW_ms;
+};
+
+inline void ubxNavPvtToFix(const UbxNavPvt &p, GnssFix &f) {
+  f.fix_ok = (p.flags & UBX_PVT_GNSS_FIX_OK) && (p.fixType == 3 || p.fixType == 4);
+  f.time_valid = (p.valid & (UBX_PVT_VALID_DATE | UBX_PVT_VALID_TIME)) == (UBX_PVT_VALID_DATE | UBX_PVT_VALID_TIME);
+  f.lat_deg = p.lat * 1e-7;
+  f.lon_deg = p.lon * 1e-7;
+  f.hae_m = p.height * 1e-3;
+  f.hmsl_m = p.hMSL * 1e-3;
+  f.velN_mps = p.velN * 1e-3;
+  f.velE_mps = p.velE * 1e-3;
+  f.velD_mps = p.velD * 1e-3;
+  f.speed_kmh = p.gSpeed * 0.0036;
+  f.heading_deg = p.headMot * 1e-5;
+  f.hAcc_m = p.hAcc * 1e-3;
+  f.vAcc_m = p.vAcc * 1e-3;
+  f.sAcc_mps = p.sAcc * 1e-3;
+  f.pdop = p.pDOP * 0.01;
+  f.num_sv = p.numSV;
+  f.gnss_time_s = f.time_valid ? gnssTimeSeconds(p.year, p.month, p.day, p.hour, p.min, p.sec, 0) + p.nano * 1e-9 : NAN;
+  f.iTOW_ms = p.iTOW;
+}
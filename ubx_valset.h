@@ -0,0 +1,222 @@
+#pragma once
+/*
+  ubx_valset.h  —  Key/value configuration (CFG-VALSET / CFG-VALGET, M9 generation)
+  -------------------------------------------------------------------------------
+  - UbxValset packs configuration items (32-bit key, value sized by the
+    key) into one CFG-VALSET payload for the chosen layers (RAM, BBR,
+    Flash), so a whole receiver setup is one command and one ACK instead
+    of a CFG-PRT / CFG-RATE / CFG-MSG round-trip per setting
+  - valget() builds the CFG-VALGET poll for the same keys, and
+    ubxValgetMatches() checks the receiver's answer against the VALSET
+    payload (every key present with the value that was set)
+  - Profiles: the clock's receiver setups, one VALSET each (baud, nav
+    rate, output messages on UART1, protocol masks, dynamic model), e.g.
+    Static1Hz for a clock on a desk, Flight25Hz (airborne model) in a
+    plane; Idle2Hz / Moving10Hz / Flight25Hz are the levels of
+    nav_rate_governor.h
+
+  Usage:
+    UbxValset v(UBX_LAYER_RAM);
+    ubxProfileItems(v, UbxProfile::Flight25Hz, 460800, true);
+    send CFG-VALSET v.payload(), v.length(); wait for ACK-ACK
+    n = v.valget(poll, sizeof(poll), UBX_VALGET_RAM); send CFG-VALGET, compare:
+    ubxValgetMatches(v.payload(), v.length(), answer, answerLen)
+
+  Notes:
+   - Keys from the u-blox M9 interface description; bits 28..30 of a key
+     give its value size (1 bit / 1 / 2 / 4 / 8 bytes), little-endian
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static constexpr uint8_t UBX_CFG_VALSET = 0x8A;
+static constexpr uint8_t UBX_CFG_VALGET = 0x8B;
+
+// VALSET layers (bit mask)
+static constexpr uint8_t UBX_LAYER_RAM = 0x01;
+static constexpr uint8_t UBX_LAYER_BBR = 0x02;
+static constexpr uint8_t UBX_LAYER_FLASH = 0x04;
+
+// VALGET layer (one value, not a mask)
+static constexpr uint8_t UBX_VALGET_RAM = 0;
+static constexpr uint8_t UBX_VALGET_BBR = 1;
+static constexpr uint8_t UBX_VALGET_FLASH = 2;
+
+// ---- Configuration keys ----
+static constexpr uint32_t UBX_KEY_UART1_BAUDRATE = 0x40520001;      // U4, baud
+static constexpr uint32_t UBX_KEY_UART1INPROT_UBX = 0x10730001;     // L
+static constexpr uint32_t UBX_KEY_UART1OUTPROT_UBX = 0x10740001;    // L
+static constexpr uint32_t UBX_KEY_UART1OUTPROT_NMEA = 0x10740002;   // L
+static constexpr uint32_t UBX_KEY_RATE_MEAS = 0x30210001;           // U2, ms
+static constexpr uint32_t UBX_KEY_RATE_NAV = 0x30210002;            // U2, measurements per solution
+static constexpr uint32_t UBX_KEY_NAVSPG_DYNMODEL = 0x20110021;     // E1
+static constexpr uint32_t UBX_KEY_MSGOUT_NAV_PVT_UART1 = 0x20910007;
+static constexpr uint32_t UBX_KEY_MSGOUT_NMEA_GGA_UART1 = 0x209100bb;
+static constexpr uint32_t UBX_KEY_MSGOUT_NMEA_RMC_UART1 = 0x209100ac;
+static constexpr uint32_t UBX_KEY_MSGOUT_NMEA_VTG_UART1 = 0x209100b1;
+static constexpr uint32_t UBX_KEY_MSGOUT_NMEA_GSA_UART1 = 0x209100c0;
+static constexpr uint32_t UBX_KEY_MSGOUT_NMEA_GSV_UART1 = 0x209100c5;
+static constexpr uint32_t UBX_KEY_MSGOUT_NMEA_GLL_UART1 = 0x209100ca;
+
+// CFG-NAVSPG-DYNMODEL values
+static constexpr uint8_t UBX_DYN_PORTABLE = 0;
+static constexpr uint8_t UBX_DYN_STATIONARY = 2;
+static constexpr uint8_t UBX_DYN_AUTOMOTIVE = 4;
+static constexpr uint8_t UBX_DYN_AIRBORNE_1G = 6;
+
+// Value bytes of a key (0: reserved size)
+inline size_t ubxKeySize(uint32_t key) {
+  switch ((key >> 28) & 0x07) {
+    case 1: return 1;  // L, one bit in a byte
+    case 2: return 1;
+    case 3: return 2;
+    case 4: return 4;
+    case 5: return 8;
+    default: return 0;
+  }
+}
+
+inline uint32_t ubxGetU32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// ---- CFG-VALSET builder ----
+class UbxValset {
+public:
+  static const size_t MAX_PAYLOAD = 96;  // header + about 15 items
+  static const size_t HEADER = 4;        // version, layers, reserved
+
+  explicit UbxValset(uint8_t layers) {
+    memset(buf_, 0, sizeof(buf_));
+    buf_[1] = layers;
+    len_ = HEADER;
+  }
+
+  // Adds one item; false if it does not fit (or the key has no size)
+  bool set(uint32_t key, uint64_t value) {
+    const size_t n = ubxKeySize(key);
+    if (!n || len_ + 4 + n > MAX_PAYLOAD) return false;
+    for (int i = 0; i < 4; ++i) buf_[len_++] = (uint8_t)(key >> (8 * i));
+    for (size_t i = 0; i < n; ++i) buf_[len_++] = (uint8_t)(value >> (8 * i));
+    ++items_;
+    return true;
+  }
+
+  const uint8_t *payload() const { return buf_; }
+  size_t length() const { return len_; }
+  int items() const { return items_; }
+  uint8_t layers() const { return buf_[1]; }
+
+  // CFG-VALGET poll for the same keys at `layer`; returns its length (0:
+  // does not fit in cap)
+  size_t valget(uint8_t *out, size_t cap, uint8_t layer) const {
+    const size_t n = HEADER + 4 * (size_t)items_;
+    if (n > cap) return 0;
+    memset(out, 0, HEADER);
+    out[1] = layer;
+    size_t o = HEADER;
+    for (size_t i = HEADER; i < len_; i += 4 + ubxKeySize(ubxGetU32(buf_ + i))) {
+      memcpy(out + o, buf_ + i, 4);
+      o += 4;
+    }
+    return o;
+  }
+
+private:
+  uint8_t buf_[MAX_PAYLOAD];
+  size_t len_;
+  int items_ = 0;
+};
+
+// VALGET layer that shows what a VALSET to `layers` wrote (RAM first)
+inline uint8_t ubxValgetLayer(uint8_t layers) {
+  if (layers & UBX_LAYER_RAM) return UBX_VALGET_RAM;
+  return (layers & UBX_LAYER_BBR) ? UBX_VALGET_BBR : UBX_VALGET_FLASH;
+}
+
+// True if every item of the VALSET payload `set` is in the VALGET answer
+// `get` with the same value
+inline bool ubxValgetMatches(const uint8_t *set, size_t setLen, const uint8_t *get, size_t getLen) {
+  for (size_t i = UbxValset::HEADER; i + 4 <= setLen;) {
+    const uint32_t key = ubxGetU32(set + i);
+    const size_t n = ubxKeySize(key);
+    if (!n || i + 4 + n > setLen) return false;
+    bool found = false;
+    for (size_t j = UbxValset::HEADER; j + 4 <= getLen;) {
+      const uint32_t k = ubxGetU32(get + j);
+      const size_t m = ubxKeySize(k);
+      if (!m || j + 4 + m > getLen) return false;
+      if (k == key) {
+        found = memcmp(set + i + 4, get + j + 4, n) == 0;
+        break;
+      }
+      j += 4 + m;
+    }
+    if (!found) return false;
+    i += 4 + n;
+  }
+  return true;
+}
+
+// ---- The clock's receiver profiles ----
+enum class UbxProfile : uint8_t {
+  Static1Hz,     // clock on a desk: 1 Hz, stationary model
+  Idle2Hz,       // not moving, but may be picked up: 2 Hz, portable model
+  Moving10Hz,    // walking, driving: 10 Hz, portable model
+  Portable25Hz,  // 25 Hz, portable model
+  Flight25Hz     // in a plane: 25 Hz, airborne (< 1 g) model
+};
+
+static constexpr int UBX_PROFILE_COUNT = 5;
+
+inline const char *ubxProfileName(UbxProfile p) {
+  switch (p) {
+    case UbxProfile::Static1Hz: return "static 1 Hz";
+    case UbxProfile::Idle2Hz: return "idle 2 Hz";
+    case UbxProfile::Moving10Hz: return "moving 10 Hz";
+    case UbxProfile::Flight25Hz: return "flight 25 Hz";
+    default: return "portable 25 Hz";
+  }
+}
+
+// Measurement period of a profile
+inline uint16_t ubxProfileMeasMs(UbxProfile p) {
+  switch (p) {
+    case UbxProfile::Static1Hz: return 1000;
+    case UbxProfile::Idle2Hz: return 500;
+    case UbxProfile::Moving10Hz: return 100;
+    default: return 40;
+  }
+}
+
+inline UbxProfile nextUbxProfile(UbxProfile p) {
+  return (UbxProfile)(((int)p + 1) % UBX_PROFILE_COUNT);
+}
+
+// Every item of a profile: UART1 at `baud`, nav rate and dynamic model,
+// navPvt: NAV-PVT every solution and UBX-only output, else GGA + RMC every
+// solution and GSA / GSV at 1 Hz (NMEA only)
+inline bool ubxProfileItems(UbxValset &v, UbxProfile p, uint32_t baud, bool navPvt) {
+  const uint16_t meas_ms = ubxProfileMeasMs(p);
+  const uint8_t hz = (uint8_t)(1000 / meas_ms);
+  const uint8_t dyn = (p == UbxProfile::Static1Hz)    ? UBX_DYN_STATIONARY
+                      : (p == UbxProfile::Flight25Hz) ? UBX_DYN_AIRBORNE_1G
+                                                      : UBX_DYN_PORTABLE;
+  bool ok = v.set(UBX_KEY_UART1_BAUDRATE, baud);
+  ok &= v.set(UBX_KEY_RATE_MEAS, meas_ms);
+  ok &= v.set(UBX_KEY_RATE_NAV, 1);
+  ok &= v.set(UBX_KEY_NAVSPG_DYNMODEL, dyn);
+  ok &= v.set(UBX_KEY_UART1INPROT_UBX, 1);
+  ok &= v.set(UBX_KEY_UART1OUTPROT_UBX, 1);
+  ok &= v.set(UBX_KEY_UART1OUTPROT_NMEA, navPvt ? 0 : 1);
+  ok &= v.set(UBX_KEY_MSGOUT_NAV_PVT_UART1, navPvt ? 1 : 0);
+  ok &= v.set(UBX_KEY_MSGOUT_NMEA_GGA_UART1, navPvt ? 0 : 1);
+  ok &= v.set(UBX_KEY_MSGOUT_NMEA_RMC_UART1, navPvt ? 0 : 1);
+  ok &= v.set(UBX_KEY_MSGOUT_NMEA_VTG_UART1, 0);  // RMC has speed and course
+  ok &= v.set(UBX_KEY_MSGOUT_NMEA_GLL_UART1, 0);
+  ok &= v.set(UBX_KEY_MSGOUT_NMEA_GSA_UART1, navPvt ? 0 : hz);
+  ok &= v.set(UBX_KEY_MSGOUT_NMEA_GSV_UART1, navPvt ? 0 : hz);
+  return ok;
+}